@@ -117,10 +117,10 @@ void CreateTaskDialog::setupUI()
 
     // 从 RegionManager 获取区域列表
     if (m_taskManager && m_taskManager->regionManager()) {
-        auto regions = m_taskManager->regionManager()->getAllRegions();
+        const RegionArena &regions = m_taskManager->regionManager()->getAllRegions();
         for (Region *region : regions) {
-            // 显示：区域ID - 区域名称
-            QString displayText = QString("区域%1 - %2").arg(region->id()).arg(region->name());
+            // 显示：区域编号 - 区域名称（数据仍为区域ID）
+            QString displayText = QString("区域%1 - %2").arg(region->number()).arg(region->name());
             m_taskRegionCombo->addItem(displayText, region->id());
         }
     }
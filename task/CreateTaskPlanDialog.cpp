@@ -314,10 +314,8 @@ void CreateTaskPlanDialog::onNewTask()
 
     // 检查是否存在 Polygon 类型的区域（任务区域）
     bool hasTaskRegion = false;
-    const QMap<int, Region*> &allRegions = regionManager->getAllRegions();
-    for (auto it = allRegions.constBegin(); it != allRegions.constEnd(); ++it) {
-        Region *region = it.value();
-        if (region && region->type() == RegionType::TaskRegion) {
+    for (Region *region : regionManager->getAllRegions()) {
+        if (region->type() == RegionType::TaskRegion) {
             hasTaskRegion = true;
             break;
         }
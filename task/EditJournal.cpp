@@ -0,0 +1,365 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "EditJournal.h"
+#include "TaskManager.h"
+#include <QDebug>
+#include <QTimer>
+
+EditJournal::EditJournal(TaskManager *taskManager, RegionManager *regionManager, int capacity, QObject *parent)
+    : QObject(parent)
+    , m_taskManager(taskManager)
+    , m_regionManager(regionManager)
+    , m_entries(qMax(1, capacity))
+{
+    connect(m_regionManager, &RegionManager::regionCreated, this, &EditJournal::onRegionCreated);
+    connect(m_regionManager, &RegionManager::regionAboutToBeRemoved, this, &EditJournal::onRegionAboutToBeRemoved);
+    connect(m_regionManager, &RegionManager::regionRemoved, this, &EditJournal::onRegionRemoved);
+    connect(m_regionManager, &RegionManager::regionAboutToBeUpdated, this, &EditJournal::onRegionAboutToBeUpdated);
+    connect(m_regionManager, &RegionManager::regionUpdated, this, &EditJournal::onRegionUpdated);
+    connect(m_taskManager, &TaskManager::regionAddedToTask, this, &EditJournal::onRegionAddedToTask);
+    connect(m_taskManager, &TaskManager::regionRemovedFromTask, this, &EditJournal::onRegionRemovedFromTask);
+}
+
+// ==================== 撤销/重做 ====================
+
+bool EditJournal::undo()
+{
+    commit();
+    if (!canUndo()) {
+        return false;
+    }
+
+    const Entry entry = entryAt(m_cursor - 1);
+    m_replaying = true;
+    {
+        TaskManager::ChangeScope scope(m_taskManager);
+
+        // 先重建被删除的区域（一次批量绘制），后面的属性/关联撤销才能找到它们
+        QVector<const Delta*> removed;
+        for (const Delta &delta : entry) {
+            if (delta.kind == Delta::Remove) {
+                removed.append(&delta);
+            }
+        }
+        recreate(removed, true);
+
+        // 倒序撤销属性修改和任务关联
+        for (int i = entry.size() - 1; i >= 0; --i) {
+            const Delta &delta = entry[i];
+            const int regionId = currentId(delta.regionId);
+            switch (delta.kind) {
+            case Delta::Update:
+                applyProps(regionId, delta.before);
+                break;
+            case Delta::Associate: {
+                Task *task = m_taskManager->getTask(delta.taskId);
+                if (task && task->hasRegion(regionId)) {
+                    m_taskManager->removeRegionFromTask(delta.taskId, regionId);
+                }
+                break;
+            }
+            case Delta::Dissociate:
+                if (m_taskManager->getTask(delta.taskId)) {
+                    m_taskManager->addRegionToTask(delta.taskId, regionId);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        // 最后删除这条记录中新建的区域
+        for (int i = entry.size() - 1; i >= 0; --i) {
+            if (entry[i].kind == Delta::Create) {
+                m_regionManager->removeRegion(currentId(entry[i].regionId));
+            }
+        }
+    }
+    m_replaying = false;
+
+    --m_cursor;
+    qDebug() << QString("撤销编辑: %1 个变化").arg(entry.size());
+    emit stateChanged();
+    return true;
+}
+
+bool EditJournal::redo()
+{
+    commit();
+    if (!canRedo()) {
+        return false;
+    }
+
+    const Entry entry = entryAt(m_cursor);
+    m_replaying = true;
+    {
+        TaskManager::ChangeScope scope(m_taskManager);
+
+        // 先重建这条记录中新建的区域（一次批量绘制），任务关联由后面的关联增量恢复
+        QVector<const Delta*> created;
+        for (const Delta &delta : entry) {
+            if (delta.kind == Delta::Create) {
+                created.append(&delta);
+            }
+        }
+        recreate(created, false);
+
+        // 正序重做属性修改和任务关联
+        for (const Delta &delta : entry) {
+            const int regionId = currentId(delta.regionId);
+            switch (delta.kind) {
+            case Delta::Update:
+                applyProps(regionId, delta.after);
+                break;
+            case Delta::Associate:
+                if (m_taskManager->getTask(delta.taskId)) {
+                    m_taskManager->addRegionToTask(delta.taskId, regionId);
+                }
+                break;
+            case Delta::Dissociate: {
+                Task *task = m_taskManager->getTask(delta.taskId);
+                if (task && task->hasRegion(regionId)) {
+                    m_taskManager->removeRegionFromTask(delta.taskId, regionId);
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        // 最后删除这条记录中删除的区域（任务中的引用随之清除）
+        for (const Delta &delta : entry) {
+            if (delta.kind == Delta::Remove) {
+                m_regionManager->removeRegion(currentId(delta.regionId));
+            }
+        }
+    }
+    m_replaying = false;
+
+    ++m_cursor;
+    qDebug() << QString("重做编辑: %1 个变化").arg(entry.size());
+    emit stateChanged();
+    return true;
+}
+
+void EditJournal::commit()
+{
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    // 新记录使所有可重做的记录失效；缓冲区满时丢弃最旧的一条
+    for (int i = m_cursor; i < m_count; ++i) {
+        entryAt(i).clear();
+    }
+    m_count = m_cursor;
+    if (m_count == m_entries.size()) {
+        entryAt(0).clear();
+        m_start = (m_start + 1) % m_entries.size();
+        --m_count;
+    }
+    entryAt(m_count) = std::move(m_pending);
+    m_pending = Entry();
+    ++m_count;
+    m_cursor = m_count;
+
+    emit stateChanged();
+}
+
+void EditJournal::clear()
+{
+    for (Entry &entry : m_entries) {
+        entry.clear();
+    }
+    m_start = 0;
+    m_count = 0;
+    m_cursor = 0;
+    m_pending.clear();
+    m_removing.clear();
+    m_before.clear();
+    m_currentIds.clear();
+    m_logicalIds.clear();
+    emit stateChanged();
+}
+
+// ==================== 记录增量 ====================
+
+void EditJournal::onRegionCreated(int regionId)
+{
+    Region *region = m_regionManager->getRegion(regionId);
+    if (m_replaying || !region) {
+        return;
+    }
+
+    Delta delta;
+    delta.kind = Delta::Create;
+    delta.regionId = logicalId(regionId);
+    delta.spec = RegionManager::specOf(region);
+    append(std::move(delta));
+}
+
+void EditJournal::onRegionAboutToBeRemoved(int regionId)
+{
+    Region *region = m_regionManager->getRegion(regionId);
+    if (m_replaying || !region) {
+        return;
+    }
+
+    // 墓碑：删除前的创建参数和引用它的任务（TaskManager 随后会清除这些引用）
+    Delta delta;
+    delta.kind = Delta::Remove;
+    delta.regionId = logicalId(regionId);
+    delta.spec = RegionManager::specOf(region);
+    for (Task *task : m_taskManager->getTasksReferencingRegion(regionId)) {
+        delta.taskIds.append(task->id());
+    }
+    append(std::move(delta));
+    m_removing.insert(regionId);
+}
+
+void EditJournal::onRegionRemoved(int regionId)
+{
+    // 本对象在 TaskManager 之后连接 regionRemoved，此时任务中的引用已清除完毕
+    m_removing.remove(regionId);
+}
+
+void EditJournal::onRegionAboutToBeUpdated(int regionId)
+{
+    if (m_replaying) {
+        return;
+    }
+    m_before.insert(regionId, propsOf(regionId));
+}
+
+void EditJournal::onRegionUpdated(int regionId)
+{
+    auto it = m_before.find(regionId);
+    if (it == m_before.end()) {
+        return;
+    }
+    RegionProps before = it.value();
+    m_before.erase(it);
+
+    RegionProps after = propsOf(regionId);
+    if (before.name == after.name && before.terrainType == after.terrainType && before.color == after.color) {
+        return;
+    }
+
+    Delta delta;
+    delta.kind = Delta::Update;
+    delta.regionId = logicalId(regionId);
+    delta.before = before;
+    delta.after = after;
+    append(std::move(delta));
+}
+
+void EditJournal::onRegionAddedToTask(int taskId, int regionId)
+{
+    Delta delta;
+    delta.kind = Delta::Associate;
+    delta.regionId = logicalId(regionId);
+    delta.taskId = taskId;
+    append(std::move(delta));
+}
+
+void EditJournal::onRegionRemovedFromTask(int taskId, int regionId)
+{
+    // 删除区域时自动移除的关联已包含在墓碑中
+    if (m_removing.contains(regionId)) {
+        return;
+    }
+
+    Delta delta;
+    delta.kind = Delta::Dissociate;
+    delta.regionId = logicalId(regionId);
+    delta.taskId = taskId;
+    append(std::move(delta));
+}
+
+// ==================== 私有方法 ====================
+
+void EditJournal::append(Delta &&delta)
+{
+    if (m_replaying) {
+        return;
+    }
+    m_pending.append(std::move(delta));
+
+    // 同一次事件循环内的增量合为一条记录；事务进行中时等 TaskManager::endChanges 提交
+    if (m_commitPending) {
+        return;
+    }
+    m_commitPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_commitPending = false;
+        if (!m_taskManager->isInChanges()) {
+            commit();
+        }
+    });
+}
+
+void EditJournal::recreate(const QVector<const Delta*> &deltas, bool restoreTasks)
+{
+    if (deltas.isEmpty()) {
+        return;
+    }
+
+    QVector<RegionSpec> specs;
+    specs.reserve(deltas.size());
+    for (const Delta *delta : deltas) {
+        specs.append(delta->spec);
+    }
+    QVector<int> regionIds = m_regionManager->createRegions(specs);
+
+    for (int i = 0; i < deltas.size(); ++i) {
+        const int logical = deltas[i]->regionId;
+        if (regionIds[i] == 0) {
+            qWarning() << QString("EditJournal: 无法重建区域 #%1").arg(logical);
+            continue;
+        }
+
+        // 区域ID变化，更新逻辑ID映射
+        m_logicalIds.remove(currentId(logical));
+        m_currentIds.insert(logical, regionIds[i]);
+        m_logicalIds.insert(regionIds[i], logical);
+
+        if (restoreTasks) {
+            for (int taskId : deltas[i]->taskIds) {
+                if (m_taskManager->getTask(taskId)) {
+                    m_taskManager->addRegionToTask(taskId, regionIds[i]);
+                }
+            }
+        }
+    }
+}
+
+void EditJournal::applyProps(int regionId, const RegionProps &props)
+{
+    Region *region = m_regionManager->getRegion(regionId);
+    if (!region) {
+        return;
+    }
+
+    if (region->name() != props.name) {
+        m_regionManager->updateRegionName(regionId, props.name);
+    }
+    if (region->terrainType() != props.terrainType) {
+        m_regionManager->updateRegionTerrainType(regionId, props.terrainType);
+    }
+    if (region->type() == RegionType::UAV && region->color() != props.color) {
+        m_regionManager->updateRegionColor(regionId, props.color);
+    }
+}
+
+EditJournal::RegionProps EditJournal::propsOf(int regionId) const
+{
+    RegionProps props;
+    if (Region *region = m_regionManager->getRegion(regionId)) {
+        props.name = region->name();
+        props.terrainType = region->terrainType();
+        props.color = region->color();
+    }
+    return props;
+}
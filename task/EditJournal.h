@@ -0,0 +1,173 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include "map_region/MapRegionTypes.h"
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+
+class TaskManager;
+class RegionManager;
+
+/**
+ * @brief 编辑日志 - 记录区域编辑的增量，支持撤销/重做
+ *
+ * 只记录变化本身，不做整体快照：
+ * - 新建区域：区域创建参数
+ * - 删除区域：删除前的创建参数 + 引用它的任务（墓碑）
+ * - 修改属性：名称/地形/颜色的修改前后值
+ * - 任务关联：添加/移除的 (任务ID, 区域ID)
+ *
+ * 同一事务（TaskManager::beginChanges/endChanges）或同一次事件循环内的增量合为一条记录，
+ * 记录存放在固定容量的环形缓冲区中，超出容量时丢弃最旧的记录。
+ * 撤销/重做的开销只与该条记录的增量数量有关，重建的区域通过批量绘制一次提交。
+ *
+ * 重做/撤销删除时重建的区域会分配新ID，日志内部以首次出现时的ID作为逻辑ID，
+ * 通过映射表找到区域当前的ID。
+ */
+class EditJournal : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int DEFAULT_CAPACITY = 256;   // 默认保留的记录条数
+
+    /**
+     * @param taskManager 任务管理器（监听任务关联变化，撤销时恢复关联）
+     * @param regionManager 区域管理器（监听区域变化，撤销时重建/删除区域）
+     * @param capacity 最多保留的记录条数
+     */
+    EditJournal(TaskManager *taskManager, RegionManager *regionManager,
+                int capacity = DEFAULT_CAPACITY, QObject *parent = nullptr);
+
+    // ==================== 撤销/重做 ====================
+
+    bool canUndo() const { return m_cursor > 0; }
+    bool canRedo() const { return m_cursor < m_count; }
+
+    /**
+     * @brief 撤销最近一条记录
+     * @return 没有可撤销的记录返回 false
+     */
+    bool undo();
+
+    /**
+     * @brief 重做最近撤销的一条记录
+     * @return 没有可重做的记录返回 false
+     */
+    bool redo();
+
+    /**
+     * @brief 把当前累积的增量提交为一条记录（事务结束时由 TaskManager 调用）
+     */
+    void commit();
+
+    /**
+     * @brief 清空所有记录
+     */
+    void clear();
+
+    int capacity() const { return m_entries.size(); }
+
+signals:
+    /**
+     * @brief 可撤销/可重做状态变化
+     */
+    void stateChanged();
+
+private slots:
+    void onRegionCreated(int regionId);
+    void onRegionAboutToBeRemoved(int regionId);
+    void onRegionRemoved(int regionId);
+    void onRegionAboutToBeUpdated(int regionId);
+    void onRegionUpdated(int regionId);
+    void onRegionAddedToTask(int taskId, int regionId);
+    void onRegionRemovedFromTask(int taskId, int regionId);
+
+private:
+    /**
+     * @brief 可撤销的区域属性
+     */
+    struct RegionProps {
+        QString name;
+        TerrainType terrainType = TerrainType::Plain;
+        QString color;
+    };
+
+    /**
+     * @brief 单个增量
+     */
+    struct Delta {
+        enum Kind {
+            Create,        // 新建区域
+            Remove,        // 删除区域
+            Update,        // 修改属性
+            Associate,     // 添加到任务
+            Dissociate     // 从任务移除
+        };
+
+        Kind kind = Create;
+        int regionId = 0;          // 逻辑区域ID
+        int taskId = 0;            // Associate/Dissociate：任务ID
+        RegionSpec spec;           // Create/Remove：区域创建参数
+        QVector<int> taskIds;      // Remove：删除前引用该区域的任务
+        RegionProps before;        // Update：修改前
+        RegionProps after;         // Update：修改后
+    };
+
+    using Entry = QVector<Delta>;
+
+    /**
+     * @brief 追加增量，安排在下一次事件循环中提交
+     */
+    void append(Delta &&delta);
+
+    /**
+     * @brief 重建区域（一次批量创建），更新逻辑ID映射并恢复任务关联
+     */
+    void recreate(const QVector<const Delta*> &deltas, bool restoreTasks);
+
+    /**
+     * @brief 按给定属性修改区域
+     */
+    void applyProps(int regionId, const RegionProps &props);
+
+    RegionProps propsOf(int regionId) const;
+
+    /**
+     * @brief 当前区域ID -> 逻辑ID
+     */
+    int logicalId(int regionId) const { return m_logicalIds.value(regionId, regionId); }
+
+    /**
+     * @brief 逻辑ID -> 当前区域ID
+     */
+    int currentId(int logicalId) const { return m_currentIds.value(logicalId, logicalId); }
+
+    /**
+     * @brief 环形缓冲区中第 index 条（从最旧算起）记录
+     */
+    Entry &entryAt(int index) { return m_entries[(m_start + index) % m_entries.size()]; }
+
+    TaskManager *m_taskManager;
+    RegionManager *m_regionManager;
+
+    QVector<Entry> m_entries;          // 环形缓冲区
+    int m_start = 0;                   // 最旧记录的位置
+    int m_count = 0;                   // 有效记录条数（含可重做的）
+    int m_cursor = 0;                  // 可撤销的记录条数（之后的为可重做）
+
+    Entry m_pending;                   // 尚未提交的增量
+    bool m_commitPending = false;      // 是否已安排提交
+    bool m_replaying = false;          // 正在撤销/重做（不记录由此产生的变化）
+
+    QSet<int> m_removing;              // 正在删除的区域（忽略随之产生的关联移除）
+    QHash<int, RegionProps> m_before;  // 修改前的属性（修改通知到达前暂存）
+    QHash<int, int> m_currentIds;      // 逻辑ID -> 当前区域ID（仅重建过的区域）
+    QHash<int, int> m_logicalIds;      // 当前区域ID -> 逻辑ID（仅重建过的区域）
+};
+
+#endif // EDITJOURNAL_H
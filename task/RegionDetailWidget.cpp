@@ -11,7 +11,7 @@
 
 RegionDetailWidget::RegionDetailWidget(QWidget *parent)
     : QWidget(parent)
-    , m_currentRegion(nullptr)
+    , m_currentRegion()
 {
     setWindowFlags(Qt::Tool | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint);
     setAttribute(Qt::WA_TranslucentBackground);
@@ -37,14 +37,11 @@ RegionDetailWidget::RegionDetailWidget(QWidget *parent)
     hide();
 }
 
-void RegionDetailWidget::showRegion(const RegionInfo *info, const QPoint &screenPos)
+void RegionDetailWidget::showRegion(const RegionInfo &region, const QPoint &screenPos)
 {
-    if (!info) {
-        hide();
-        return;
-    }
-
-    m_currentRegion = info;
+    // 保存副本，之后的查询不会影响当前显示的区域
+    m_currentRegion = region;
+    const RegionInfo *info = &m_currentRegion;
 
     // 清除旧内容
     QLayoutItem *item;
@@ -110,7 +107,7 @@ void RegionDetailWidget::showRegion(const RegionInfo *info, const QPoint &screen
             addInfoLine("中心经度", QString("%1°").arg(info->coordinate.second, 0, 'f', 6));
             addInfoLine("中心纬度", QString("%1°").arg(info->coordinate.first, 0, 'f', 6));
             addInfoLine("半径", QString("%1 米").arg(info->radius, 0, 'f', 1));
-            double areaKm2 = M_PI * info->radius * info->radius / 1000000.0;
+            double areaKm2 = info->area / 1000000.0;
             addInfoLine("区域面积", QString("%1 km²").arg(areaKm2, 0, 'f', 3));
             // 地形特征下拉选择
             addTerrainLine("地形特征", info->terrainType);
@@ -127,7 +124,7 @@ void RegionDetailWidget::showRegion(const RegionInfo *info, const QPoint &screen
                     addInfoLine("中心纬度", QString("%1°").arg(info->coordinate.first, 0, 'f', 6));
                     addInfoLine("半径", QString("%1 米").arg(info->radius, 0, 'f', 1));
                     {
-                        double areaKm2 = M_PI * info->radius * info->radius / 1000000.0;
+                        double areaKm2 = info->area / 1000000.0;
                         addInfoLine("区域面积", QString("%1 km²").arg(areaKm2, 0, 'f', 3));
                     }
                     break;
@@ -143,7 +140,7 @@ void RegionDetailWidget::showRegion(const RegionInfo *info, const QPoint &screen
                             .arg(info->vertices[i].second, 0, 'f', 5));
                     }
                     {
-                        double areaKm2 = calculateTaskRegionArea(info->vertices) / 1000000.0;
+                        double areaKm2 = info->area / 1000000.0;
                         addInfoLine("区域面积", QString("%1 km²").arg(areaKm2, 0, 'f', 3));
                     }
                     break;
@@ -160,7 +157,7 @@ void RegionDetailWidget::showRegion(const RegionInfo *info, const QPoint &screen
                             .arg(info->vertices[i].second, 0, 'f', 5));
                     }
                     {
-                        double areaKm2 = calculateTaskRegionArea(info->vertices) / 1000000.0;
+                        double areaKm2 = info->area / 1000000.0;
                         addInfoLine("区域面积", QString("%1 km²").arg(areaKm2, 0, 'f', 3));
                     }
                     break;
@@ -278,9 +275,9 @@ void RegionDetailWidget::addTerrainLine(const QString &label, TerrainType curren
     );
 
     connect(terrainCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this, terrainCombo](int index) {
-        if (m_currentRegion) {
+        if (m_currentRegion.regionId != 0) {
             TerrainType newTerrain = static_cast<TerrainType>(terrainCombo->currentData().toInt());
-            emit terrainChanged(m_currentRegion->regionId, newTerrain);
+            emit terrainChanged(m_currentRegion.regionId, newTerrain);
         }
     });
 
@@ -320,8 +317,8 @@ void RegionDetailWidget::addDeleteButton()
         "}"
     );
     connect(m_deleteButton, &QPushButton::clicked, this, [this]() {
-        if (m_currentRegion) {
-            emit deleteRequested(m_currentRegion->regionId);
+        if (m_currentRegion.regionId != 0) {
+            emit deleteRequested(m_currentRegion.regionId);
             hide();
         }
     });
@@ -343,28 +340,6 @@ QString RegionDetailWidget::getColorName(const QString &color) const
     return color;
 }
 
-double RegionDetailWidget::calculateTaskRegionArea(const QMapLibre::Coordinates &vertices) const
-{
-    if (vertices.size() < 3) return 0.0;
-
-    // 使用 Shoelace 公式计算近似面积
-    double area = 0.0;
-    int n = vertices.size();
-
-    for (int i = 0; i < n; ++i) {
-        int j = (i + 1) % n;
-        // 转换为近似米制坐标（粗略估算）
-        double x1 = vertices[i].second * 111320.0 * cos(vertices[i].first * M_PI / 180.0);
-        double y1 = vertices[i].first * 110540.0;
-        double x2 = vertices[j].second * 111320.0 * cos(vertices[j].first * M_PI / 180.0);
-        double y2 = vertices[j].first * 110540.0;
-
-        area += x1 * y2 - x2 * y1;
-    }
-
-    return fabs(area) / 2.0;
-}
-
 void RegionDetailWidget::addEditableName(const QString &currentName)
 {
     auto *nameContainer = new QWidget(m_contentWidget);
@@ -399,10 +374,10 @@ void RegionDetailWidget::addEditableName(const QString &currentName)
     // 当用户编辑完成后（失去焦点或按回车）触发更新
     connect(nameEdit, &QLineEdit::editingFinished, this, [this, nameEdit]() {
         QString newName = nameEdit->text().trimmed();
-        if (!newName.isEmpty() && m_currentRegion && m_regionManager) {
-            if (m_regionManager->updateRegionName(m_currentRegion->regionId, newName)) {
-                emit nameChanged(m_currentRegion->regionId, newName);
-                qDebug() << "区域名称已更新: ID =" << m_currentRegion->regionId << ", 新名称 =" << newName;
+        if (!newName.isEmpty() && m_currentRegion.regionId != 0 && m_regionManager) {
+            if (m_regionManager->updateRegionName(m_currentRegion.regionId, newName)) {
+                emit nameChanged(m_currentRegion.regionId, newName);
+                qDebug() << "区域名称已更新: ID =" << m_currentRegion.regionId << ", 新名称 =" << newName;
             }
         }
     });
@@ -26,7 +26,7 @@ public:
     explicit RegionDetailWidget(QWidget *parent = nullptr);
     void setTaskManager(TaskManager *taskManager) { m_taskManager = taskManager; }
     void setRegionManager(RegionManager *regionManager) { m_regionManager = regionManager; }
-    void showRegion(const RegionInfo *info, const QPoint &screenPos);
+    void showRegion(const RegionInfo &region, const QPoint &screenPos);
 
 signals:
     void terrainChanged(int regionId, TerrainType newTerrain);
@@ -40,14 +40,13 @@ private:
     void addTerrainLine(const QString &label, TerrainType currentTerrain);
     void addDeleteButton();
     QString getColorName(const QString &color) const;
-    double calculateTaskRegionArea(const QMapLibre::Coordinates &vertices) const;
 
 private:
     TaskManager *m_taskManager = nullptr;
     RegionManager *m_regionManager = nullptr;
     QWidget *m_contentWidget;
     QVBoxLayout *m_contentLayout;
-    const RegionInfo *m_currentRegion;
+    RegionInfo m_currentRegion;    // 当前显示的区域（副本）
     QPushButton *m_deleteButton;
 };
 
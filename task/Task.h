@@ -42,7 +42,7 @@ public:
     void setId(int id) { m_id = id; }
     void setName(const QString &name) { m_name = name; }
     void setDescription(const QString &description) { m_description = description; }
-    void setVisible(bool visible) { m_visible = visible; }
+    void setVisible(bool visible) { m_visible = visible; }  // 已登记的任务请用 TaskManager::setTaskVisible（维护区域可见引用计数）
 
     // 新增字段的 setter
     void setTaskType(const QString &type) { m_taskType = type; }
@@ -146,11 +146,13 @@ TaskLeftControlWidget::TaskLeftControlWidget(TaskManager *taskManager, QWidget *
     connect(m_taskManager, &TaskManager::currentTaskChanged,
             this, &TaskLeftControlWidget::onCurrentTaskChanged);
 
-    // 连接区域管理器信号，自动刷新区域列表
-    connect(m_taskManager->regionManager(), &RegionManager::regionCreated,
-            this, &TaskLeftControlWidget::onRegionListChanged);
-    connect(m_taskManager->regionManager(), &RegionManager::regionRemoved,
-            this, &TaskLeftControlWidget::onRegionListChanged);
+    // 连接区域管理器的合并变化信号，自动刷新区域列表（批量编辑只刷新一次）
+    connect(m_taskManager->regionManager(), &RegionManager::regionsChanged,
+            this, [this](const RegionChangeSet &changes) {
+                if (changes.membershipChanged()) {
+                    onRegionListChanged();
+                }
+            });
 
     // 设置默认宽度（展开状态：主内容 + 收缩条）
     setFixedWidth(m_expandedWidth + m_collapsedWidth);
@@ -727,6 +729,7 @@ void TaskLeftControlWidget::onExportTasks()
             regionObj["type"] = static_cast<int>(region->type());
             regionObj["annotationId"] = static_cast<qint64>(region->annotationId());
             regionObj["terrainType"] = static_cast<int>(region->terrainType());
+            regionObj["name"] = region->name();
 
             // 根据类型保存坐标数据
             switch (region->type()) {
@@ -763,6 +766,14 @@ void TaskLeftControlWidget::onExportTasks()
                         coordsArray.append(coordObj);
                     }
                     regionObj["coordinates"] = coordsArray;
+                    regionObj["shape"] = static_cast<int>(region->taskRegionShape());
+                    if (region->taskRegionShape() == TaskRegionShape::Circle) {
+                        QJsonObject centerObj;
+                        centerObj["lat"] = region->coordinate().first;
+                        centerObj["lon"] = region->coordinate().second;
+                        regionObj["center"] = centerObj;
+                        regionObj["radius"] = region->radius();
+                    }
                 }
                 break;
             }
@@ -831,6 +842,10 @@ void TaskLeftControlWidget::onImportTasks()
     QJsonArray tasksArray = rootObj["tasks"].toArray();
     int importedCount = 0;
     int skippedCount = 0;
+    QStringList importNotes;   // 被修复或跳过的区域
+
+    // 整个导入作为一个变化事务，区域列表等界面只在导入结束时刷新一次
+    m_taskManager->beginChanges();
 
     for (const QJsonValue &taskValue : tasksArray) {
         if (!taskValue.isObject()) continue;
@@ -946,71 +961,69 @@ void TaskLeftControlWidget::onImportTasks()
             continue;
         }
 
-        newTask->setVisible(taskVisible);
+        m_taskManager->setTaskVisible(newTask->id(), taskVisible);
 
-        // 导入区域
+        // 导入区域：先收集全部参数，再一次性批量创建（不逐个弹出命名对话框）
         QJsonArray regionsArray = taskObj["regions"].toArray();
+        QVector<RegionSpec> specs;
+        specs.reserve(regionsArray.size());
         for (const QJsonValue &regionValue : regionsArray) {
             if (!regionValue.isObject()) continue;
 
             QJsonObject regionObj = regionValue.toObject();
-            Region::Type type = static_cast<Region::Type>(regionObj["type"].toInt());
-            Region::TerrainType terrainType = static_cast<Region::TerrainType>(regionObj["terrainType"].toInt());
+            RegionSpec spec;
+            spec.type = toRegionType(regionObj["type"].toInt());
+            spec.name = regionObj["name"].toString();
+            spec.terrainType = toTerrainType(regionObj["terrainType"].toInt());
 
-            switch (type) {
-            case RegionType::LoiterPoint: {
+            switch (spec.type) {
+            case RegionType::LoiterPoint:
+            case RegionType::UAV: {
                 QJsonObject coordObj = regionObj["coordinate"].toObject();
-                double lat = coordObj["lat"].toDouble();
-                double lon = coordObj["lon"].toDouble();
-                auto id = m_taskManager->addLoiterPointToTask(taskId, lat, lon);
-                if (id > 0) {
-                    m_taskManager->regionManager()->updateRegionTerrainType(id, terrainType);
+                spec.coordinate = QMapLibre::Coordinate(coordObj["lat"].toDouble(), coordObj["lon"].toDouble());
+                if (spec.type == RegionType::UAV) {
+                    spec.color = regionObj["color"].toString("black");
                 }
                 break;
             }
 
             case RegionType::NoFlyZone: {
                 QJsonObject centerObj = regionObj["center"].toObject();
-                double lat = centerObj["lat"].toDouble();
-                double lon = centerObj["lon"].toDouble();
-                double radius = regionObj["radius"].toDouble();
-                auto id = m_taskManager->addNoFlyZoneToTask(taskId, lat, lon, radius);
-                if (id > 0) {
-                    m_taskManager->regionManager()->updateRegionTerrainType(id, terrainType);
-                }
-                break;
-            }
-
-            case RegionType::UAV: {
-                QJsonObject coordObj = regionObj["coordinate"].toObject();
-                double lat = coordObj["lat"].toDouble();
-                double lon = coordObj["lon"].toDouble();
-                QString color = regionObj["color"].toString("black");
-                auto id = m_taskManager->addUAVToTask(taskId, lat, lon, color);
-                if (id > 0) {
-                    m_taskManager->regionManager()->updateRegionTerrainType(id, terrainType);
-                }
+                spec.coordinate = QMapLibre::Coordinate(centerObj["lat"].toDouble(), centerObj["lon"].toDouble());
+                spec.radius = regionObj["radius"].toDouble();
                 break;
             }
 
             case RegionType::TaskRegion: {
                 QJsonArray coordsArray = regionObj["coordinates"].toArray();
-                QMapLibre::Coordinates coords;
                 for (const QJsonValue &coordValue : coordsArray) {
                     QJsonObject coordObj = coordValue.toObject();
-                    double lat = coordObj["lat"].toDouble();
-                    double lon = coordObj["lon"].toDouble();
-                    coords.append(QMapLibre::Coordinate(lat, lon));
+                    spec.vertices.append(QMapLibre::Coordinate(coordObj["lat"].toDouble(), coordObj["lon"].toDouble()));
                 }
-                if (coords.size() >= 3) {
-                    auto id = m_taskManager->addTaskRegionToTask(taskId, coords);
-                    if (id > 0) {
-                        m_taskManager->regionManager()->updateRegionTerrainType(id, terrainType);
-                    }
+                spec.shape = static_cast<TaskRegionShape>(regionObj["shape"].toInt(0));
+                if (spec.shape == TaskRegionShape::Circle) {
+                    QJsonObject centerObj = regionObj["center"].toObject();
+                    spec.coordinate = QMapLibre::Coordinate(centerObj["lat"].toDouble(), centerObj["lon"].toDouble());
+                    spec.radius = regionObj["radius"].toDouble();
                 }
                 break;
             }
             }
+            specs.append(spec);
+        }
+
+        // 自相交多边形（早期版本可以保存）先修复，其余无效的区域记下原因，导入结束后一并告知
+        QStringList notes;
+        specs = RegionManager::repairSelfIntersecting(specs, &notes);
+        QVector<int> regionIds = m_taskManager->addRegionsToTask(taskId, specs);
+        for (int i = 0; i < regionIds.size(); ++i) {
+            QString error;
+            if (regionIds[i] == 0 && !RegionManager::validateSpec(specs[i], &error)) {
+                notes.append(QString("区域“%1”无效（%2），已跳过").arg(specs[i].name).arg(error));
+            }
+        }
+        for (const QString &note : notes) {
+            importNotes.append(QString("任务“%1”：%2").arg(taskName).arg(note));
         }
 
         importedCount++;
@@ -1018,11 +1031,21 @@ void TaskLeftControlWidget::onImportTasks()
                     .arg(taskId).arg(taskName).arg(regionsArray.size());
         }  // 关闭大括号
     }
+    m_taskManager->endChanges();
 
     // 显示导入结果
     QString resultMsg = QString("导入完成!\n成功: %1 个任务\n跳过: %2 个任务")
                         .arg(importedCount).arg(skippedCount);
-    QMessageBox::information(this, "导入结果", resultMsg);
+    if (!importNotes.isEmpty()) {
+        const int maxShown = 10;
+        resultMsg += QString("\n\n以下区域已修复或跳过:\n%1").arg(importNotes.mid(0, maxShown).join("\n"));
+        if (importNotes.size() > maxShown) {
+            resultMsg += QString("\n……等共 %1 条").arg(importNotes.size());
+        }
+        QMessageBox::warning(this, "导入结果", resultMsg);
+    } else {
+        QMessageBox::information(this, "导入结果", resultMsg);
+    }
     qDebug() << resultMsg;
 }
 
@@ -1038,7 +1061,7 @@ void TaskLeftControlWidget::refreshRegionList()
     }
 
     // 获取所有区域
-    const QMap<int, Region*>& allRegions = m_taskManager->regionManager()->getAllRegions();
+    const RegionArena &allRegions = m_taskManager->regionManager()->getAllRegions();
 
     // 筛选任务区域
     QVector<Region*> polygons;
@@ -1057,8 +1080,8 @@ void TaskLeftControlWidget::refreshRegionList()
     } else {
         // 显示任务区域列表
         for (Region *polygon : polygons) {
-            // 计算面积
-            double areaKm2 = calculateTaskRegionArea(polygon->vertices());
+            // 面积（派生几何中已缓存）
+            double areaKm2 = polygon->geometry().area / 1000000.0;
 
             // 创建区域项
             auto *regionItem = new QFrame();
@@ -1079,7 +1102,7 @@ void TaskLeftControlWidget::refreshRegionList()
             itemLayout->setSpacing(4);
 
             // 区域ID
-            auto *idLabel = new QLabel(QString("区域 ID: %1").arg(polygon->id()));
+            auto *idLabel = new QLabel(QString("区域 ID: %1").arg(polygon->number()));
             idLabel->setStyleSheet("font-weight: bold; font-size: 12px;");
 
             // 区域面积
@@ -1095,32 +1118,3 @@ void TaskLeftControlWidget::refreshRegionList()
 
     m_regionContentLayout->addStretch();
 }
-
-double TaskLeftControlWidget::calculateTaskRegionArea(const QMapLibre::Coordinates &coords)
-{
-    if (coords.size() < 3) {
-        return 0.0;
-    }
-
-    // 使用 Shoelace 公式计算多边形面积（球面近似）
-    // 地球半径（公里）
-    const double EARTH_RADIUS_KM = 6371.0;
-
-    double area = 0.0;
-    int n = coords.size();
-
-    for (int i = 0; i < n; i++) {
-        int j = (i + 1) % n;
-
-        double lat1 = coords[i].first * M_PI / 180.0;  // 转换为弧度
-        double lon1 = coords[i].second * M_PI / 180.0;
-        double lat2 = coords[j].first * M_PI / 180.0;
-        double lon2 = coords[j].second * M_PI / 180.0;
-
-        area += (lon2 - lon1) * (2.0 + std::sin(lat1) + std::sin(lat2));
-    }
-
-    area = std::abs(area) * EARTH_RADIUS_KM * EARTH_RADIUS_KM / 2.0;
-
-    return area;
-}
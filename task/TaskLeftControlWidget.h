@@ -92,7 +92,6 @@ private:
     void removeTaskItem(int taskId);
     void highlightCurrentTask(int taskId);
     void refreshRegionList();  // 刷新区域列表
-    double calculateTaskRegionArea(const QMapLibre::Coordinates &coords);  // 计算任务区域面积（km²）
 
 private:
     TaskManager *m_taskManager;
@@ -2,30 +2,18 @@
 // SPDX-License-Identifier: MIT
 
 #include "TaskManager.h"
+#include "EditJournal.h"
+#include "map_region/ConflictMonitor.h"
+#include "map_region/Geodesy.h"
 #include <QDebug>
 #include <QtMath>
+#include <QTimer>
 #include <cmath>
-
-// 计算两点之间的距离（米）- 辅助函数
-static double calculateDistance(double lat1, double lon1, double lat2, double lon2)
-{
-    const double EARTH_RADIUS = 6378137.0; // 地球半径（米）
-
-    double dLat = (lat2 - lat1) * M_PI / 180.0;
-    double dLon = (lon2 - lon1) * M_PI / 180.0;
-
-    double a = qSin(dLat / 2) * qSin(dLat / 2) +
-               qCos(lat1 * M_PI / 180.0) * qCos(lat2 * M_PI / 180.0) *
-               qSin(dLon / 2) * qSin(dLon / 2);
-
-    double c = 2 * qAtan2(qSqrt(a), qSqrt(1 - a));
-    return EARTH_RADIUS * c;
-}
+#include <algorithm>
 
 TaskManager::TaskManager(RegionManager *regionMgr, QObject *parent)
     : QObject(parent)
     , m_regionMgr(regionMgr)
-    , m_painter(nullptr)  // 旧版兼容，保留但不使用
     , m_currentTask(nullptr)
     , m_nextTaskId(1)
 {
@@ -33,6 +21,10 @@ TaskManager::TaskManager(RegionManager *regionMgr, QObject *parent)
     if (m_regionMgr) {
         connect(m_regionMgr, &RegionManager::regionRemoved,
                 this, &TaskManager::onRegionRemoved);
+
+        // 编辑日志须在上面的连接之后创建，才能在任务引用清除后收到 regionRemoved
+        m_journal = new EditJournal(this, m_regionMgr, EditJournal::DEFAULT_CAPACITY, this);
+        m_conflictMonitor = new ConflictMonitor(m_regionMgr, this);
     }
 }
 
@@ -41,6 +33,8 @@ TaskManager::~TaskManager()
     // 删除所有任务（Task 析构函数会清理 m_regionIds）
     qDeleteAll(m_tasks);
     m_tasks.clear();
+    m_taskById.clear();
+    m_regionTasks.clear();
 }
 
 // ==================== 任务管理 ====================
@@ -61,6 +55,8 @@ Task* TaskManager::createTask(int id, const QString &name, const QString &descri
 
     Task *task = new Task(id, name, description);
     m_tasks.append(task);
+    m_taskById.insert(id, task);
+    markTaskSnapshotDirty(id);
 
     // 更新 nextTaskId（确保导入时不会冲突）
     if (id >= m_nextTaskId) {
@@ -75,41 +71,146 @@ Task* TaskManager::createTask(int id, const QString &name, const QString &descri
 
 Task* TaskManager::getTask(int taskId)
 {
-    for (Task *task : m_tasks) {
-        if (task->id() == taskId) {
-            return task;
+    return m_taskById.value(taskId, nullptr);
+}
+
+void TaskManager::removeTask(int taskId)
+{
+    Task *task = m_taskById.take(taskId);
+    if (!task) {
+        return;
+    }
+
+    // 如果是当前任务，需要发射信号通知UI
+    bool wasCurrentTask = (m_currentTask == task);
+    if (wasCurrentTask) {
+        m_currentTask = nullptr;
+    }
+
+    // 删除任务（不删除关联的区域，只清除反向索引中的引用）
+    const QSet<int> &taskRegionIds = task->regionIds();
+    QVector<int> regionIds(taskRegionIds.cbegin(), taskRegionIds.cend());
+    for (int regionId : regionIds) {
+        unindexRegion(task, regionId);
+    }
+    syncRegionVisibility(regionIds);
+    m_tasks.removeOne(task);
+    delete task;
+    markTaskSnapshotDirty(taskId);
+
+    qDebug() << QString("删除任务 #%1").arg(taskId);
+    emit taskRemoved(taskId);
+
+    // 如果删除的是当前任务，发射信号通知当前任务已变为无
+    if (wasCurrentTask) {
+        qDebug() << "当前任务已被删除，发射 currentTaskChanged(-1) 信号";
+        emit currentTaskChanged(-1);
+    }
+}
+
+// ==================== 变化事务 ====================
+
+void TaskManager::beginChanges()
+{
+    ++m_changeDepth;
+    m_regionMgr->beginChanges();
+}
+
+void TaskManager::endChanges()
+{
+    if (m_changeDepth == 0) {
+        qWarning() << "TaskManager::endChanges: 没有进行中的变化事务";
+        return;
+    }
+    --m_changeDepth;
+    m_regionMgr->endChanges();
+    if (m_changeDepth == 0) {
+        flushTaskChanges();
+        if (m_journal) {
+            m_journal->commit();  // 整个事务作为一条撤销记录
         }
     }
-    return nullptr;
 }
 
-void TaskManager::removeTask(int taskId)
+// ==================== 撤销/重做 ====================
+
+bool TaskManager::undo()
 {
-    for (int i = 0; i < m_tasks.size(); ++i) {
-        if (m_tasks[i]->id() == taskId) {
-            Task *task = m_tasks[i];
+    return m_journal && m_journal->undo();
+}
 
-            // 如果是当前任务，需要发射信号通知UI
-            bool wasCurrentTask = (m_currentTask == task);
-            if (wasCurrentTask) {
-                m_currentTask = nullptr;
-            }
+bool TaskManager::redo()
+{
+    return m_journal && m_journal->redo();
+}
+
+bool TaskManager::canUndo() const
+{
+    return m_journal && m_journal->canUndo();
+}
 
-            // 删除任务（不删除关联的区域，只清除引用）
-            m_tasks.removeAt(i);
-            delete task;
+bool TaskManager::canRedo() const
+{
+    return m_journal && m_journal->canRedo();
+}
+
+void TaskManager::recordTaskChange(int taskId)
+{
+    m_pendingTaskChanges.insert(taskId);
+    markTaskSnapshotDirty(taskId);
+    if (m_changeDepth > 0 || m_changeFlushPending) {
+        return;
+    }
 
-            qDebug() << QString("删除任务 #%1").arg(taskId);
-            emit taskRemoved(taskId);
+    m_changeFlushPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_changeFlushPending = false;
+        flushTaskChanges();
+    });
+}
 
-            // 如果删除的是当前任务，发射信号通知当前任务已变为无
-            if (wasCurrentTask) {
-                qDebug() << "当前任务已被删除，发射 currentTaskChanged(-1) 信号";
-                emit currentTaskChanged(-1);
-            }
+void TaskManager::flushTaskChanges()
+{
+    if (m_changeDepth > 0 || m_pendingTaskChanges.isEmpty()) {
+        return;
+    }
+
+    QSet<int> taskIds = m_pendingTaskChanges;
+    m_pendingTaskChanges.clear();
+    emit tasksChanged(taskIds);
+}
+
+// ==================== 快照 ====================
 
-            return;
+TaskSnapshot TaskManager::snapshot()
+{
+    // 第一次获取快照时整体发布；之后只重新发布变化过的任务
+    if (m_taskSnapshotVersion == 0) {
+        m_publishedTasks.reserve(m_tasks.size());
+        for (const Task *task : m_tasks) {
+            m_publishedTasks.insert(task->id(), *task);
+        }
+        m_taskSnapshotDirty.clear();
+        ++m_taskSnapshotVersion;
+    } else if (!m_taskSnapshotDirty.isEmpty()) {
+        for (int taskId : m_taskSnapshotDirty) {
+            if (const Task *task = getTask(taskId)) {
+                m_publishedTasks.insert(taskId, *task);
+            } else {
+                m_publishedTasks.remove(taskId);
+            }
         }
+        m_taskSnapshotDirty.clear();
+        ++m_taskSnapshotVersion;
+    }
+    // 反向索引始终是最新的，直接共享
+    return TaskSnapshot(m_regionMgr->snapshot(), m_publishedTasks, m_regionTasks, m_taskSnapshotVersion);
+}
+
+void TaskManager::markTaskSnapshotDirty(int taskId)
+{
+    if (m_taskSnapshotVersion > 0) {
+        m_taskSnapshotDirty.insert(taskId);
     }
 }
 
@@ -143,12 +244,50 @@ void TaskManager::addRegionToTask(int taskId, int regionId)
         return;
     }
 
+    if (task->hasRegion(regionId)) {
+        return;  // 已关联
+    }
+
     task->addRegion(regionId);
+    indexRegion(task, regionId);
+    syncRegionVisibility({regionId});
+    emit regionAddedToTask(taskId, regionId);
     qDebug() << QString("添加区域 #%1 (%2) 到任务 #%3 (%4)")
                 .arg(regionId).arg(region->name())
                 .arg(taskId).arg(task->name());
 
     emit taskRegionsChanged(taskId);
+    recordTaskChange(taskId);
+}
+
+QVector<int> TaskManager::addRegionsToTask(int taskId, const QVector<RegionSpec> &specs)
+{
+    Task *task = getTask(taskId);
+    if (!task) {
+        qWarning() << QString("任务 #%1 不存在").arg(taskId);
+        return QVector<int>(specs.size(), 0);
+    }
+
+    ChangeScope scope(this);
+    QVector<int> regionIds = m_regionMgr->createRegions(specs);
+    int added = 0;
+    for (int regionId : regionIds) {
+        if (regionId > 0) {
+            task->addRegion(regionId);
+            indexRegion(task, regionId);
+            emit regionAddedToTask(taskId, regionId);
+            ++added;
+        }
+    }
+    syncRegionVisibility(regionIds);
+
+    if (added > 0) {
+        qDebug() << QString("批量添加 %1 个区域到任务 #%2 (%3)")
+                    .arg(added).arg(taskId).arg(task->name());
+        emit taskRegionsChanged(taskId);
+        recordTaskChange(taskId);
+    }
+    return regionIds;
 }
 
 void TaskManager::removeRegionFromTask(int taskId, int regionId)
@@ -160,8 +299,12 @@ void TaskManager::removeRegionFromTask(int taskId, int regionId)
     }
 
     if (task->removeRegion(regionId)) {
+        unindexRegion(task, regionId);
+        syncRegionVisibility({regionId});
+        emit regionRemovedFromTask(taskId, regionId);
         qDebug() << QString("从任务 #%1 移除区域 #%2").arg(taskId).arg(regionId);
         emit taskRegionsChanged(taskId);
+        recordTaskChange(taskId);
     } else {
         qWarning() << QString("任务 #%1 不包含区域 #%2").arg(taskId).arg(regionId);
     }
@@ -198,9 +341,17 @@ void TaskManager::clearTaskRegions(int taskId)
         return;
     }
 
+    ChangeScope scope(this);
+    const QSet<int> regionIds = task->regionIds();
     task->clearRegions();
+    for (int regionId : regionIds) {
+        unindexRegion(task, regionId);
+        emit regionRemovedFromTask(taskId, regionId);
+    }
+    syncRegionVisibility(QVector<int>(regionIds.cbegin(), regionIds.cend()));
     qDebug() << QString("清除任务 #%1 的所有区域关联").arg(taskId);
     emit taskRegionsChanged(taskId);
+    recordTaskChange(taskId);
 }
 
 // ==================== 可见性控制 ====================
@@ -217,7 +368,16 @@ void TaskManager::setTaskVisible(int taskId, bool visible)
         return;  // 状态未变化
     }
 
+    // 只调整该任务区域的可见引用计数，计数跨过 0 的区域才需要切换显示
     task->setVisible(visible);
+    markTaskSnapshotDirty(taskId);
+    for (int regionId : task->regionIds()) {
+        int &refs = m_visibleRefs[regionId];
+        refs += visible ? 1 : -1;
+        if (refs <= 0) {
+            m_visibleRefs.remove(regionId);
+        }
+    }
     updateTaskVisibility(task);
 
     qDebug() << QString("任务 #%1 可见性: %2").arg(taskId).arg(visible ? "显示" : "隐藏");
@@ -244,47 +404,36 @@ void TaskManager::updateTaskVisibility(Task *task)
         return;
     }
 
-    // 遍历任务的所有区域，设置可见性
-    for (int regionId : task->regionIds()) {
-        if (task->isVisible()) {
-            m_regionMgr->showRegion(regionId);
-        } else {
-            m_regionMgr->hideRegion(regionId);
-        }
-    }
+    // 整个任务的区域按引用计数同步，共享区域由其他可见任务决定
+    QVector<int> regionIds(task->regionIds().cbegin(), task->regionIds().cend());
+    syncRegionVisibility(regionIds);
 }
 
 // ==================== 查找（兼容旧版）====================
 
 Region* TaskManager::findVisibleRegionNear(const QMapLibre::Coordinate &clickCoord, double threshold)
 {
-    double minDistance = threshold;
-    Region *nearestRegion = nullptr;
-
-    // 遍历所有可见任务的区域
-    for (Task *task : m_tasks) {
-        if (!task->isVisible()) {
-            continue;  // 跳过不可见的任务
+    // 区域锚点（点/圆心/多边形内部点）总在其包围盒内，按阈值外扩查询即可取到所有候选；
+    // 只考虑属于可见任务的区域
+    QVector<Region*> candidates;
+    GeoPoints anchors;
+    GeoBounds searchBounds = GeoBounds::fromPoint(clickCoord).expanded(threshold);
+    m_regionMgr->visitRegions(searchBounds, [&](Region *region) {
+        if (visibleTaskReferencing(region->id())) {
+            candidates.append(region);
+            anchors.append(region->geometry().anchor);
         }
+        return true;
+    });
 
-        // 遍历任务的所有区域
-        for (int regionId : task->regionIds()) {
-            Region *region = m_regionMgr->getRegion(regionId);
-            if (!region) {
-                continue;
-            }
-
-            // 计算距离
-            double distance = calculateDistance(
-                clickCoord.first, clickCoord.second,
-                region->coordinate().first, region->coordinate().second
-            );
-
-            // 找到最近的区域
-            if (distance < minDistance) {
-                minDistance = distance;
-                nearestRegion = region;
-            }
+    // 批量计算距离（阈值范围内的命中测试，近似距离足够）
+    QVector<double> distances = Geodesy::fastDistances(clickCoord, anchors);
+    double minDistance = threshold;
+    Region *nearestRegion = nullptr;
+    for (int i = 0; i < candidates.size(); ++i) {
+        if (distances[i] < minDistance) {
+            minDistance = distances[i];
+            nearestRegion = candidates[i];
         }
     }
 
@@ -293,56 +442,65 @@ Region* TaskManager::findVisibleRegionNear(const QMapLibre::Coordinate &clickCoo
 
 bool TaskManager::isInAnyNoFlyZone(const QMapLibre::Coordinate &coord) const
 {
-    // 全局检查所有禁飞区（不限于当前任务）
-    const QMap<int, Region*>& allRegions = m_regionMgr->getAllRegions();
-
-    for (Region *region : allRegions) {
-        if (!region || region->type() != RegionType::NoFlyZone) {
-            continue;
+    // 全局检查所有禁飞区（不限于当前任务），空间索引只返回包围盒覆盖该点的区域
+    bool inZone = false;
+    m_regionMgr->visitRegions(GeoBounds::fromPoint(coord), [&](Region *region) {
+        if (region->type() != RegionType::NoFlyZone) {
+            return true;
         }
 
         // 计算点到圆心的距离
-        double distance = calculateDistance(
+        double distance = Geodesy::distance(
             coord.first, coord.second,
             region->coordinate().first, region->coordinate().second
         );
 
         // 如果距离小于半径，说明在禁飞区内
         if (distance <= region->radius()) {
-            return true;
+            inZone = true;
+            return false;
         }
-    }
+        return true;
+    });
 
-    return false;
+    return inZone;
 }
 
 QVector<Region*> TaskManager::checkNoFlyZoneConflictWithUAVs(double centerLat, double centerLon, double radius) const
 {
-    QVector<Region*> conflictUAVs;
-
-    // 全局检查所有无人机（不限于当前任务）
-    const QMap<int, Region*>& allRegions = m_regionMgr->getAllRegions();
-
-    for (Region *region : allRegions) {
-        if (!region || region->type() != RegionType::UAV) {
-            continue;
+    // 全局检查所有无人机（不限于当前任务），只取禁飞区外接包围盒内的候选
+    QMapLibre::Coordinate center(centerLat, centerLon);
+    QVector<Region*> candidates;
+    GeoPoints positions;
+    m_regionMgr->visitRegions(GeoBounds::fromCircle(center, radius), [&](Region *region) {
+        if (region->type() == RegionType::UAV) {
+            candidates.append(region);
+            positions.append(region->coordinate());
         }
+        return true;
+    });
 
-        // 计算无人机到禁飞区中心的距离
-        double distance = calculateDistance(
-            region->coordinate().first, region->coordinate().second,
-            centerLat, centerLon
-        );
-
-        // 如果距离小于半径，说明无人机在禁飞区内
-        if (distance <= radius) {
-            conflictUAVs.append(region);
+    // 批量计算无人机到禁飞区中心的距离，小于半径说明无人机在禁飞区内
+    QVector<double> distances = Geodesy::distances(center, positions);
+    QVector<Region*> conflictUAVs;
+    for (int i = 0; i < candidates.size(); ++i) {
+        if (distances[i] <= radius) {
+            conflictUAVs.append(candidates[i]);
         }
     }
 
     return conflictUAVs;
 }
 
+ConflictReport TaskManager::checkAllConflicts() const
+{
+    ConflictReport report = ConflictEngine::run(m_regionMgr->snapshot());
+    qDebug() << QString("冲突检查: %1 个区域 x %2 个禁飞区，发现 %3 处冲突，耗时 %4 ms")
+                .arg(report.checkedRegions).arg(report.noFlyZones)
+                .arg(report.conflicts.size()).arg(report.elapsedMs);
+    return report;
+}
+
 // ==================== 旧版接口（保留兼容）====================
 
 QMapLibre::AnnotationID TaskManager::addLoiterPoint(double lat, double lon)
@@ -567,78 +725,149 @@ void TaskManager::clearCurrentTask()
     qDebug() << QString("任务 #%1 的所有区域关联已清除").arg(m_currentTask->id());
 }
 
-const RegionInfo* TaskManager::findVisibleElementNear(const QMapLibre::Coordinate &clickCoord, double threshold) const
+bool TaskManager::findVisibleElementAt(const QPointF &pixel, RegionInfo &info, double tolerance) const
 {
-    // 通过 RegionManager 找到最近的区域
-    const RegionInfo* nearestElement = m_regionMgr->findRegionInfoNear(clickCoord, threshold);
-
-    if (!nearestElement) {
-        return nullptr;
+    // 通过 RegionManager 在屏幕空间找到点击处的区域
+    RegionInfo nearestElement;
+    if (!m_regionMgr->findRegionInfoAtPixel(pixel, tolerance, nearestElement)) {
+        return false;
     }
 
     // 通过 annotationId 找到对应的 Region
-    Region *region = m_regionMgr->findRegionByAnnotationId(nearestElement->annotationId);
+    Region *region = m_regionMgr->findRegionByAnnotationId(nearestElement.annotationId);
     if (!region) {
-        return nullptr;
+        return false;
     }
 
-    // 创建增强的 RegionInfo 副本
-    static RegionInfo enhancedInfo;
-    enhancedInfo = *nearestElement;
-    enhancedInfo.regionId = region->id();
-    enhancedInfo.terrainType = static_cast<TerrainType>(region->terrainType());
+    // 补充区域和所属任务的信息
+    info = nearestElement;
+    info.regionId = region->id();
+    info.regionName = region->name();
+    info.terrainType = static_cast<TerrainType>(region->terrainType());
+    info.area = region->geometry().area;
 
-    // 检查该区域是否属于某个可见的任务
-    for (Task *task : m_tasks) {
-        if (task->isVisible() && task->hasRegion(region->id())) {
-            enhancedInfo.taskId = task->id();
-            enhancedInfo.taskName = task->name();
-            return &enhancedInfo;
-        }
+    // 检查该区域是否属于某个可见的任务，否则为独立区域（不属于任何任务）
+    if (Task *task = visibleTaskReferencing(region->id())) {
+        info.taskId = task->id();
+        info.taskName = task->name();
+    } else {
+        info.taskId = -1;
+        info.taskName = QString();
     }
-
-    // 独立区域（不属于任何任务）
-    enhancedInfo.taskId = -1;
-    enhancedInfo.taskName = "";
-    return &enhancedInfo;
+    return true;
 }
 
 int TaskManager::getRegionReferenceCount(int regionId) const
 {
-    int count = 0;
-    for (Task *task : m_tasks) {
-        if (task->hasRegion(regionId)) {
-            count++;
-        }
-    }
-    return count;
+    auto it = m_regionTasks.constFind(regionId);
+    return it != m_regionTasks.constEnd() ? it.value().size() : 0;
 }
 
 QVector<Task*> TaskManager::getTasksReferencingRegion(int regionId) const
 {
     QVector<Task*> referencingTasks;
-    for (Task *task : m_tasks) {
-        if (task->hasRegion(regionId)) {
-            referencingTasks.append(task);
-        }
+    auto it = m_regionTasks.constFind(regionId);
+    if (it == m_regionTasks.constEnd()) {
+        return referencingTasks;
     }
+
+    referencingTasks.reserve(it.value().size());
+    for (int taskId : it.value()) {
+        referencingTasks.append(m_taskById.value(taskId));
+    }
+    // 按任务ID排序，结果与任务创建顺序一致、不受哈希顺序影响
+    std::sort(referencingTasks.begin(), referencingTasks.end(), [](const Task *a, const Task *b) {
+        return a->id() < b->id();
+    });
     return referencingTasks;
 }
 
+Task* TaskManager::visibleTaskReferencing(int regionId) const
+{
+    Task *result = nullptr;
+    auto it = m_regionTasks.constFind(regionId);
+    if (it == m_regionTasks.constEnd()) {
+        return result;
+    }
+
+    // 取ID最小的可见任务
+    for (int taskId : it.value()) {
+        Task *task = m_taskById.value(taskId);
+        if (task && task->isVisible() && (!result || task->id() < result->id())) {
+            result = task;
+        }
+    }
+    return result;
+}
+
 // ==================== 私有方法 ====================
 
 void TaskManager::onRegionRemoved(int regionId)
 {
-    // 当区域被删除时，清理所有任务中的引用
-    for (Task *task : m_tasks) {
-        if (task->removeRegion(regionId)) {
+    // 当区域被删除时，清理引用它的任务（反向索引中只有这些任务）
+    const QSet<int> taskIds = m_regionTasks.take(regionId);
+    m_visibleRefs.remove(regionId);
+    for (int taskId : taskIds) {
+        Task *task = m_taskById.value(taskId);
+        if (task && task->removeRegion(regionId)) {
+            emit regionRemovedFromTask(taskId, regionId);
             qDebug() << QString("从任务 #%1 自动移除已删除的区域 #%2")
-                        .arg(task->id()).arg(regionId);
-            emit taskRegionsChanged(task->id());
+                        .arg(taskId).arg(regionId);
+            emit taskRegionsChanged(taskId);
+            recordTaskChange(taskId);
+        }
+    }
+}
+
+void TaskManager::indexRegion(const Task *task, int regionId)
+{
+    m_regionTasks[regionId].insert(task->id());
+    if (task->isVisible()) {
+        ++m_visibleRefs[regionId];
+    }
+}
+
+void TaskManager::unindexRegion(const Task *task, int regionId)
+{
+    auto it = m_regionTasks.find(regionId);
+    if (it == m_regionTasks.end() || !it.value().remove(task->id())) {
+        return;
+    }
+    if (it.value().isEmpty()) {
+        m_regionTasks.erase(it);
+    }
+
+    if (task->isVisible()) {
+        auto refs = m_visibleRefs.find(regionId);
+        if (refs != m_visibleRefs.end() && --refs.value() <= 0) {
+            m_visibleRefs.erase(refs);
         }
     }
 }
 
+void TaskManager::syncRegionVisibility(const QVector<int> &regionIds)
+{
+    QVector<int> shown;
+    QVector<int> hidden;
+    for (int regionId : regionIds) {
+        Region *region = m_regionMgr->getRegion(regionId);
+        if (!region) {
+            continue;
+        }
+        bool visible = regionShouldBeVisible(regionId);
+        if (region->isVisible() != visible) {
+            (visible ? shown : hidden).append(regionId);
+        }
+    }
+
+    if (!shown.isEmpty()) {
+        m_regionMgr->setRegionsVisible(shown, true);
+    }
+    if (!hidden.isEmpty()) {
+        m_regionMgr->setRegionsVisible(hidden, false);
+    }
+}
+
 int TaskManager::generateNextTaskId()
 {
     return m_nextTaskId++;
@@ -654,7 +883,6 @@ void TaskManager::showTaskElements(Task *task)
 
 void TaskManager::hideTaskElements(Task *task)
 {
-    // 旧版方法，新架构通过 updateTaskVisibility 实现
-    task->setVisible(false);
-    updateTaskVisibility(task);
+    // 旧版方法，新架构通过 setTaskVisible 实现（维护可见引用计数）
+    setTaskVisible(task->id(), false);
 }
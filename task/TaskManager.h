@@ -5,13 +5,19 @@
 #define TASKMANAGER_H
 
 #include "Task.h"
+#include "TaskSnapshot.h"
 #include "map_region/MapRegionTypes.h"
 #include "map_region/Region.h"
 #include "map_region/RegionManager.h"
-#include "map_region/MapPainter.h"
+#include "map_region/ConflictEngine.h"
 #include <QObject>
 #include <QVector>
 #include <QMap>
+#include <QHash>
+#include <QSet>
+
+class EditJournal;
+class ConflictMonitor;
 
 /**
  * @brief 任务管理器 - 管理任务和任务-区域关联
@@ -20,6 +26,12 @@
  * - 管理任务的生命周期
  * - 管理任务与区域的关联关系
  * - 控制任务的可见性（间接控制关联区域的可见性）
+ *
+ * 任务按ID哈希索引，另维护 区域ID -> 引用它的任务ID 反向索引，按区域查任务只与引用数有关。
+ * 关联变化必须通过 TaskManager（不要直接调用 Task::addRegion/removeRegion），否则索引会失效。
+ *
+ * taskRegionsChanged 每次关联变化立即发出；tasksChanged 把一次事务或一次事件循环内
+ * 变化的任务ID去重后只发出一次，界面刷新应监听它。
  */
 class TaskManager : public QObject {
     Q_OBJECT
@@ -44,7 +56,7 @@ public:
     Task* createTask(int id, const QString &name, const QString &description);
 
     /**
-     * @brief 获取任务
+     * @brief 获取任务（哈希查找，O(1)）
      */
     Task* getTask(int taskId);
 
@@ -58,6 +70,70 @@ public:
      */
     void removeTask(int taskId);
 
+    // ==================== 变化事务 ====================
+
+    /**
+     * @brief 开始一个变化事务（可嵌套，同时开启 RegionManager 的事务）
+     */
+    void beginChanges();
+
+    /**
+     * @brief 结束变化事务，最外层结束时立即发出合并后的 regionsChanged 和 tasksChanged
+     */
+    void endChanges();
+
+    /**
+     * @brief 变化事务作用域（构造时 beginChanges，析构时 endChanges）
+     */
+    class ChangeScope {
+    public:
+        explicit ChangeScope(TaskManager *manager) : m_manager(manager) { m_manager->beginChanges(); }
+        ~ChangeScope() { m_manager->endChanges(); }
+        ChangeScope(const ChangeScope &) = delete;
+        ChangeScope &operator=(const ChangeScope &) = delete;
+
+    private:
+        TaskManager *m_manager;
+    };
+
+    /**
+     * @brief 是否有进行中的变化事务
+     */
+    bool isInChanges() const { return m_changeDepth > 0; }
+
+    // ==================== 快照 ====================
+
+    /**
+     * @brief 获取任务和区域的只读快照（隐式共享，可交给工作线程做分析）
+     *
+     * 任务和区域都只重新发布上次快照之后变化过的部分，获取开销与任务/区域总数无关。
+     * 任务的描述、类型等属性在创建后由调用方直接设置，快照发布时读取的是当前值。
+     * @return 任务快照
+     */
+    TaskSnapshot snapshot();
+
+    // ==================== 撤销/重做 ====================
+
+    /**
+     * @brief 撤销最近一次区域编辑（新建/删除/属性修改/任务关联，一个事务为一步）
+     * @return 没有可撤销的编辑返回 false
+     */
+    bool undo();
+
+    /**
+     * @brief 重做最近撤销的编辑
+     * @return 没有可重做的编辑返回 false
+     */
+    bool redo();
+
+    bool canUndo() const;
+    bool canRedo() const;
+
+    /**
+     * @brief 编辑日志（可监听 stateChanged 更新撤销/重做按钮状态）
+     */
+    EditJournal* journal() const { return m_journal; }
+
     // ==================== 当前任务 ====================
 
     /**
@@ -84,6 +160,14 @@ public:
      */
     void addRegionToTask(int taskId, int regionId);
 
+    /**
+     * @brief 批量创建区域并关联到任务（无交互，只发出一次 taskRegionsChanged）
+     * @param taskId 任务ID
+     * @param specs 区域创建参数列表
+     * @return 与 specs 一一对应的区域ID，创建失败的位置为 0
+     */
+    QVector<int> addRegionsToTask(int taskId, const QVector<RegionSpec> &specs);
+
     /**
      * @brief 从任务移除区域
      * @param taskId 任务ID
@@ -108,11 +192,19 @@ public:
 
     /**
      * @brief 设置任务可见性（显示/隐藏关联的区域）
+     *
+     * 区域按可见引用计数显示：被多个任务共享的区域只要还有一个可见任务引用就保持显示，
+     * 未被任何任务引用的区域始终显示；只有计数跨过 0 的区域才会提交给渲染器。
      * @param taskId 任务ID
      * @param visible 是否可见
      */
     void setTaskVisible(int taskId, bool visible);
 
+    /**
+     * @brief 引用该区域的可见任务数（O(1)）
+     */
+    int visibleReferenceCount(int regionId) const { return m_visibleRefs.value(regionId, 0); }
+
     /**
      * @brief 显示所有任务
      */
@@ -143,18 +235,31 @@ public:
      */
     QVector<Region*> checkNoFlyZoneConflictWithUAVs(double centerLat, double centerLon, double radius) const;
 
+    /**
+     * @brief 批量检查所有无人机、盘旋点、任务区域与所有禁飞区的冲突（全局检查）
+     *
+     * 基于当前区域快照运行 ConflictEngine；需要在后台线程执行时，
+     * 可直接把 regionManager()->snapshot() 交给 ConflictEngine::run()。
+     */
+    ConflictReport checkAllConflicts() const;
+
+    /**
+     * @brief 实时冲突监视器（区域变化后增量更新，可监听 conflictsChanged 刷新界面）
+     */
+    ConflictMonitor* conflictMonitor() const { return m_conflictMonitor; }
+
     /**
      * @brief 获取区域管理器
      */
     RegionManager* regionManager() const { return m_regionMgr; }
 
     /**
-     * @brief 获取区域的引用计数（被多少个任务引用）
+     * @brief 获取区域的引用计数（被多少个任务引用，O(1)）
      */
     int getRegionReferenceCount(int regionId) const;
 
     /**
-     * @brief 获取引用某个区域的所有任务
+     * @brief 获取引用某个区域的所有任务（按任务ID排序）
      */
     QVector<Task*> getTasksReferencingRegion(int regionId) const;
 
@@ -175,7 +280,18 @@ public:
     QMapLibre::AnnotationID addTaskRegionToTask(int taskId, const QMapLibre::Coordinates &coordinates);
 
     void clearCurrentTask();
-    const RegionInfo* findVisibleElementNear(const QMapLibre::Coordinate &clickCoord, double threshold = 100.0) const;
+
+    /**
+     * @brief 查找屏幕位置处的区域，并补充所属可见任务的信息
+     *
+     * 结果按值写入调用方提供的 RegionInfo，可重入；需要在工作线程查询时使用 snapshot()。
+     * @param pixel 屏幕位置（地图控件坐标，像素）
+     * @param info 输出：区域信息
+     * @param tolerance 容差（像素）
+     * @return 找到返回 true
+     */
+    bool findVisibleElementAt(const QPointF &pixel, RegionInfo &info,
+                              double tolerance = RegionRenderer::HIT_TOLERANCE_PX) const;
 
     /**
      * @brief 生成下一个任务ID
@@ -188,6 +304,9 @@ signals:
     void taskVisibilityChanged(int taskId, bool visible);
     void currentTaskChanged(int taskId);
     void taskRegionsChanged(int taskId);  // 任务的区域列表变化
+    void tasksChanged(const QSet<int> &taskIds);  // 合并后的任务区域列表变化（每批只发一次）
+    void regionAddedToTask(int taskId, int regionId);      // 单个关联添加
+    void regionRemovedFromTask(int taskId, int regionId);  // 单个关联移除
 
 private slots:
     /**
@@ -201,16 +320,71 @@ private:
      */
     void updateTaskVisibility(Task *task);
 
+    /**
+     * @brief 引用该区域的可见任务中ID最小的一个
+     * @return 任务指针，没有可见任务引用时返回 nullptr
+     */
+    Task* visibleTaskReferencing(int regionId) const;
+
+    /**
+     * @brief 在反向索引中添加一条 任务-区域 关联（同时维护可见引用计数）
+     */
+    void indexRegion(const Task *task, int regionId);
+
+    /**
+     * @brief 从反向索引中移除一条 任务-区域 关联（同时维护可见引用计数）
+     */
+    void unindexRegion(const Task *task, int regionId);
+
+    /**
+     * @brief 区域按任务引用应处的显示状态：未被任何任务引用，或至少被一个可见任务引用
+     */
+    bool regionShouldBeVisible(int regionId) const {
+        return !m_regionTasks.contains(regionId) || m_visibleRefs.value(regionId, 0) > 0;
+    }
+
+    /**
+     * @brief 把区域的显示状态同步到引用计数决定的状态（只提交实际变化的区域，显示/隐藏各一批）
+     */
+    void syncRegionVisibility(const QVector<int> &regionIds);
+
+    /**
+     * @brief 记录任务区域列表变化，安排合并发出
+     */
+    void recordTaskChange(int taskId);
+
+    /**
+     * @brief 发出并清空待发送的任务变化
+     */
+    void flushTaskChanges();
+
+    /**
+     * @brief 标记任务需要在下一次快照时重新发布
+     */
+    void markTaskSnapshotDirty(int taskId);
+
     // 旧版兼容方法
     void showTaskElements(Task *task);
     void hideTaskElements(Task *task);
 
 private:
     RegionManager *m_regionMgr;       // 区域管理器（不拥有所有权）
-    MapPainter *m_painter;            // 地图画家（旧版兼容，不拥有所有权）
-    QVector<Task*> m_tasks;           // 任务列表（拥有所有权）
+    QVector<Task*> m_tasks;           // 任务列表（拥有所有权，保持创建顺序）
+    QHash<int, Task*> m_taskById;     // taskId -> 任务
+    QHash<int, QSet<int>> m_regionTasks; // regionId -> 引用它的任务ID（反向索引）
+    QHash<int, int> m_visibleRefs;    // regionId -> 引用它的可见任务数（为 0 时不存储）
     Task *m_currentTask;              // 当前任务
     int m_nextTaskId;                 // 下一个任务ID
+
+    QSet<int> m_pendingTaskChanges;   // 尚未发出的任务变化
+    int m_changeDepth = 0;            // 变化事务嵌套深度
+    bool m_changeFlushPending = false; // 是否已安排下一次事件循环发出变化
+    EditJournal *m_journal = nullptr;  // 撤销/重做日志（子对象）
+    ConflictMonitor *m_conflictMonitor = nullptr; // 实时冲突监视器（子对象）
+
+    QHash<int, Task> m_publishedTasks; // 已发布的任务（与快照隐式共享）
+    QSet<int> m_taskSnapshotDirty;     // 上次快照之后变化过的任务ID
+    quint64 m_taskSnapshotVersion = 0; // 快照版本号
 };
 
 #endif // TASKMANAGER_H
@@ -0,0 +1,145 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef TASKSNAPSHOT_H
+#define TASKSNAPSHOT_H
+
+#include "Task.h"
+#include "map_region/RegionSnapshot.h"
+#include "map_region/RegionGeometry.h"
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QMetaType>
+#include <algorithm>
+
+/**
+ * @brief 任务快照 - 某一时刻所有任务及其区域的只读副本
+ *
+ * 与 RegionSnapshot 一样基于隐式共享，由 TaskManager::snapshot() 以 O(1) 获取，
+ * 可交给工作线程做冲突检查、面积统计等分析，界面同时继续编辑互不影响。
+ *
+ * 所有查询都是 const 且只返回值类型，多个线程可以同时读取同一个快照（或各自的副本）。
+ */
+class TaskSnapshot {
+public:
+    TaskSnapshot() = default;
+
+    /**
+     * @brief 区域快照（与任务同一时刻）
+     */
+    const RegionSnapshot& regions() const { return m_regions; }
+
+    /**
+     * @brief 所有任务（Task 为值类型，regionIds 等成员同样隐式共享）
+     */
+    const QHash<int, Task>& tasks() const { return m_tasks; }
+
+    /**
+     * @brief 查找任务
+     * @return 任务指针，不存在返回 nullptr（指针在快照存活期间有效）
+     */
+    const Task* task(int taskId) const {
+        auto it = m_tasks.constFind(taskId);
+        return it != m_tasks.constEnd() ? &it.value() : nullptr;
+    }
+
+    /**
+     * @brief 获取任务关联的区域参数
+     * @param taskId 任务ID
+     * @return 区域参数列表（已删除的区域不包含在内）
+     */
+    QVector<RegionSpec> taskRegions(int taskId) const {
+        QVector<RegionSpec> specs;
+        if (const Task *t = task(taskId)) {
+            specs.reserve(t->regionCount());
+            for (int regionId : t->regionIds()) {
+                if (const RegionSpec *spec = m_regions.find(regionId)) {
+                    specs.append(*spec);
+                }
+            }
+        }
+        return specs;
+    }
+
+    /**
+     * @brief 引用某个区域的任务ID（按ID排序）
+     */
+    QVector<int> tasksReferencing(int regionId) const {
+        const QSet<int> taskIds = m_regionTasks.value(regionId);
+        QVector<int> result(taskIds.cbegin(), taskIds.cend());
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    /**
+     * @brief 引用该区域的可见任务中ID最小的一个
+     * @return 任务ID，没有可见任务引用时返回 -1
+     */
+    int visibleTaskReferencing(int regionId) const {
+        int result = -1;
+        for (int taskId : m_regionTasks.value(regionId)) {
+            const Task *t = task(taskId);
+            if (t && t->isVisible() && (result < 0 || taskId < result)) {
+                result = taskId;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief 获取区域信息（与 TaskManager::findVisibleElementAt 的结果字段一致，annotationId 为 0）
+     * @param regionId 区域ID
+     * @param info 输出：区域信息
+     * @return 区域不存在返回 false
+     */
+    bool regionInfo(int regionId, RegionInfo &info) const {
+        const RegionSpec *spec = m_regions.find(regionId);
+        if (!spec) {
+            return false;
+        }
+
+        info = RegionInfo();
+        info.type = spec->type;
+        info.coordinate = spec->coordinate;
+        info.vertices = spec->vertices;
+        info.radius = spec->radius;
+        info.area = RegionGeometry::fromSpec(*spec).area;
+        info.color = spec->color;
+        info.terrainType = spec->terrainType;
+        info.taskRegionShape = spec->shape;
+        info.regionId = regionId;
+        info.regionName = spec->name;
+
+        info.taskId = visibleTaskReferencing(regionId);
+        if (const Task *t = task(info.taskId)) {
+            info.taskName = t->name();
+        }
+        return true;
+    }
+
+    /**
+     * @brief 快照版本号（任务每发布一批变化加一）
+     */
+    quint64 version() const { return m_version; }
+
+private:
+    friend class TaskManager;
+
+    TaskSnapshot(const RegionSnapshot &regions, const QHash<int, Task> &tasks,
+                 const QHash<int, QSet<int>> &regionTasks, quint64 version)
+        : m_regions(regions)
+        , m_tasks(tasks)
+        , m_regionTasks(regionTasks)
+        , m_version(version)
+    {}
+
+    RegionSnapshot m_regions;   // 区域快照
+    QHash<int, Task> m_tasks;   // taskId -> 任务
+    QHash<int, QSet<int>> m_regionTasks;  // regionId -> 引用它的任务ID
+    quint64 m_version = 0;      // 快照版本号
+};
+
+Q_DECLARE_METATYPE(TaskSnapshot)
+
+#endif // TASKSNAPSHOT_H
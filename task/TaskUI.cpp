@@ -4,6 +4,9 @@
 #include "TaskUI.h"
 #include "CreateTaskPlanDialog.h"
 #include "TaskPlan.h"
+#include "map_region/ConflictMonitor.h"
+#include "map_region/Geodesy.h"
+#include "map_region/PolygonValidator.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QMessageBox>
@@ -94,6 +97,9 @@ void TaskUI::showEvent(QShowEvent *event) {
 void TaskUI::resizeEvent(QResizeEvent *event) {
     QWidget::resizeEvent(event);
     updateOverlayPositions();
+    if (m_painter) {
+        m_painter->setViewportSize(m_mapWidget->size());
+    }
 }
 
 void TaskUI::keyPressEvent(QKeyEvent *event) {
@@ -101,6 +107,25 @@ void TaskUI::keyPressEvent(QKeyEvent *event) {
         qDebug() << "按下ESC，取消多边形绘制";
         returnToNormalMode();
     }
+
+    // 撤销/重做区域编辑（绘制过程中不响应，避免与绘制状态冲突）
+    if (m_taskManager && m_currentMode == MODE_NORMAL) {
+        if (event->matches(QKeySequence::Undo)) {
+            if (m_detailWidget) {
+                m_detailWidget->hide();  // 详情面板可能指向被撤销的区域
+            }
+            m_taskManager->undo();
+            return;
+        }
+        if (event->matches(QKeySequence::Redo)
+            || (event->key() == Qt::Key_Y && event->modifiers() == Qt::ControlModifier)) {
+            if (m_detailWidget) {
+                m_detailWidget->hide();  // 详情面板可能指向被撤销的区域
+            }
+            m_taskManager->redo();
+            return;
+        }
+    }
     QWidget::keyPressEvent(event);
 }
 
@@ -428,9 +453,23 @@ void TaskUI::setupMap() {
     m_mapWidget->map()->setStyleJson(amapStyle);
 
     m_painter = new MapPainter(m_mapWidget->map(), this);
+    m_painter->setViewportSize(m_mapWidget->size());  // 只把视口附近的区域添加到地图
     m_regionManager = new RegionManager(m_painter, this);
+    m_regionManager->setNamePrompt([this](const QString &defaultName) {
+        // 弹出命名对话框，取消时返回空字符串（撤销创建）
+        RegionPropertyDialog dialog(defaultName, this);
+        if (dialog.exec() == QDialog::Accepted) {
+            QString name = dialog.getRegionName().trimmed();
+            return name.isEmpty() ? defaultName : name;
+        }
+        return QString();
+    });
     m_taskManager = new TaskManager(m_regionManager, this);
 
+    // 区域名称标签层（覆盖在地图上，不接收鼠标事件）
+    m_labelLayer = new MapLabelLayer(m_mapWidget->map(), m_painter, m_regionManager, m_mapWidget);
+    m_labelLayer->show();
+
     m_taskListWidget = new TaskLeftControlWidget(m_taskManager, m_mapWidget);
     m_taskListWidget->setCollapsible(true);
     m_taskListWidget->show();
@@ -460,11 +499,33 @@ void TaskUI::setupMap() {
     connect(m_taskManager, &TaskManager::currentTaskChanged,
             this, &TaskUI::onCurrentTaskChanged);
 
+    // 导入、撤销/重做等放置之外的变化同样会产生冲突，由监视器统一提示
+    connect(m_taskManager->conflictMonitor(), &ConflictMonitor::conflictAdded,
+            this, [this](const RegionConflict &conflict) {
+                Region *region = m_regionManager->getRegion(conflict.regionId);
+                Region *zone = m_regionManager->getRegion(conflict.noFlyZoneId);
+                if (!region || !zone) {
+                    return;
+                }
+                qWarning() << QString("区域「%1」进入禁飞区「%2」，侵入 %3 米")
+                              .arg(region->name()).arg(zone->name())
+                              .arg(conflict.penetration, 0, 'f', 1);
+                m_mapWidget->setStatusText(QString("警告：区域「%1」与禁飞区「%2」冲突（共 %3 处冲突）")
+                                           .arg(region->name()).arg(zone->name())
+                                           .arg(m_taskManager->conflictMonitor()->count()),
+                                           "rgba(248, 215, 218, 220)");
+            });
+
     emit initialized();
     qDebug() << "TaskUI 地图初始化完成";
 }
 
 void TaskUI::updateOverlayPositions() {
+    if (m_labelLayer && m_mapWidget) {
+        // 标签层铺满地图，按钮和任务列表随后 raise() 到它上面
+        m_labelLayer->setGeometry(m_mapWidget->rect());
+    }
+
     if (m_buttonContainer && m_mapWidget) {
         int containerWidth = 100;
         int containerHeight = 320;
@@ -563,9 +624,10 @@ void TaskUI::onMapClicked(const QMapLibre::Coordinate &coord) {
     qDebug() << QString("地图被点击: (%1, %2)").arg(coord.first).arg(coord.second);
 
     if (m_currentMode == MODE_NORMAL) {
-        double threshold = getZoomDependentThreshold(100.0);
-        const RegionInfo* element = m_taskManager->findVisibleElementNear(coord, threshold);
-        if (element) {
+        // 在屏幕像素空间做命中测试，拾取容差不随缩放级别变化
+        QPointF pixel = m_mapWidget->map()->pixelForCoordinate(coord);
+        RegionInfo element;
+        if (m_taskManager->findVisibleElementAt(pixel, element)) {
             QPoint screenPos = QCursor::pos();
             m_detailWidget->showRegion(element, screenPos);
             qDebug() << "点击到可见任务的元素，显示详情";
@@ -614,7 +676,7 @@ void TaskUI::onMapMouseMoved(const QMapLibre::Coordinate &coord) {
         }
     }
     else if (m_currentMode == MODE_NOFLY && m_noFlyZoneCenterSet) {
-        double radius = calculateDistance(m_noFlyZoneCenter.first, m_noFlyZoneCenter.second,
+        double radius = Geodesy::distance(m_noFlyZoneCenter.first, m_noFlyZoneCenter.second,
                                           coord.first, coord.second);
 
         m_painter->drawPreviewNoFlyZone(m_noFlyZoneCenter.first, m_noFlyZoneCenter.second, radius);
@@ -645,8 +707,8 @@ void TaskUI::onMapMouseMoved(const QMapLibre::Coordinate &coord) {
                 // 使用新的蓝色填充矩形预览方法
                 m_painter->drawPreviewRectangle(rectPoints);
 
-                double width = calculateDistance(lat1, lon1, lat1, lon2);
-                double height = calculateDistance(lat1, lon1, lat2, lon1);
+                double width = Geodesy::distance(lat1, lon1, lat1, lon2);
+                double height = Geodesy::distance(lat1, lon1, lat2, lon1);
                 m_mapWidget->setStatusText(
                     QString("矩形预览 - 宽: %1m, 高: %2m (点击确定/右键取消)")
                         .arg(width, 0, 'f', 1).arg(height, 0, 'f', 1),
@@ -658,7 +720,7 @@ void TaskUI::onMapMouseMoved(const QMapLibre::Coordinate &coord) {
         case DRAW_MODE_CIRCLE:
             if (m_circleCenterSet) {
                 // 圆形模式：显示动态圆形预览
-                double radius = calculateDistance(
+                double radius = Geodesy::distance(
                     m_circleCenter.first, m_circleCenter.second,
                     coord.first, coord.second
                 );
@@ -681,6 +743,25 @@ void TaskUI::onMapMouseMoved(const QMapLibre::Coordinate &coord) {
             if (!m_taskRegionPoints.isEmpty()) {
                 m_painter->updateDynamicLine(m_taskRegionPoints.last(), coord);
             }
+
+            // 实时检查新边是否与已有边相交（扫描线 O(n log n)），状态变化时才更新提示
+            if (m_taskRegionPoints.size() >= 2) {
+                QMapLibre::Coordinates path = m_taskRegionPoints;
+                path.append(coord);
+                bool simple = PolygonValidator::isSimplePolyline(path);
+                if (simple != m_polygonPathSimple) {
+                    m_polygonPathSimple = simple;
+                    if (simple) {
+                        m_mapWidget->setStatusText(
+                            QString("绘制任务区域 - 已添加 %1 个顶点（点击起点闭合，右键回退，ESC取消）")
+                                .arg(m_taskRegionPoints.size()),
+                            "rgba(255, 243, 205, 220)"
+                        );
+                    } else {
+                        m_mapWidget->setStatusText("警告：新的边与已有的边相交，多边形将自相交", "rgba(248, 215, 218, 220)");
+                    }
+                }
+            }
             break;
         }
     }
@@ -822,7 +903,7 @@ void TaskUI::clearAll() {
             qDebug() << QString("已清除任务 #%1 的所有标注").arg(m_taskManager->currentTaskId());
         } else {
             // 清除所有独立区域（引用计数为0的区域）
-            const QMap<int, Region*>& allRegions = m_regionManager->getAllRegions();
+            const RegionArena &allRegions = m_regionManager->getAllRegions();
             QVector<int> independentRegionIds;
 
             for (Region *region : allRegions) {
@@ -831,6 +912,7 @@ void TaskUI::clearAll() {
                 }
             }
 
+            RegionManager::ChangeScope changeScope(m_regionManager);
             for (int regionId : independentRegionIds) {
                 m_regionManager->removeRegion(regionId);
             }
@@ -880,7 +962,7 @@ void TaskUI::handleNoFlyZoneClick(double lat, double lon) {
                                    .arg(lat, 0, 'f', 5).arg(lon, 0, 'f', 5),
                                    "rgba(255, 243, 205, 220)");
     } else {
-        double radius = calculateDistance(m_noFlyZoneCenter.first, m_noFlyZoneCenter.second, lat, lon);
+        double radius = Geodesy::distance(m_noFlyZoneCenter.first, m_noFlyZoneCenter.second, lat, lon);
 
         QVector<Region*> conflictUAVs = m_taskManager->checkNoFlyZoneConflictWithUAVs(
             m_noFlyZoneCenter.first, m_noFlyZoneCenter.second, radius);
@@ -992,7 +1074,7 @@ void TaskUI::handleTaskRegionClick(double lat, double lon) {
             );
         } else {
             // 第二次点击：设置半径并完成圆形
-            m_circleRadius = calculateDistance(
+            m_circleRadius = Geodesy::distance(
                 m_circleCenter.first, m_circleCenter.second,
                 clickedPoint.first, clickedPoint.second
             );
@@ -1000,23 +1082,12 @@ void TaskUI::handleTaskRegionClick(double lat, double lon) {
             // 用多边形近似圆形（32个顶点）
             int segments = 32;
             m_taskRegionPoints.clear();
-            const double EARTH_RADIUS = 6378137.0;
 
             for (int i = 0; i < segments; ++i) {
                 double angle = 2.0 * M_PI * i / segments;
                 double dx = m_circleRadius * std::cos(angle);
                 double dy = m_circleRadius * std::sin(angle);
-
-                double lat_rad = m_circleCenter.first * M_PI / 180.0;
-                double lon_rad = m_circleCenter.second * M_PI / 180.0;
-
-                double new_lat = lat_rad + (dy / EARTH_RADIUS);
-                double new_lon = lon_rad + (dx / (EARTH_RADIUS * std::cos(lat_rad)));
-
-                m_taskRegionPoints.append(QMapLibre::Coordinate(
-                    new_lat * 180.0 / M_PI,
-                    new_lon * 180.0 / M_PI
-                ));
+                m_taskRegionPoints.append(Geodesy::fromLocal(m_circleCenter, dx, dy));
             }
 
             qDebug() << QString("圆形半径点: (%1, %2)，半径 %3m，圆形绘制完成")
@@ -1029,19 +1100,16 @@ void TaskUI::handleTaskRegionClick(double lat, double lon) {
     default:
         // 手绘多边形模式：多次点击
         if (m_taskRegionPoints.size() >= 3) {
-            double distanceToStart = calculateDistance(
-                clickedPoint.first, clickedPoint.second,
-                m_taskRegionPoints.first().first, m_taskRegionPoints.first().second
-            );
-
-            double threshold = getZoomDependentThreshold(50.0);
+            // 按屏幕像素距离判断是否点中起点，任何缩放级别下手感一致
+            QPointF clickPixel = m_mapWidget->map()->pixelForCoordinate(clickedPoint);
+            QPointF startPixel = m_mapWidget->map()->pixelForCoordinate(m_taskRegionPoints.first());
+            double distanceToStart = std::hypot(clickPixel.x() - startPixel.x(), clickPixel.y() - startPixel.y());
 
-            qDebug() << QString("多边形闭合检测: 距离起点 %1 米, 阈值 %2 米 (缩放级别 %3)")
+            qDebug() << QString("多边形闭合检测: 距离起点 %1 像素, 阈值 %2 像素")
                         .arg(distanceToStart, 0, 'f', 2)
-                        .arg(threshold, 0, 'f', 2)
-                        .arg(m_mapWidget->map()->zoom(), 0, 'f', 2);
+                        .arg(CLOSE_POLYGON_TOLERANCE_PX, 0, 'f', 2);
 
-            if (distanceToStart < threshold) {
+            if (distanceToStart < CLOSE_POLYGON_TOLERANCE_PX) {
                 qDebug() << "点击起点，闭合多边形";
                 finishTaskRegion();
                 return;
@@ -1140,6 +1208,51 @@ void TaskUI::finishTaskRegion() {
         return;
     }
 
+    // 手绘多边形自相交时提供自动修复（在交点处拆分为多个区域）
+    QVector<QMapLibre::Coordinates> polygonParts;
+    bool isPolygon = !(m_taskRegionDrawMode == DRAW_MODE_CIRCLE && m_circleRadius > 0)
+                     && !(m_taskRegionDrawMode == DRAW_MODE_RECTANGLE && m_taskRegionPoints.size() == 4);
+    PolygonValidator::Intersection intersection;
+    int unrepaired = 0;
+    if (isPolygon && !PolygonValidator::isSimple(m_taskRegionPoints, &intersection)) {
+        polygonParts = PolygonValidator::repair(m_taskRegionPoints, &unrepaired);
+        qDebug() << QString("多边形自相交：第 %1 条边与第 %2 条边相交于 (%3, %4)，可修复为 %5 个区域，%6 个部分无法修复")
+                    .arg(intersection.edgeA).arg(intersection.edgeB)
+                    .arg(intersection.point.first, 0, 'f', 6).arg(intersection.point.second, 0, 'f', 6)
+                    .arg(polygonParts.size()).arg(unrepaired);
+
+        QMessageBox msgBox(this);
+        msgBox.setWindowTitle("多边形自相交");
+        msgBox.setIcon(QMessageBox::Warning);
+        msgBox.setText("绘制的多边形存在自相交，无法计算面积和范围。");
+        QPushButton *repairButton = nullptr;
+        if (!polygonParts.isEmpty()) {
+            QString info = QString("可以在交点处自动拆分为 %1 个独立的任务区域，或返回继续编辑（右键回退顶点）。")
+                               .arg(polygonParts.size());
+            if (unrepaired > 0) {
+                info += QString("\n注意：有 %1 个部分无法自动修复，修复后将被丢弃。").arg(unrepaired);
+            }
+            msgBox.setInformativeText(info);
+            repairButton = msgBox.addButton("自动修复", QMessageBox::AcceptRole);
+        } else {
+            msgBox.setInformativeText("无法自动修复，请返回继续编辑（右键回退顶点）。");
+        }
+        QPushButton *editButton = msgBox.addButton("继续编辑", QMessageBox::RejectRole);
+        QPushButton *discardButton = msgBox.addButton("放弃", QMessageBox::DestructiveRole);
+        msgBox.setDefaultButton(repairButton ? repairButton : editButton);
+        msgBox.exec();
+
+        if (msgBox.clickedButton() == discardButton) {
+            m_painter->clearTaskRegionPreview();
+            m_taskRegionPoints.clear();
+            returnToNormalMode();
+            return;
+        }
+        if (!repairButton || msgBox.clickedButton() != repairButton) {
+            return;  // 保留已绘制的顶点，继续编辑
+        }
+    }
+
     // 生成默认名称
     int nextId = m_regionManager->getAllRegions().size() + 1;
     QString defaultName = QString("任务区域%1").arg(nextId);
@@ -1164,6 +1277,28 @@ void TaskUI::finishTaskRegion() {
             region = m_regionManager->createRectangularTaskRegion(m_taskRegionPoints, regionName);
             qDebug() << QString("矩形任务区域绘制完成，地形 %1")
                         .arg(featureDialog.getTerrainName());
+        } else if (!polygonParts.isEmpty()) {
+            // 修复后的多边形：每个部分单独成为任务区域，整体作为一次编辑（一次撤销）
+            TaskManager::ChangeScope scope(m_taskManager);
+            int created = 0;
+            for (int i = 0; i < polygonParts.size(); ++i) {
+                QString partName = polygonParts.size() > 1 ? QString("%1-%2").arg(regionName).arg(i + 1) : regionName;
+                Region *part = m_regionManager->createTaskRegion(polygonParts[i], partName);
+                if (part) {
+                    addDrawnRegion(part->id(), static_cast<Region::TerrainType>(terrainType));
+                    ++created;
+                }
+            }
+            qDebug() << QString("自相交多边形已修复为 %1 个任务区域，地形 %2")
+                        .arg(created).arg(featureDialog.getTerrainName());
+
+            // 创建失败或无法修复的部分不能悄悄丢掉，告知用户
+            int dropped = polygonParts.size() - created + unrepaired;
+            if (dropped > 0) {
+                QMessageBox::warning(this, "部分区域未创建",
+                                     QString("已创建 %1 个任务区域，另有 %2 个部分无法修复或创建失败，已丢弃。\n"
+                                             "如需保留，请重新绘制这部分区域。").arg(created).arg(dropped));
+            }
         } else {
             // 多边形任务区域（手绘）
             region = m_regionManager->createTaskRegion(m_taskRegionPoints, regionName);
@@ -1172,13 +1307,7 @@ void TaskUI::finishTaskRegion() {
         }
 
         if (region) {
-            int regionId = region->id();
-            m_regionManager->updateRegionTerrainType(regionId, static_cast<Region::TerrainType>(terrainType));
-
-            // 如果有当前任务，关联到任务
-            if (m_taskManager->currentTask()) {
-                m_taskManager->addRegionToTask(m_taskManager->currentTaskId(), regionId);
-            }
+            addDrawnRegion(region->id(), static_cast<Region::TerrainType>(terrainType));
         }
     }
 
@@ -1188,6 +1317,15 @@ void TaskUI::finishTaskRegion() {
     returnToNormalMode();
 }
 
+void TaskUI::addDrawnRegion(int regionId, Region::TerrainType terrainType) {
+    m_regionManager->updateRegionTerrainType(regionId, terrainType);
+
+    // 如果有当前任务，关联到任务
+    if (m_taskManager->currentTask()) {
+        m_taskManager->addRegionToTask(m_taskManager->currentTaskId(), regionId);
+    }
+}
+
 void TaskUI::returnToNormalMode() {
     m_currentMode = MODE_NORMAL;
     m_mapWidget->setClickEnabled(true);
@@ -1212,6 +1350,7 @@ void TaskUI::resetTaskRegionDrawing() {
     m_rectangleFirstPoint = QMapLibre::Coordinate(0, 0);
     m_circleCenterSet = false;
     m_circleCenter = QMapLibre::Coordinate(0, 0);
+    m_polygonPathSimple = true;
     if (m_painter) {
         m_painter->clearTaskRegionPreview();
         m_painter->clearDynamicLine();
@@ -1219,31 +1358,6 @@ void TaskUI::resetTaskRegionDrawing() {
     }
 }
 
-double TaskUI::calculateDistance(double lat1, double lon1, double lat2, double lon2) {
-    const double EARTH_RADIUS = 6378137.0;
-
-    double dLat = (lat2 - lat1) * M_PI / 180.0;
-    double dLon = (lon2 - lon1) * M_PI / 180.0;
-
-    double a = qSin(dLat / 2) * qSin(dLat / 2) +
-               qCos(lat1 * M_PI / 180.0) * qCos(lat2 * M_PI / 180.0) *
-               qSin(dLon / 2) * qSin(dLon / 2);
-
-    double c = 2 * qAtan2(qSqrt(a), qSqrt(1 - a));
-    return EARTH_RADIUS * c;
-}
-
-double TaskUI::getZoomDependentThreshold(double baseThreshold) {
-    if (!m_mapWidget || !m_mapWidget->map()) {
-        return baseThreshold;
-    }
-
-    double zoom = m_mapWidget->map()->zoom();
-    double threshold = baseThreshold * pow(2.0, 12.0 - zoom);
-
-    return threshold;
-}
-
 QString TaskUI::getColorName(const QString &colorValue) {
     static QMap<QString, QString> colorNames = {
         {"black", "黑色"},
@@ -12,6 +12,7 @@
 #include "TaskManager.h"
 #include "TaskLeftControlWidget.h"
 #include "map_region/RegionPropertyDialog.h"
+#include "map_region/MapLabelLayer.h"
 #include <QMapLibre/Map>
 #include <QMapLibre/Settings>
 
@@ -87,6 +88,7 @@ private slots:
     void handleTaskRegionClick(double lat, double lon);
     void handleTaskRegionUndo();
     void finishTaskRegion();
+    void addDrawnRegion(int regionId, Region::TerrainType terrainType);
 
     void returnToNormalMode();
     void resetNoFlyZoneDrawing();
@@ -94,8 +96,6 @@ private slots:
 
 private:
     void setupUI();
-    double calculateDistance(double lat1, double lon1, double lat2, double lon2);
-    double getZoomDependentThreshold(double baseThreshold = 50.0);
     QString getColorName(const QString &colorValue);
 
     enum InteractionMode {
@@ -119,6 +119,7 @@ private:
     TaskManager *m_taskManager = nullptr;
     TaskLeftControlWidget *m_taskListWidget = nullptr;
     RegionDetailWidget *m_detailWidget = nullptr;
+    MapLabelLayer *m_labelLayer = nullptr;
     QWidget *m_buttonContainer = nullptr;
     class CreateTaskPlanDialog *m_taskPlanDialog = nullptr;
 
@@ -137,6 +138,8 @@ private:
     QMapLibre::Coordinate m_circleCenter;             // 圆形模式：圆心
     bool m_circleCenterSet = false;
     double m_circleRadius = 0.0;                      // 圆形模式：半径（米）
+    bool m_polygonPathSimple = true;                  // 多边形模式：当前折线（含鼠标位置）是否不自相交
+    static constexpr double CLOSE_POLYGON_TOLERANCE_PX = 12.0; // 点中起点闭合多边形的容差（像素）
 
     // 无人机模式状态
     bool m_isInNoFlyZone = false;
@@ -0,0 +1,244 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "ConflictEngine.h"
+#include "RegionGeometry.h"
+#include "Geodesy.h"
+#include "PolygonGeometry.h"
+#include "SpatialIndex.h"
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief 禁飞区（建立索引后只读）
+ */
+struct Zone {
+    int regionId;
+    QMapLibre::Coordinate center;
+    double radius;
+};
+
+/**
+ * @brief 待检查的区域
+ */
+struct Subject {
+    int regionId;
+    const RegionSpec *spec;   // 指向快照内部，快照存活期间有效
+};
+
+/**
+ * @brief 一个并行分块：[begin, end) 范围内的区域及其结果
+ */
+struct Chunk {
+    int begin;
+    int end;
+    QVector<RegionConflict> conflicts;
+};
+
+/**
+ * @brief 每个分块复用的临时数组（避免逐个区域分配）
+ */
+struct Workspace {
+    QVector<int> candidates;        // 包围盒相交的候选禁飞区（zones 中的下标）
+    QVector<double> centerDistances;
+};
+
+/**
+ * @brief 点或圆形任务区域到禁飞区圆心的最近距离（米，圆心在区域内时为 0）
+ * @param centerDistance 区域位置（圆心）到禁飞区圆心的球面距离
+ */
+double pointDistance(const RegionSpec &spec, double centerDistance)
+{
+    if (spec.type == RegionType::TaskRegion && spec.shape == TaskRegionShape::Circle) {
+        return qMax(0.0, centerDistance - spec.radius);
+    }
+    return centerDistance;
+}
+
+/**
+ * @brief 按距离填写冲突，距离不超过禁飞区半径时返回 true
+ */
+bool makeConflict(int regionId, const RegionSpec &spec, const Zone &zone, double distance,
+                  RegionConflict &conflict)
+{
+    if (distance > zone.radius) {
+        return false;
+    }
+    conflict.regionId = regionId;
+    conflict.noFlyZoneId = zone.regionId;
+    conflict.regionType = spec.type;
+    conflict.distance = distance;
+    conflict.penetration = zone.radius - distance;
+    return true;
+}
+
+bool needsPolygon(const RegionSpec &spec)
+{
+    return spec.type == RegionType::TaskRegion && spec.shape != TaskRegionShape::Circle;
+}
+
+/**
+ * @brief 检查单个区域与候选禁飞区的冲突
+ */
+void checkSubject(const Subject &subject, const QVector<Zone> &zones, const GeoPoints &zoneCenters,
+                  const SpatialIndex &zoneIndex, Workspace &work, QVector<RegionConflict> &out)
+{
+    const RegionSpec &spec = *subject.spec;
+    GeoBounds bounds = RegionGeometry::fromSpec(spec).bounds;
+
+    work.candidates.clear();
+    zoneIndex.visit(bounds, [&work](int zoneIndexId, const GeoBounds &) {
+        work.candidates.append(zoneIndexId);
+        return true;
+    });
+    if (work.candidates.isEmpty()) {
+        return;
+    }
+
+    RegionConflict conflict;
+    if (needsPolygon(spec)) {
+        // 多边形投影一次，逐个候选计算圆心到多边形的距离
+        PolygonGeometry polygon(spec.vertices);
+        for (int zoneIndexId : work.candidates) {
+            const Zone &zone = zones[zoneIndexId];
+            if (makeConflict(subject.regionId, spec, zone, polygon.distanceTo(zone.center, zone.radius + 1.0),
+                             conflict)) {
+                out.append(conflict);
+            }
+        }
+        return;
+    }
+
+    // 点和圆形区域：到所有候选圆心的距离一次批量计算
+    const int count = work.candidates.size();
+    work.centerDistances.resize(count);
+    Geodesy::distances(spec.coordinate, zoneCenters, work.candidates.constData(), count,
+                       work.centerDistances.data());
+    for (int i = 0; i < count; ++i) {
+        const Zone &zone = zones[work.candidates[i]];
+        if (makeConflict(subject.regionId, spec, zone, pointDistance(spec, work.centerDistances[i]), conflict)) {
+            out.append(conflict);
+        }
+    }
+}
+
+} // namespace
+
+ConflictReport ConflictEngine::run(const RegionSnapshot &snapshot, bool parallel)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    ConflictReport report;
+    report.snapshotVersion = snapshot.version();
+
+    // 拆分禁飞区和待检查的区域
+    QVector<Zone> zones;
+    GeoPoints zoneCenters;   // 与 zones 一一对应，供批量距离计算
+    QVector<Subject> subjects;
+    for (auto it = snapshot.begin(); it != snapshot.end(); ++it) {
+        const RegionSpec &spec = it.value();
+        if (!isSubject(spec.type)) {
+            zones.append(Zone{it.key(), spec.coordinate, spec.radius});
+            zoneCenters.append(spec.coordinate);
+        } else {
+            subjects.append(Subject{it.key(), &spec});
+        }
+    }
+    report.noFlyZones = zones.size();
+    report.checkedRegions = subjects.size();
+
+    if (zones.isEmpty() || subjects.isEmpty()) {
+        report.elapsedMs = timer.elapsed();
+        return report;
+    }
+
+    // 禁飞区按外接包围盒建立空间索引（条目ID为 zones 中的下标）
+    SpatialIndex zoneIndex;
+    for (int i = 0; i < zones.size(); ++i) {
+        zoneIndex.insert(i, GeoBounds::fromCircle(zones[i].center, zones[i].radius));
+    }
+
+    // 分块检查；索引和快照在检查期间只读，各块只写自己的结果
+    QVector<Chunk> chunks;
+    const bool useThreads = parallel && subjects.size() > PARALLEL_THRESHOLD;
+    const int chunkCount = useThreads ? qMax(1, QThread::idealThreadCount() * 4) : 1;
+    const int chunkSize = (subjects.size() + chunkCount - 1) / chunkCount;
+    for (int begin = 0; begin < subjects.size(); begin += chunkSize) {
+        chunks.append(Chunk{begin, qMin(begin + chunkSize, int(subjects.size())), {}});
+    }
+
+    auto checkChunk = [&subjects, &zones, &zoneCenters, &zoneIndex](Chunk &chunk) {
+        Workspace work;
+        for (int i = chunk.begin; i < chunk.end; ++i) {
+            checkSubject(subjects[i], zones, zoneCenters, zoneIndex, work, chunk.conflicts);
+        }
+    };
+
+    if (useThreads) {
+        QtConcurrent::blockingMap(chunks, checkChunk);
+    } else {
+        for (Chunk &chunk : chunks) {
+            checkChunk(chunk);
+        }
+    }
+
+    for (const Chunk &chunk : chunks) {
+        report.conflicts += chunk.conflicts;
+    }
+    std::sort(report.conflicts.begin(), report.conflicts.end(),
+              [](const RegionConflict &a, const RegionConflict &b) {
+                  return a.regionId != b.regionId ? a.regionId < b.regionId : a.noFlyZoneId < b.noFlyZoneId;
+              });
+
+    report.elapsedMs = timer.elapsed();
+    return report;
+}
+
+bool ConflictEngine::checkPair(int regionId, const RegionSpec &region, int zoneId, const RegionSpec &zone,
+                               RegionConflict &conflict)
+{
+    if (!isSubject(region.type) || zone.type != RegionType::NoFlyZone) {
+        return false;
+    }
+
+    Zone z{zoneId, zone.coordinate, zone.radius};
+    if (needsPolygon(region)) {
+        return makeConflict(regionId, region, z, PolygonGeometry(region.vertices).distanceTo(z.center, z.radius + 1.0),
+                            conflict);
+    }
+
+    // 与 run() 一样经批量接口计算到圆心的距离，两边结果逐位一致
+    GeoPoints center;
+    center.append(zone.coordinate);
+    double centerDistance = 0.0;
+    Geodesy::distances(region.coordinate, center, &centerDistance);
+    return makeConflict(regionId, region, z, pointDistance(region, centerDistance), conflict);
+}
+
+// ==================== ConflictReport ====================
+
+QVector<RegionConflict> ConflictReport::conflictsOf(int regionId) const
+{
+    // conflicts 按 regionId 排序，二分查找该区域的连续区间
+    auto lower = std::lower_bound(conflicts.cbegin(), conflicts.cend(), regionId,
+                                  [](const RegionConflict &c, int id) { return c.regionId < id; });
+    auto upper = std::upper_bound(lower, conflicts.cend(), regionId,
+                                  [](int id, const RegionConflict &c) { return id < c.regionId; });
+    return QVector<RegionConflict>(lower, upper);
+}
+
+QVector<int> ConflictReport::conflictingRegionIds() const
+{
+    QVector<int> regionIds;
+    for (const RegionConflict &conflict : conflicts) {
+        if (regionIds.isEmpty() || regionIds.last() != conflict.regionId) {
+            regionIds.append(conflict.regionId);
+        }
+    }
+    return regionIds;
+}
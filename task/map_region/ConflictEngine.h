@@ -0,0 +1,90 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CONFLICTENGINE_H
+#define CONFLICTENGINE_H
+
+#include "RegionSnapshot.h"
+#include <QVector>
+#include <QMetaType>
+
+/**
+ * @brief 单条冲突：某个区域与某个禁飞区重叠
+ */
+struct RegionConflict {
+    int regionId = 0;          // 冲突区域（无人机 / 盘旋点 / 任务区域）
+    int noFlyZoneId = 0;       // 禁飞区
+    RegionType regionType = RegionType::UAV;
+    double distance = 0.0;     // 区域到禁飞区圆心的最近距离（米，圆心在区域内时为 0）
+    double penetration = 0.0;  // 侵入深度 = 禁飞区半径 - 距离（米，越大越深入禁飞区）
+};
+
+Q_DECLARE_METATYPE(RegionConflict)
+
+/**
+ * @brief 冲突报告 - 一次批量检查的全部结果
+ */
+struct ConflictReport {
+    QVector<RegionConflict> conflicts;  // 按 (regionId, noFlyZoneId) 排序
+    int checkedRegions = 0;             // 参与检查的区域数
+    int noFlyZones = 0;                 // 禁飞区数
+    quint64 snapshotVersion = 0;        // 所用快照的版本号
+    qint64 elapsedMs = 0;               // 耗时（毫秒）
+
+    bool isEmpty() const { return conflicts.isEmpty(); }
+
+    /**
+     * @brief 某个区域的所有冲突
+     */
+    QVector<RegionConflict> conflictsOf(int regionId) const;
+
+    /**
+     * @brief 存在冲突的区域ID（去重、升序）
+     */
+    QVector<int> conflictingRegionIds() const;
+};
+
+/**
+ * @brief 冲突检查引擎 - 把所有无人机、盘旋点、任务区域与所有禁飞区做空间连接
+ *
+ * 禁飞区先按外接包围盒建立空间索引，每个区域只与包围盒相交的禁飞区做精确判断：
+ * - 点（无人机、盘旋点）：到圆心的球面距离不超过半径
+ * - 圆形任务区域：两圆心距离不超过半径之和
+ * - 多边形/矩形任务区域：圆心在多边形内，或圆心到多边形边界的距离不超过半径
+ *
+ * 只读取 RegionSnapshot，不访问 RegionManager，可以在任意线程调用；
+ * 区域较多时分块交给 Qt Concurrent 线程池并行检查。
+ */
+class ConflictEngine {
+public:
+    /**
+     * @brief 检查快照中的所有冲突
+     * @param snapshot 区域快照
+     * @param parallel 是否允许并行（区域很少时总是串行）
+     * @return 冲突报告
+     */
+    static ConflictReport run(const RegionSnapshot &snapshot, bool parallel = true);
+
+    /**
+     * @brief 精确检查一个区域与一个禁飞区（与 run() 的判断规则相同）
+     * @param regionId 区域ID
+     * @param region 区域参数（无人机 / 盘旋点 / 任务区域）
+     * @param zoneId 禁飞区ID
+     * @param zone 禁飞区参数
+     * @param conflict 输出：冲突信息
+     * @return 冲突返回 true；region 不是检查对象或 zone 不是禁飞区时返回 false
+     */
+    static bool checkPair(int regionId, const RegionSpec &region, int zoneId, const RegionSpec &zone,
+                          RegionConflict &conflict);
+
+    /**
+     * @brief 是否为冲突检查对象（无人机、盘旋点、任务区域）
+     */
+    static bool isSubject(RegionType type) { return type != RegionType::NoFlyZone; }
+
+    static constexpr int PARALLEL_THRESHOLD = 256;  // 区域数超过该值才并行
+};
+
+Q_DECLARE_METATYPE(ConflictReport)
+
+#endif // CONFLICTENGINE_H
@@ -0,0 +1,198 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "ConflictMonitor.h"
+#include "RegionManager.h"
+#include <QDebug>
+#include <algorithm>
+
+static bool conflictLess(const RegionConflict &a, const RegionConflict &b)
+{
+    return a.regionId != b.regionId ? a.regionId < b.regionId : a.noFlyZoneId < b.noFlyZoneId;
+}
+
+ConflictMonitor::ConflictMonitor(RegionManager *regionManager, QObject *parent)
+    : QObject(parent)
+    , m_regionMgr(regionManager)
+{
+    if (m_regionMgr) {
+        connect(m_regionMgr, &RegionManager::regionsChanged,
+                this, &ConflictMonitor::onRegionsChanged);
+        reset();
+    }
+}
+
+void ConflictMonitor::reset()
+{
+    bool hadConflicts = !m_conflicts.isEmpty();
+    m_conflicts.clear();
+    m_regionZones.clear();
+    m_zoneRegions.clear();
+
+    if (m_regionMgr) {
+        ConflictReport report = ConflictEngine::run(m_regionMgr->snapshot());
+        for (const RegionConflict &conflict : report.conflicts) {
+            insertConflict(conflict);
+        }
+        qDebug() << QString("冲突监视器: 完整检查 %1 个区域 x %2 个禁飞区，当前 %3 处冲突")
+                    .arg(report.checkedRegions).arg(report.noFlyZones).arg(report.conflicts.size());
+    }
+
+    if (hadConflicts || !m_conflicts.isEmpty()) {
+        emit conflictsChanged();
+    }
+}
+
+// ==================== 查询 ====================
+
+QVector<RegionConflict> ConflictMonitor::conflicts() const
+{
+    QVector<RegionConflict> result;
+    result.reserve(m_conflicts.size());
+    for (const RegionConflict &conflict : m_conflicts) {
+        result.append(conflict);
+    }
+    std::sort(result.begin(), result.end(), conflictLess);
+    return result;
+}
+
+QVector<RegionConflict> ConflictMonitor::conflictsOf(int regionId) const
+{
+    QVector<RegionConflict> result;
+    for (int zoneId : m_regionZones.value(regionId)) {
+        result.append(m_conflicts.value(pairKey(regionId, zoneId)));
+    }
+    for (int subjectId : m_zoneRegions.value(regionId)) {
+        result.append(m_conflicts.value(pairKey(subjectId, regionId)));
+    }
+    std::sort(result.begin(), result.end(), conflictLess);
+    return result;
+}
+
+// ==================== 增量更新 ====================
+
+void ConflictMonitor::onRegionsChanged(const RegionChangeSet &changes)
+{
+    // 显隐变化不影响冲突；其余变化只涉及变化区域参与的配对
+    if (changes.created.isEmpty() && changes.removed.isEmpty() && changes.updated.isEmpty()) {
+        return;
+    }
+
+    QHash<quint64, RegionConflict> dropped;   // 本批丢弃的冲突（重新检查后仍冲突的会移出）
+    QVector<RegionConflict> added;
+
+    for (int regionId : changes.removed) {
+        dropRegion(regionId, dropped);
+    }
+
+    int changed = 0;   // 重新检查后仍冲突、但距离变化的配对
+    QSet<int> touched = changes.created;
+    touched.unite(changes.updated);
+    if (!touched.isEmpty()) {
+        RegionSnapshot snapshot = m_regionMgr->snapshot();
+        for (int regionId : touched) {
+            dropRegion(regionId, dropped);
+        }
+        for (int regionId : touched) {
+            changed += evaluateRegion(regionId, snapshot, dropped, added);
+        }
+    }
+
+    // 只改名称、颜色等属性时冲突原样重新找到，不发出信号
+    if (added.isEmpty() && dropped.isEmpty() && changed == 0) {
+        return;
+    }
+
+    std::sort(added.begin(), added.end(), conflictLess);
+    for (const RegionConflict &conflict : added) {
+        qDebug() << QString("检测到冲突: 区域 #%1 与禁飞区 #%2（侵入 %3 米）")
+                    .arg(conflict.regionId).arg(conflict.noFlyZoneId)
+                    .arg(conflict.penetration, 0, 'f', 1);
+        emit conflictAdded(conflict);
+    }
+    for (const RegionConflict &conflict : dropped) {
+        emit conflictRemoved(conflict.regionId, conflict.noFlyZoneId);
+    }
+    emit conflictsChanged();
+}
+
+void ConflictMonitor::dropRegion(int regionId, QHash<quint64, RegionConflict> &dropped)
+{
+    // 区域ID在各类型之间唯一，两个方向都检查即可，不需要知道区域类型（区域可能已删除）
+    for (int zoneId : m_regionZones.take(regionId)) {
+        quint64 key = pairKey(regionId, zoneId);
+        dropped.insert(key, m_conflicts.take(key));
+        QSet<int> &partners = m_zoneRegions[zoneId];
+        partners.remove(regionId);
+        if (partners.isEmpty()) {
+            m_zoneRegions.remove(zoneId);
+        }
+    }
+    for (int subjectId : m_zoneRegions.take(regionId)) {
+        quint64 key = pairKey(subjectId, regionId);
+        dropped.insert(key, m_conflicts.take(key));
+        QSet<int> &partners = m_regionZones[subjectId];
+        partners.remove(regionId);
+        if (partners.isEmpty()) {
+            m_regionZones.remove(subjectId);
+        }
+    }
+}
+
+int ConflictMonitor::evaluateRegion(int regionId, const RegionSnapshot &snapshot,
+                                    QHash<quint64, RegionConflict> &dropped,
+                                    QVector<RegionConflict> &added)
+{
+    const RegionSpec *spec = snapshot.find(regionId);
+    Region *region = m_regionMgr->getRegion(regionId);
+    if (!spec || !region) {
+        return 0;
+    }
+
+    const bool isZone = !ConflictEngine::isSubject(spec->type);
+    int changed = 0;
+
+    m_regionMgr->visitRegions(region->geometry().bounds, [&](Region *other) {
+        // 禁飞区找检查对象，检查对象找禁飞区
+        if (other->id() == regionId || ConflictEngine::isSubject(other->type()) != isZone) {
+            return true;
+        }
+        const RegionSpec *otherSpec = snapshot.find(other->id());
+        if (!otherSpec) {
+            return true;
+        }
+
+        RegionConflict conflict;
+        bool hit = isZone
+            ? ConflictEngine::checkPair(other->id(), *otherSpec, regionId, *spec, conflict)
+            : ConflictEngine::checkPair(regionId, *spec, other->id(), *otherSpec, conflict);
+        if (!hit) {
+            return true;
+        }
+
+        // 两侧都在本批变化中时同一配对会检查两次，只算一次新增；
+        // 本批丢弃后又重新找到的配对不算新增，距离变化时才算变化
+        quint64 key = pairKey(conflict.regionId, conflict.noFlyZoneId);
+        if (!m_conflicts.contains(key)) {
+            auto previous = dropped.find(key);
+            if (previous == dropped.end()) {
+                added.append(conflict);
+            } else {
+                if (previous->distance != conflict.distance || previous->penetration != conflict.penetration) {
+                    ++changed;
+                }
+                dropped.erase(previous);
+            }
+        }
+        insertConflict(conflict);
+        return true;
+    });
+    return changed;
+}
+
+void ConflictMonitor::insertConflict(const RegionConflict &conflict)
+{
+    m_conflicts.insert(pairKey(conflict.regionId, conflict.noFlyZoneId), conflict);
+    m_regionZones[conflict.regionId].insert(conflict.noFlyZoneId);
+    m_zoneRegions[conflict.noFlyZoneId].insert(conflict.regionId);
+}
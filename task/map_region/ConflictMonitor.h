@@ -0,0 +1,108 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef CONFLICTMONITOR_H
+#define CONFLICTMONITOR_H
+
+#include "ConflictEngine.h"
+#include "RegionChangeSet.h"
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+class RegionManager;
+
+/**
+ * @brief 冲突监视器 - 持续维护当前所有 区域 × 禁飞区 冲突
+ *
+ * 创建时用 ConflictEngine 完整检查一次，之后监听 RegionManager::regionsChanged，
+ * 只重新检查变化区域涉及的配对：
+ * - 删除的区域：丢弃它参与的所有冲突
+ * - 新建/更新的区域：通过区域空间索引找出包围盒相交的另一方（禁飞区找检查对象，
+ *   检查对象找禁飞区），用 ConflictEngine::checkPair 精确判断
+ *
+ * 导入、撤销/重做重建、移动或调整大小等任何经过 RegionManager 的变化都会被重新校验，
+ * 每批变化最多发出一次 conflictsChanged；冲突的增减和距离都没有变化时（如只改名称、颜色）
+ * 不发出。
+ */
+class ConflictMonitor : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @param regionManager 区域管理器（不拥有所有权）
+     */
+    explicit ConflictMonitor(RegionManager *regionManager, QObject *parent = nullptr);
+
+    /**
+     * @brief 当前所有冲突（按 (regionId, noFlyZoneId) 排序）
+     */
+    QVector<RegionConflict> conflicts() const;
+
+    /**
+     * @brief 某个区域（检查对象或禁飞区）参与的所有冲突
+     */
+    QVector<RegionConflict> conflictsOf(int regionId) const;
+
+    /**
+     * @brief 区域（检查对象或禁飞区）是否处于冲突中
+     */
+    bool isInConflict(int regionId) const {
+        return m_regionZones.contains(regionId) || m_zoneRegions.contains(regionId);
+    }
+
+    int count() const { return m_conflicts.size(); }
+    bool isEmpty() const { return m_conflicts.isEmpty(); }
+
+    /**
+     * @brief 丢弃当前结果，按最新区域状态完整重新检查
+     */
+    void reset();
+
+signals:
+    /**
+     * @brief 出现新的冲突
+     */
+    void conflictAdded(const RegionConflict &conflict);
+
+    /**
+     * @brief 冲突解除（区域被删除或不再重叠）
+     */
+    void conflictRemoved(int regionId, int noFlyZoneId);
+
+    /**
+     * @brief 冲突列表或冲突距离变化（每批区域变化最多发出一次）
+     */
+    void conflictsChanged();
+
+private slots:
+    void onRegionsChanged(const RegionChangeSet &changes);
+
+private:
+    static quint64 pairKey(int regionId, int zoneId) {
+        return (quint64(quint32(regionId)) << 32) | quint32(zoneId);
+    }
+
+    /**
+     * @brief 移除区域参与的所有冲突，移除的冲突放入 dropped
+     */
+    void dropRegion(int regionId, QHash<quint64, RegionConflict> &dropped);
+
+    /**
+     * @brief 重新检查区域与空间索引中候选的另一方
+     * @param added 输出：新出现的冲突（dropped 中已有的视为仍然冲突，不算新增）
+     * @return 仍然冲突但距离变化的配对数
+     */
+    int evaluateRegion(int regionId, const RegionSnapshot &snapshot,
+                        QHash<quint64, RegionConflict> &dropped, QVector<RegionConflict> &added);
+
+    void insertConflict(const RegionConflict &conflict);
+
+    RegionManager *m_regionMgr;                     // 区域管理器（不拥有所有权）
+    QHash<quint64, RegionConflict> m_conflicts;     // (regionId, zoneId) -> 冲突
+    QHash<int, QSet<int>> m_regionZones;            // 检查对象 -> 与之冲突的禁飞区
+    QHash<int, QSet<int>> m_zoneRegions;            // 禁飞区 -> 与之冲突的检查对象
+};
+
+#endif // CONFLICTMONITOR_H
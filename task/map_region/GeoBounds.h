@@ -0,0 +1,127 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef GEOBOUNDS_H
+#define GEOBOUNDS_H
+
+#include <QMapLibre/Types>
+#include <QtMath>
+
+/**
+ * @brief 经纬度包围盒（单位：度）
+ *
+ * 用于空间索引的粗筛：min > max 表示空包围盒。
+ * 不处理跨越 ±180° 经线的情况（作业区域不会跨越日期变更线）。
+ */
+struct GeoBounds {
+    double minLat = 0.0;
+    double minLon = 0.0;
+    double maxLat = -1.0;
+    double maxLon = -1.0;
+
+    bool isValid() const {
+        return minLat <= maxLat && minLon <= maxLon;
+    }
+
+    bool intersects(const GeoBounds &other) const {
+        return isValid() && other.isValid() &&
+               minLat <= other.maxLat && other.minLat <= maxLat &&
+               minLon <= other.maxLon && other.minLon <= maxLon;
+    }
+
+    bool contains(const QMapLibre::Coordinate &coord) const {
+        return coord.first >= minLat && coord.first <= maxLat &&
+               coord.second >= minLon && coord.second <= maxLon;
+    }
+
+    bool contains(const GeoBounds &other) const {
+        return isValid() && other.isValid() &&
+               other.minLat >= minLat && other.maxLat <= maxLat &&
+               other.minLon >= minLon && other.maxLon <= maxLon;
+    }
+
+    /**
+     * @brief 扩展包围盒使其包含指定坐标
+     */
+    void extend(const QMapLibre::Coordinate &coord) {
+        if (!isValid()) {
+            minLat = maxLat = coord.first;
+            minLon = maxLon = coord.second;
+            return;
+        }
+        minLat = qMin(minLat, coord.first);
+        maxLat = qMax(maxLat, coord.first);
+        minLon = qMin(minLon, coord.second);
+        maxLon = qMax(maxLon, coord.second);
+    }
+
+    /**
+     * @brief 向四周扩展指定距离（米），按离赤道最远的纬度换算经度，保证不会漏选
+     */
+    GeoBounds expanded(double meters) const {
+        if (!isValid()) {
+            return *this;
+        }
+        double dLat = metersToLatDegrees(meters);
+        double dLon = metersToLonDegrees(meters, qMax(qAbs(minLat), qAbs(maxLat)));
+        GeoBounds result;
+        result.minLat = minLat - dLat;
+        result.maxLat = maxLat + dLat;
+        result.minLon = minLon - dLon;
+        result.maxLon = maxLon + dLon;
+        return result;
+    }
+
+    /**
+     * @brief 每边按自身跨度的比例向外扩展（如 0.5 表示每边各扩展半个宽/高）
+     */
+    GeoBounds grown(double fraction) const {
+        if (!isValid()) {
+            return *this;
+        }
+        double dLat = (maxLat - minLat) * fraction;
+        double dLon = (maxLon - minLon) * fraction;
+        GeoBounds result;
+        result.minLat = minLat - dLat;
+        result.maxLat = maxLat + dLat;
+        result.minLon = minLon - dLon;
+        result.maxLon = maxLon + dLon;
+        return result;
+    }
+
+    static GeoBounds fromPoint(const QMapLibre::Coordinate &coord) {
+        GeoBounds bounds;
+        bounds.extend(coord);
+        return bounds;
+    }
+
+    static GeoBounds fromCoordinates(const QMapLibre::Coordinates &coords) {
+        GeoBounds bounds;
+        for (const auto &coord : coords) {
+            bounds.extend(coord);
+        }
+        return bounds;
+    }
+
+    /**
+     * @brief 圆形（圆心 + 半径米）的外接包围盒
+     */
+    static GeoBounds fromCircle(const QMapLibre::Coordinate &center, double radiusInMeters) {
+        return fromPoint(center).expanded(radiusInMeters);
+    }
+
+    static double metersToLatDegrees(double meters) {
+        // 多留 1% 余量，抵消球面距离与平面换算之间的误差
+        return meters * 1.01 / EARTH_RADIUS * (180.0 / M_PI);
+    }
+
+    static double metersToLonDegrees(double meters, double atLatitude) {
+        // 高纬度处 cos 趋近于 0，限制下限避免包围盒爆炸
+        double cosLat = qMax(qCos(qDegreesToRadians(atLatitude)), 0.01);
+        return metersToLatDegrees(meters) / cosLat;
+    }
+
+    static constexpr double EARTH_RADIUS = 6378137.0;  // 地球半径（米），与距离计算保持一致
+};
+
+#endif // GEOBOUNDS_H
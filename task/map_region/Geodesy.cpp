@@ -0,0 +1,99 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "Geodesy.h"
+
+// 批量内核只在连续数组上做乘加和三角函数：from 的弧度和余弦在循环外算好一次，
+// to 的弧度和余弦由 GeoPoints 预先缓存；循环体内没有分支和跨元素依赖
+
+/**
+ * @brief haversine：两点均已换算弧度并给出纬度余弦
+ */
+static inline double haversine(double lat0, double lon0, double cosLat0,
+                               double lat1, double lon1, double cosLat1)
+{
+    double sinDLat = std::sin((lat1 - lat0) * 0.5);
+    double sinDLon = std::sin((lon1 - lon0) * 0.5);
+    double h = sinDLat * sinDLat + cosLat0 * cosLat1 * sinDLon * sinDLon;
+    return 2.0 * Geodesy::EARTH_RADIUS * std::asin(std::sqrt(h < 1.0 ? h : 1.0));
+}
+
+void Geodesy::distances(const QMapLibre::Coordinate &from, const GeoPoints &to, double *out)
+{
+    const double lat0 = qDegreesToRadians(from.first);
+    const double lon0 = qDegreesToRadians(from.second);
+    const double cosLat0 = std::cos(lat0);
+    const double *lat = to.lat.constData();
+    const double *lon = to.lon.constData();
+    const double *cosLat = to.cosLat.constData();
+    const int count = to.size();
+    for (int i = 0; i < count; ++i) {
+        out[i] = haversine(lat0, lon0, cosLat0, lat[i], lon[i], cosLat[i]);
+    }
+}
+
+QVector<double> Geodesy::distances(const QMapLibre::Coordinate &from, const GeoPoints &to)
+{
+    QVector<double> result(to.size());
+    distances(from, to, result.data());
+    return result;
+}
+
+void Geodesy::distances(const QMapLibre::Coordinate &from, const GeoPoints &to,
+                        const int *indices, int count, double *out)
+{
+    const double lat0 = qDegreesToRadians(from.first);
+    const double lon0 = qDegreesToRadians(from.second);
+    const double cosLat0 = std::cos(lat0);
+    const double *lat = to.lat.constData();
+    const double *lon = to.lon.constData();
+    const double *cosLat = to.cosLat.constData();
+    for (int i = 0; i < count; ++i) {
+        const int k = indices[i];
+        out[i] = haversine(lat0, lon0, cosLat0, lat[k], lon[k], cosLat[k]);
+    }
+}
+
+void Geodesy::fastDistances(const QMapLibre::Coordinate &from, const GeoPoints &to, double *out)
+{
+    // 与 fastDistance 相同：经度差按两点平均纬度的余弦缩放，每点只需一次 cos
+    const double lat0 = qDegreesToRadians(from.first);
+    const double lon0 = qDegreesToRadians(from.second);
+    const double *lat = to.lat.constData();
+    const double *lon = to.lon.constData();
+    const int count = to.size();
+    for (int i = 0; i < count; ++i) {
+        double x = (lon[i] - lon0) * std::cos((lat0 + lat[i]) * 0.5);
+        double y = lat[i] - lat0;
+        out[i] = EARTH_RADIUS * std::sqrt(x * x + y * y);
+    }
+}
+
+QVector<double> Geodesy::fastDistances(const QMapLibre::Coordinate &from, const GeoPoints &to)
+{
+    QVector<double> result(to.size());
+    fastDistances(from, to, result.data());
+    return result;
+}
+
+double Geodesy::pathLength(const GeoPoints &points, bool closed)
+{
+    const int count = points.size();
+    if (count < 2) {
+        return 0.0;
+    }
+
+    // 相邻两点的弧度和余弦直接取缓存，逐段累加
+    const double *lat = points.lat.constData();
+    const double *lon = points.lon.constData();
+    const double *cosLat = points.cosLat.constData();
+    double length = 0.0;
+    for (int i = 0; i + 1 < count; ++i) {
+        length += haversine(lat[i], lon[i], cosLat[i], lat[i + 1], lon[i + 1], cosLat[i + 1]);
+    }
+
+    if (closed) {
+        length += haversine(lat[count - 1], lon[count - 1], cosLat[count - 1], lat[0], lon[0], cosLat[0]);
+    }
+    return length;
+}
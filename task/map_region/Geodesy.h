@@ -0,0 +1,153 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef GEODESY_H
+#define GEODESY_H
+
+#include "GeoBounds.h"
+#include <QVector>
+#include <QtMath>
+#include <cmath>
+
+/**
+ * @brief 一组经纬度点（结构体数组：按分量连续存放）
+ *
+ * 添加时一次性换算弧度并缓存纬度余弦，批量距离计算的内层循环只剩连续数组上的
+ * 乘加和三角函数，不再逐点做角度换算；各分量连续存放，便于编译器向量化。
+ */
+struct GeoPoints {
+    QVector<double> lat;      // 纬度（弧度）
+    QVector<double> lon;      // 经度（弧度）
+    QVector<double> cosLat;   // cos(纬度)
+
+    GeoPoints() = default;
+    explicit GeoPoints(const QMapLibre::Coordinates &coords) {
+        reserve(coords.size());
+        for (const auto &coord : coords) {
+            append(coord);
+        }
+    }
+
+    int size() const { return lat.size(); }
+    bool isEmpty() const { return lat.isEmpty(); }
+
+    void reserve(int count) {
+        lat.reserve(count);
+        lon.reserve(count);
+        cosLat.reserve(count);
+    }
+
+    void append(const QMapLibre::Coordinate &coord) {
+        double latRad = qDegreesToRadians(coord.first);
+        lat.append(latRad);
+        lon.append(qDegreesToRadians(coord.second));
+        cosLat.append(std::cos(latRad));
+    }
+
+    void clear() {
+        lat.clear();
+        lon.clear();
+        cosLat.clear();
+    }
+};
+
+/**
+ * @brief 大地测量计算 - 全项目统一的距离、投影换算
+ *
+ * 地球按半径 GeoBounds::EARTH_RADIUS 的球体处理（与 WGS84 椭球相比距离误差约 0.5%）。
+ *
+ * - distance：haversine 球面距离，任意距离都适用
+ * - fastDistance：等距圆柱（局部 ENU）近似，以两点平均纬度的余弦缩放经度差。
+ *   相对 haversine 的误差（纬度不超过 70°，随距离平方增长）：
+ *   1 km 以内小于 1e-8，10 km 以内小于 1e-6，100 km 以内小于 1e-4，1000 km 以内约 1%；
+ *   只用于短距离的筛选、排序、命中测试，面积/冲突判断等精确结果仍用 distance
+ * - toLocal/fromLocal：以某点为原点的局部东/北平面坐标（米），与 PolygonGeometry 的投影一致
+ *
+ * 批量接口的输入为 GeoPoints（结构体数组），输出写入调用方提供的连续数组，
+ * 结果与逐点调用对应的单点接口相同（只差舍入误差）。
+ */
+class Geodesy {
+public:
+    static constexpr double EARTH_RADIUS = GeoBounds::EARTH_RADIUS;       // 地球半径（米）
+    static constexpr double METERS_PER_DEG_LAT = EARTH_RADIUS * M_PI / 180.0; // 每度纬度对应的米数
+
+    // ==================== 单点 ====================
+
+    /**
+     * @brief 两点之间的球面距离（米，haversine）
+     */
+    static double distance(double lat1, double lon1, double lat2, double lon2) {
+        double sinDLat = std::sin(qDegreesToRadians(lat2 - lat1) * 0.5);
+        double sinDLon = std::sin(qDegreesToRadians(lon2 - lon1) * 0.5);
+        double h = sinDLat * sinDLat +
+                   std::cos(qDegreesToRadians(lat1)) * std::cos(qDegreesToRadians(lat2)) * sinDLon * sinDLon;
+        return 2.0 * EARTH_RADIUS * std::asin(std::sqrt(qMin(h, 1.0)));
+    }
+
+    static double distance(const QMapLibre::Coordinate &from, const QMapLibre::Coordinate &to) {
+        return distance(from.first, from.second, to.first, to.second);
+    }
+
+    /**
+     * @brief 两点之间的近似距离（米，等距圆柱近似，误差见类说明）
+     */
+    static double fastDistance(double lat1, double lon1, double lat2, double lon2) {
+        double x = (lon2 - lon1) * std::cos(qDegreesToRadians((lat1 + lat2) * 0.5));
+        double y = lat2 - lat1;
+        return METERS_PER_DEG_LAT * std::sqrt(x * x + y * y);
+    }
+
+    static double fastDistance(const QMapLibre::Coordinate &from, const QMapLibre::Coordinate &to) {
+        return fastDistance(from.first, from.second, to.first, to.second);
+    }
+
+    /**
+     * @brief 经纬度 -> 以 origin 为原点的局部平面坐标（east 向东，north 向北，单位：米）
+     */
+    static void toLocal(const QMapLibre::Coordinate &origin, const QMapLibre::Coordinate &coord,
+                        double &east, double &north) {
+        east = (coord.second - origin.second) * METERS_PER_DEG_LAT * std::cos(qDegreesToRadians(origin.first));
+        north = (coord.first - origin.first) * METERS_PER_DEG_LAT;
+    }
+
+    /**
+     * @brief 以 origin 为原点的局部平面坐标 -> 经纬度
+     */
+    static QMapLibre::Coordinate fromLocal(const QMapLibre::Coordinate &origin, double east, double north) {
+        return QMapLibre::Coordinate(
+            origin.first + north / METERS_PER_DEG_LAT,
+            origin.second + east / (METERS_PER_DEG_LAT * std::cos(qDegreesToRadians(origin.first))));
+    }
+
+    // ==================== 批量 ====================
+
+    /**
+     * @brief 一点到 N 个点的球面距离
+     * @param out 输出数组（至少 to.size() 个元素）
+     */
+    static void distances(const QMapLibre::Coordinate &from, const GeoPoints &to, double *out);
+    static QVector<double> distances(const QMapLibre::Coordinate &from, const GeoPoints &to);
+
+    /**
+     * @brief 一点到 to 中部分点的球面距离（空间索引筛出的候选，不必先拷贝成新的 GeoPoints）
+     * @param indices 候选点在 to 中的下标
+     * @param out 输出数组（至少 count 个元素，out[i] 对应 to[indices[i]]）
+     */
+    static void distances(const QMapLibre::Coordinate &from, const GeoPoints &to,
+                          const int *indices, int count, double *out);
+
+    /**
+     * @brief 一点到 N 个点的近似距离（与 fastDistance 公式相同，误差见类说明）
+     * @param out 输出数组（至少 to.size() 个元素）
+     */
+    static void fastDistances(const QMapLibre::Coordinate &from, const GeoPoints &to, double *out);
+    static QVector<double> fastDistances(const QMapLibre::Coordinate &from, const GeoPoints &to);
+
+    /**
+     * @brief 折线总长度（米）
+     * @param closed 是否计入末点回到首点的一段
+     */
+    static double pathLength(const GeoPoints &points, bool closed);
+};
+
+#endif // GEODESY_H
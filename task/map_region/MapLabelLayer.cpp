@@ -0,0 +1,240 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "MapLabelLayer.h"
+#include "MapPainter.h"
+#include "RegionManager.h"
+#include <QPainter>
+#include <QFontMetrics>
+#include <QtMath>
+#include <algorithm>
+
+MapLabelLayer::MapLabelLayer(QMapLibre::Map *map, MapPainter *painter, RegionManager *regionManager,
+                             QWidget *parent)
+    : QWidget(parent)
+    , m_map(map)
+    , m_painter(painter)
+    , m_regionManager(regionManager)
+{
+    // 纯显示层：不接收鼠标事件，不遮挡地图交互
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_NoSystemBackground);
+
+    QFont labelFont = font();
+    labelFont.setPixelSize(12);
+    setFont(labelFont);
+
+    connect(m_map, &QMapLibre::Map::mapChanged, this, &MapLabelLayer::onMapChanged);
+    connect(m_painter, &MapPainter::displayedAnnotationsChanged, this, &MapLabelLayer::invalidate);
+    connect(m_regionManager, &RegionManager::regionsChanged, this, &MapLabelLayer::invalidate);
+}
+
+void MapLabelLayer::invalidate()
+{
+    // 多次变化只标记一次，真正的布局推迟到下一次绘制
+    if (!m_dirty) {
+        m_dirty = true;
+        update();
+    }
+}
+
+void MapLabelLayer::onMapChanged(QMapLibre::Map::MapChange change)
+{
+    switch (change) {
+    case QMapLibre::Map::MapChangeRegionIsChanging:
+        followCamera();
+        break;
+    case QMapLibre::Map::MapChangeRegionDidChange:
+    case QMapLibre::Map::MapChangeRegionDidChangeAnimated:
+        invalidate();
+        break;
+    default:
+        break;
+    }
+}
+
+void MapLabelLayer::followCamera()
+{
+    // 布局已失效时下一次绘制会重新布局，不必跟随
+    if (m_dirty || m_labels.isEmpty()) {
+        return;
+    }
+
+    // 缩放、旋转或倾斜后标签之间的相对位置都会变，整体平移不再成立，等相机停下再布局
+    const double epsilon = 1e-6;
+    if (qAbs(m_map->zoom() - m_layoutZoom) > epsilon ||
+        qAbs(m_map->bearing() - m_layoutBearing) > epsilon ||
+        qAbs(m_map->pitch() - m_layoutPitch) > epsilon) {
+        m_labels.clear();
+        update();
+        return;
+    }
+
+    m_offset = m_map->pixelForCoordinate(m_layoutCenter) - QRectF(rect()).center();
+    update();
+}
+
+void MapLabelLayer::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    invalidate();
+}
+
+void MapLabelLayer::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    if (m_dirty) {
+        relayout();
+    }
+    if (m_labels.isEmpty()) {
+        return;
+    }
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.translate(m_offset);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(255, 255, 255, 210));
+    for (const Label &label : m_labels) {
+        painter.drawRoundedRect(label.rect, 3, 3);
+    }
+
+    painter.setPen(QColor(40, 40, 40));
+    for (const Label &label : m_labels) {
+        painter.drawText(label.rect, Qt::AlignCenter, label.text);
+    }
+}
+
+void MapLabelLayer::relayout()
+{
+    m_dirty = false;
+    m_labels.clear();
+    m_offset = QPointF();
+    if (!m_map || !m_painter || !m_regionManager || width() <= 0 || height() <= 0) {
+        return;
+    }
+
+    // 记录布局时的相机状态，平移过程中据此计算偏移
+    m_layoutCenter = m_map->coordinateForPixel(QRectF(rect()).center());
+    m_layoutZoom = m_map->zoom();
+    m_layoutBearing = m_map->bearing();
+    m_layoutPitch = m_map->pitch();
+
+    // 当前视口范围（地图可能旋转，四个角都要反算）
+    GeoBounds view;
+    const QPointF corners[] = {QPointF(0, 0), QPointF(width(), 0), QPointF(0, height()), QPointF(width(), height())};
+    for (const QPointF &corner : corners) {
+        QMapLibre::Coordinate coord = m_map->coordinateForPixel(corner);
+        if (!qIsFinite(coord.first) || !qIsFinite(coord.second)) {
+            return;  // 大倾角时角点落在地平线以上，不显示标签
+        }
+        view.extend(coord);
+    }
+
+    // 收集视口内实际显示的区域（被裁剪、被聚合或隐藏的不显示标签）
+    const QRectF area(0, 0, width(), height());
+    QVector<Candidate> candidates;
+    m_regionManager->visitRegions(view, [&](Region *region) {
+        if (region->name().isEmpty() || !m_painter->isDisplayed(region->annotationId())) {
+            return true;
+        }
+        // 标签放在锚点（点为位置，圆为圆心，多边形保证在内部）
+        QPointF anchor = m_map->pixelForCoordinate(region->geometry().anchor) + anchorOffset(region->type());
+        if (area.contains(anchor)) {
+            candidates.append(Candidate{typePriority(region->type()), region->id(), region->name(), anchor});
+        }
+        return true;
+    });
+
+    // 先按类型优先级，再按区域ID（先创建的优先），保证相机移动时放置结果稳定
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+        return a.priority != b.priority ? a.priority < b.priority : a.regionId < b.regionId;
+    });
+
+    // 贪心放置：与已放置标签重叠则丢弃
+    const int lineHeight = fontMetrics().height();
+    QHash<quint64, QVector<int>> grid;
+    auto cellKey = [](int cx, int cy) { return (quint64(quint32(cx)) << 32) | quint64(quint32(cy)); };
+
+    for (const Candidate &candidate : candidates) {
+        const double w = textWidth(candidate.text) + 2 * LABEL_PADDING;
+        const double h = lineHeight + 2 * LABEL_PADDING;
+        const QRectF rect(candidate.anchor.x() - w / 2, candidate.anchor.y() - h / 2, w, h);
+        const QRectF padded = rect.adjusted(-LABEL_MARGIN, -LABEL_MARGIN, LABEL_MARGIN, LABEL_MARGIN);
+
+        const int x0 = int(std::floor(padded.left() / CELL_SIZE));
+        const int x1 = int(std::floor(padded.right() / CELL_SIZE));
+        const int y0 = int(std::floor(padded.top() / CELL_SIZE));
+        const int y1 = int(std::floor(padded.bottom() / CELL_SIZE));
+
+        bool collides = false;
+        for (int cx = x0; cx <= x1 && !collides; ++cx) {
+            for (int cy = y0; cy <= y1 && !collides; ++cy) {
+                auto cell = grid.constFind(cellKey(cx, cy));
+                if (cell == grid.constEnd()) {
+                    continue;
+                }
+                for (int index : cell.value()) {
+                    if (m_labels[index].rect.intersects(padded)) {
+                        collides = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (collides) {
+            continue;
+        }
+
+        const int index = m_labels.size();
+        m_labels.append(Label{candidate.text, rect});
+        for (int cx = x0; cx <= x1; ++cx) {
+            for (int cy = y0; cy <= y1; ++cy) {
+                grid[cellKey(cx, cy)].append(index);
+            }
+        }
+    }
+}
+
+int MapLabelLayer::typePriority(RegionType type)
+{
+    switch (type) {
+    case RegionType::UAV:
+        return 0;
+    case RegionType::LoiterPoint:
+        return 1;
+    case RegionType::NoFlyZone:
+        return 2;
+    case RegionType::TaskRegion:
+        return 3;
+    }
+    return 4;
+}
+
+QPointF MapLabelLayer::anchorOffset(RegionType type)
+{
+    switch (type) {
+    case RegionType::UAV:
+        return QPointF(0, 26);   // 32x32 图标居中显示，标签放在图标下方
+    case RegionType::LoiterPoint:
+        return QPointF(0, 18);   // 图标在坐标点上方，标签紧贴坐标点下方
+    default:
+        return QPointF(0, 0);    // 区域标签放在中心
+    }
+}
+
+int MapLabelLayer::textWidth(const QString &text)
+{
+    auto it = m_textWidths.constFind(text);
+    if (it != m_textWidths.constEnd()) {
+        return it.value();
+    }
+
+    if (m_textWidths.size() >= MAX_CACHED_WIDTHS) {
+        m_textWidths.clear();
+    }
+    int width = fontMetrics().horizontalAdvance(text);
+    m_textWidths.insert(text, width);
+    return width;
+}
@@ -0,0 +1,113 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef MAPLABELLAYER_H
+#define MAPLABELLAYER_H
+
+#include "MapRegionTypes.h"
+#include <QMapLibre/Map>
+#include <QWidget>
+#include <QHash>
+#include <QVector>
+#include <QRectF>
+
+class MapPainter;
+class RegionManager;
+
+/**
+ * @brief 区域名称标签层 - 覆盖在地图上方的透明控件
+ *
+ * 只为当前实际显示在地图上的区域生成标签，按区域类型优先级依次贪心放置，
+ * 与已放置标签重叠的直接丢弃（碰撞检测使用屏幕空间网格，只检查相邻格子）。
+ * 布局结果缓存下来，只在相机停止移动或区域变化后的下一次绘制时重新计算；
+ * 平移过程中整体平移已有标签，缩放/旋转过程中暂不显示标签。
+ */
+class MapLabelLayer : public QWidget {
+    Q_OBJECT
+
+public:
+    /**
+     * @param map 地图对象（坐标投影、相机变化通知）
+     * @param painter 地图画家（判断区域是否实际显示）
+     * @param regionManager 区域管理器（区域名称、空间查询、变化通知）
+     * @param parent 父控件（地图控件，标签层与其等大）
+     */
+    MapLabelLayer(QMapLibre::Map *map, MapPainter *painter, RegionManager *regionManager,
+                  QWidget *parent = nullptr);
+
+    /**
+     * @brief 当前放置的标签数量
+     */
+    int labelCount() const { return m_labels.size(); }
+
+public slots:
+    /**
+     * @brief 标记布局失效，下次绘制时重新布局
+     */
+    void invalidate();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    void onMapChanged(QMapLibre::Map::MapChange change);
+
+private:
+    struct Label {
+        QString text;
+        QRectF rect;      // 标签背景矩形（像素）
+    };
+
+    struct Candidate {
+        int priority;     // 越小越优先
+        int regionId;
+        QString text;
+        QPointF anchor;   // 标签中心（像素）
+    };
+
+    /**
+     * @brief 重新计算标签布局
+     */
+    void relayout();
+
+    /**
+     * @brief 相机移动过程中跟随地图：纯平移时整体偏移已有标签，缩放/旋转/倾斜时清空标签
+     */
+    void followCamera();
+
+    /**
+     * @brief 类型优先级：UAV > 盘旋点 > 禁飞区 > 任务区域
+     */
+    static int typePriority(RegionType type);
+
+    /**
+     * @brief 标签中心相对于区域坐标点的像素偏移（点状元素放在图标下方）
+     */
+    static QPointF anchorOffset(RegionType type);
+
+    /**
+     * @brief 文字宽度（按文字缓存，避免每次布局都测量）
+     */
+    int textWidth(const QString &text);
+
+    QMapLibre::Map *m_map;
+    MapPainter *m_painter;
+    RegionManager *m_regionManager;
+
+    QVector<Label> m_labels;                 // 已放置的标签
+    QHash<QString, int> m_textWidths;        // 文字宽度缓存
+    bool m_dirty = true;                     // 布局是否需要重新计算
+    QMapLibre::Coordinate m_layoutCenter;    // 布局时控件中心对应的坐标
+    double m_layoutZoom = 0.0;               // 布局时的缩放级别
+    double m_layoutBearing = 0.0;            // 布局时的旋转角
+    double m_layoutPitch = 0.0;              // 布局时的倾角
+    QPointF m_offset;                        // 平移过程中标签相对布局位置的偏移（像素）
+
+    static constexpr double CELL_SIZE = 128.0;      // 碰撞检测网格边长（像素）
+    static constexpr double LABEL_PADDING = 3.0;    // 标签内边距（像素）
+    static constexpr double LABEL_MARGIN = 2.0;     // 标签之间的最小间距（像素）
+    static constexpr int MAX_CACHED_WIDTHS = 4096;  // 文字宽度缓存上限
+};
+
+#endif // MAPLABELLAYER_H
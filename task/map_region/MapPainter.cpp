@@ -2,10 +2,12 @@
 // SPDX-License-Identifier: MIT
 
 #include "MapPainter.h"
+#include "Geodesy.h"
 #include <QImage>
 #include <QPainter>
 #include <QDebug>
 #include <QtMath>
+#include <QTimer>
 
 MapPainter::MapPainter(QMapLibre::Map *map, QObject *parent)
     : QObject(parent)
@@ -15,7 +17,13 @@ MapPainter::MapPainter(QMapLibre::Map *map, QObject *parent)
     , m_previewAnnotationId(0)
     , m_taskRegionPreviewLineId(0)
     , m_dynamicLineId(0)
+    , m_clusteringEnabled(true)
+    , m_clusterRefreshPending(false)
+    , m_clusterZoom(-1)
+    , m_simplifyLevel(PolygonSimplifier::levelForZoom(map->zoom()))
 {
+    // 相机移动结束后更新视口裁剪、点聚合和多边形简化
+    connect(m_map, &QMapLibre::Map::mapChanged, this, &MapPainter::onMapChanged);
 }
 
 bool MapPainter::setLoiterIconPath(const QString &iconPath)
@@ -69,22 +77,11 @@ QMapLibre::AnnotationID MapPainter::drawLoiterPoint(double latitude, double long
         return 0;
     }
 
-    // 创建符号标注
-    QMapLibre::SymbolAnnotation marker;
-    marker.geometry = QMapLibre::Coordinate(latitude, longitude);
-    marker.icon = LOITER_ICON_NAME;
-
-    // 添加到地图
-    QVariant annotation = QVariant::fromValue(marker);
-    QMapLibre::AnnotationID id = m_map->addAnnotation(annotation);
-    m_annotations.append(id);
-
-    // 保存元素信息
-    RegionInfo info;
-    info.type = RegionType::LoiterPoint;
-    info.coordinate = QMapLibre::Coordinate(latitude, longitude);
-    info.annotationId = id;
-    m_regionInfo[id] = info;
+    // 保存元素信息，登记后按视口裁剪状态添加到地图
+    AnnotationRecord record;
+    record.type = RegionType::LoiterPoint;
+    record.coordinate = QMapLibre::Coordinate(latitude, longitude);
+    QMapLibre::AnnotationID id = registerAnnotation(std::move(record));
 
     qDebug() << QString("添加盘旋点: (%1, %2), ID: %3").arg(latitude).arg(longitude).arg(id);
     return id;
@@ -98,23 +95,12 @@ QMapLibre::AnnotationID MapPainter::drawUAV(double latitude, double longitude, c
         return 0;
     }
 
-    // 创建符号标注
-    QMapLibre::SymbolAnnotation marker;
-    marker.geometry = QMapLibre::Coordinate(latitude, longitude);
-    marker.icon = QString("uav-icon-%1").arg(color);
-
-    // 添加到地图
-    QVariant annotation = QVariant::fromValue(marker);
-    QMapLibre::AnnotationID id = m_map->addAnnotation(annotation);
-    m_annotations.append(id);
-
-    // 保存元素信息
-    RegionInfo info;
-    info.type = RegionType::UAV;
-    info.coordinate = QMapLibre::Coordinate(latitude, longitude);
-    info.color = color;
-    info.annotationId = id;
-    m_regionInfo[id] = info;
+    // 保存元素信息，登记后按视口裁剪状态添加到地图
+    AnnotationRecord record;
+    record.type = RegionType::UAV;
+    record.coordinate = QMapLibre::Coordinate(latitude, longitude);
+    record.color = color;
+    QMapLibre::AnnotationID id = registerAnnotation(std::move(record));
 
     qDebug() << QString("添加无人机 (%1): (%2, %3), ID: %4").arg(color).arg(latitude).arg(longitude).arg(id);
     return id;
@@ -122,53 +108,129 @@ QMapLibre::AnnotationID MapPainter::drawUAV(double latitude, double longitude, c
 
 QMapLibre::AnnotationID MapPainter::drawNoFlyZone(double latitude, double longitude, double radiusInMeters)
 {
-    // 生成圆形坐标
-    QMapLibre::Coordinates circleCoords = generateCircleCoordinates(latitude, longitude, radiusInMeters);
-
-    // 创建填充标注（多边形）
-    QMapLibre::FillAnnotation noFlyZone;
-    noFlyZone.geometry.type = QMapLibre::ShapeAnnotationGeometry::PolygonType;
-
-    QMapLibre::CoordinatesCollection polygonCoords;
-    polygonCoords.append(circleCoords);
-    noFlyZone.geometry.geometry.append(polygonCoords);
-
-    // 设置样式：红色半透明
-    noFlyZone.color = QColor(255, 0, 0, 100);        // 红色，透明度 ~40%
-    noFlyZone.outlineColor = QColor(200, 0, 0, 200); // 深红色边框
-    noFlyZone.opacity = 0.6f;
-
-    // 添加区域到地图
-    QVariant annotation = QVariant::fromValue(noFlyZone);
-    QMapLibre::AnnotationID zoneId = m_map->addAnnotation(annotation);
-    m_annotations.append(zoneId);
-
-    // 保存元素信息
-    RegionInfo info;
-    info.type = RegionType::NoFlyZone;
-    info.coordinate = QMapLibre::Coordinate(latitude, longitude);
-    info.radius = radiusInMeters;
-    info.annotationId = zoneId;
-    m_regionInfo[zoneId] = info;
+    // 保存元素信息，登记后按视口裁剪状态添加到地图
+    AnnotationRecord record;
+    record.type = RegionType::NoFlyZone;
+    record.coordinate = QMapLibre::Coordinate(latitude, longitude);
+    record.radius = radiusInMeters;
+    QMapLibre::AnnotationID zoneId = registerAnnotation(std::move(record));
 
     qDebug() << QString("添加禁飞区域: 中心(%1, %2), 半径 %3m, ID: %4")
                     .arg(latitude).arg(longitude).arg(radiusInMeters).arg(zoneId);
     return zoneId;
 }
 
+QVector<QMapLibre::AnnotationID> MapPainter::drawRegions(const QVector<RegionDrawSpec> &specs)
+{
+    QVector<QMapLibre::AnnotationID> ids;
+    ids.reserve(specs.size());
+    m_records.reserve(m_records.size() + specs.size());
+
+    int failed = 0;
+    for (const RegionDrawSpec &spec : specs) {
+        // 校验并准备图标（每种图标只加载一次）
+        bool ok = true;
+        switch (spec.type) {
+        case RegionType::LoiterPoint:
+            ok = loadLoiterIcon();
+            break;
+        case RegionType::UAV:
+            ok = loadUAVIcon(spec.color);
+            break;
+        case RegionType::NoFlyZone:
+            ok = spec.radius > 0;
+            break;
+        case RegionType::TaskRegion:
+            ok = spec.vertices.size() >= 3;
+            break;
+        }
+        if (!ok) {
+            ids.append(0);
+            ++failed;
+            continue;
+        }
+
+        AnnotationRecord record;
+        record.type = spec.type;
+        record.coordinate = spec.coordinate;
+        record.radius = spec.radius;
+        record.color = spec.color;
+        record.shape = spec.shape;
+        record.hidden = !spec.visible;
+        if (spec.type == RegionType::TaskRegion) {
+            record.vertices = spec.vertices;
+            prepareTaskRegion(record);
+        }
+        ids.append(registerAnnotation(std::move(record)));
+    }
+
+    // 批量绘制只输出一条汇总日志
+    qDebug() << QString("批量绘制区域: %1 个, 失败 %2 个").arg(specs.size() - failed).arg(failed);
+    return ids;
+}
+
 void MapPainter::removeAnnotation(QMapLibre::AnnotationID id)
 {
-    qDebug() << "MapPainter::removeAnnotation 开始删除标注 ID:" << id;
-    qDebug() << "  - 删除前 m_annotations 数量:" << m_annotations.size();
-    qDebug() << "  - 删除前 m_regionInfo 数量:" << m_regionInfo.size();
+    const AnnotationRecord *record = m_records.get(id);
+    if (!record) {
+        qWarning() << "MapPainter::removeAnnotation: 标注不存在, ID:" << id;
+        return;
+    }
+
+    if (record->mapId != 0) {
+        m_map->removeAnnotation(record->mapId);
+    }
+    m_records.remove(id);  // 与末尾记录交换后删除，O(1)
+    m_spatialIndex.remove(int(id));
+    m_unculled.remove(id);
+    invalidateHitIndex();
+    if (m_clusterIndex.remove(id)) {
+        scheduleClusterRefresh();
+    }
+
+    qDebug() << "MapPainter::removeAnnotation 删除标注 ID:" << id << "剩余标注数量:" << m_records.size();
+}
+
+void MapPainter::setAnnotationsVisible(const QVector<QMapLibre::AnnotationID> &ids, bool visible)
+{
+    int changed = 0;
+    bool pointsChanged = false;
+    for (QMapLibre::AnnotationID id : ids) {
+        AnnotationRecord *record = m_records.get(id);
+        if (!record || record->hidden == !visible) {
+            continue;
+        }
+
+        // 只切换标记：记录、投影几何和简化顶点都保留，重新显示时直接用缓存的几何添加到地图
+        record->hidden = !visible;
+        if (isPointType(record->type)) {
+            // 隐藏的点不参与聚合计数
+            if (visible) {
+                m_clusterIndex.insert(id, record->coordinate);
+            } else {
+                m_clusterIndex.remove(id);
+            }
+            pointsChanged = true;
+        }
+        syncMaterialized(*record);
+        ++changed;
+    }
 
-    m_map->removeAnnotation(id);
-    m_annotations.removeAll(id);
-    m_regionInfo.remove(id);  // 清理元素信息
+    if (changed == 0) {
+        return;
+    }
+    invalidateHitIndex();
+    if (pointsChanged) {
+        scheduleClusterRefresh();
+    }
+    emit displayedAnnotationsChanged();
+    qDebug() << QString("%1 %2 个标注").arg(visible ? "显示" : "隐藏").arg(changed);
+}
 
-    qDebug() << "  - 删除后 m_annotations 数量:" << m_annotations.size();
-    qDebug() << "  - 删除后 m_regionInfo 数量:" << m_regionInfo.size();
-    qDebug() << "MapPainter::removeAnnotation 完成删除标注 ID:" << id;
+bool MapPainter::isAnnotationVisible(QMapLibre::AnnotationID id) const
+{
+    const AnnotationRecord *record = m_records.get(id);
+    return record && !record->hidden;
 }
 
 void MapPainter::clearAll()
@@ -176,11 +238,17 @@ void MapPainter::clearAll()
     clearPreview();
 
     // 清除所有标注
-    for (auto id : m_annotations) {
-        m_map->removeAnnotation(id);
+    for (const AnnotationRecord &record : m_records) {
+        if (record.mapId != 0) {
+            m_map->removeAnnotation(record.mapId);
+        }
     }
-    m_annotations.clear();
-    m_regionInfo.clear();  // 清理所有元素信息
+    m_records.clear();  // 清理所有元素信息
+    m_spatialIndex.clear();
+    m_unculled.clear();
+    invalidateHitIndex();
+    m_clusterIndex.clear();
+    clearClusterAnnotations();
 
     qDebug() << "清除所有画家标注";
 }
@@ -257,6 +325,181 @@ void MapPainter::clearPreview()
     }
 }
 
+QVariant MapPainter::buildAnnotation(const AnnotationRecord &record)
+{
+    switch (record.type) {
+    case RegionType::LoiterPoint:
+    case RegionType::UAV: {
+        // 创建符号标注
+        QMapLibre::SymbolAnnotation marker;
+        marker.geometry = record.coordinate;
+        marker.icon = record.type == RegionType::UAV
+                          ? QString("uav-icon-%1").arg(record.color)
+                          : QString(LOITER_ICON_NAME);
+        return QVariant::fromValue(marker);
+    }
+
+    case RegionType::NoFlyZone: {
+        // 创建填充标注（圆形多边形）
+        QMapLibre::FillAnnotation noFlyZone;
+        noFlyZone.geometry.type = QMapLibre::ShapeAnnotationGeometry::PolygonType;
+
+        QMapLibre::CoordinatesCollection polygonCoords;
+        polygonCoords.append(generateCircleCoordinates(record.coordinate.first,
+                                                       record.coordinate.second,
+                                                       record.radius));
+        noFlyZone.geometry.geometry.append(polygonCoords);
+
+        // 设置样式：红色半透明
+        noFlyZone.color = QColor(255, 0, 0, 100);        // 红色，透明度 ~40%
+        noFlyZone.outlineColor = QColor(200, 0, 0, 200); // 深红色边框
+        noFlyZone.opacity = 0.6f;
+        return QVariant::fromValue(noFlyZone);
+    }
+
+    case RegionType::TaskRegion: {
+        // 创建填充标注（多边形）
+        QMapLibre::FillAnnotation polygon;
+        polygon.geometry.type = QMapLibre::ShapeAnnotationGeometry::PolygonType;
+
+        // 按当前缩放级别选用简化后的顶点，并确保多边形闭合
+        QMapLibre::Coordinates closedCoords = record.lods.value(record.lod, record.vertices);
+        if (closedCoords.first() != closedCoords.last()) {
+            closedCoords.append(closedCoords.first());
+        }
+
+        QMapLibre::CoordinatesCollection polygonCoords;
+        polygonCoords.append(closedCoords);
+        polygon.geometry.geometry.append(polygonCoords);
+
+        // 设置样式：蓝色半透明
+        polygon.color = QColor(0, 120, 255, 100);        // 蓝色，半透明
+        polygon.outlineColor = QColor(0, 80, 200, 200);  // 深蓝色边框
+        polygon.opacity = 0.6f;
+        return QVariant::fromValue(polygon);
+    }
+    }
+
+    return QVariant();
+}
+
+QMapLibre::AnnotationID MapPainter::registerAnnotation(AnnotationRecord &&record)
+{
+    GeoBounds bounds = boundsOf(record);
+    bool clustered = isPointType(record.type) && !record.hidden;
+    QMapLibre::Coordinate coordinate = record.coordinate;
+
+    // 加载范围外的新元素先不添加到地图，等相机移动过来再添加
+    record.bounds = bounds;
+    record.culled = m_loadBounds.isValid() && !m_loadBounds.intersects(bounds);
+
+    QMapLibre::AnnotationID id = m_records.insert(std::move(record));
+    m_spatialIndex.insert(int(id), bounds);
+
+    AnnotationRecord *stored = m_records.get(id);
+    if (!stored->culled) {
+        m_unculled.insert(id);
+    }
+    syncMaterialized(*stored);
+    invalidateHitIndex();
+
+    // 点状元素参与聚合，合并到下一次事件循环统一刷新
+    if (clustered) {
+        m_clusterIndex.insert(id, coordinate);
+        scheduleClusterRefresh();
+    }
+    return id;
+}
+
+void MapPainter::prepareTaskRegion(AnnotationRecord &record) const
+{
+    record.geometry = PolygonGeometry(record.vertices);
+    record.lods = PolygonSimplifier::buildLevels(record.vertices);
+    record.lod = m_simplifyLevel;
+}
+
+void MapPainter::updateSimplification(int level)
+{
+    m_simplifyLevel = level;
+
+    int updated = 0;
+    for (AnnotationRecord &record : m_records) {
+        if (record.type != RegionType::TaskRegion || record.lod == level) {
+            continue;
+        }
+
+        // 两级顶点数相同说明该多边形没有被简化，无需重新上传
+        bool changed = record.lods.value(record.lod).size() != record.lods.value(level).size();
+        record.lod = level;
+        if (changed && record.mapId != 0) {
+            m_map->updateAnnotation(record.mapId, buildAnnotation(record));
+            ++updated;
+        }
+    }
+
+    if (updated > 0) {
+        qDebug() << QString("切换多边形简化级别: %1, 更新 %2 个任务区域").arg(level).arg(updated);
+    }
+}
+
+void MapPainter::materialize(AnnotationRecord &record)
+{
+    if (record.mapId == 0) {
+        record.mapId = m_map->addAnnotation(buildAnnotation(record));
+    }
+}
+
+void MapPainter::dematerialize(AnnotationRecord &record)
+{
+    if (record.mapId != 0) {
+        m_map->removeAnnotation(record.mapId);
+        record.mapId = 0;
+    }
+}
+
+void MapPainter::syncMaterialized(AnnotationRecord &record)
+{
+    if (record.hidden || record.culled || record.clustered) {
+        dematerialize(record);
+    } else {
+        materialize(record);
+    }
+}
+
+GeoBounds MapPainter::boundsOf(const AnnotationRecord &record)
+{
+    switch (record.type) {
+    case RegionType::NoFlyZone:
+        return GeoBounds::fromCircle(record.coordinate, record.radius);
+    case RegionType::TaskRegion:
+        if (record.radius > 0) {
+            return GeoBounds::fromCircle(record.coordinate, record.radius);
+        }
+        return record.geometry.bounds();
+    default:
+        return GeoBounds::fromPoint(record.coordinate);
+    }
+}
+
+RegionInfo MapPainter::regionInfo(QMapLibre::AnnotationID id) const
+{
+    RegionInfo info = RegionInfo();  // 值初始化，未填写的字段为 0
+
+    const AnnotationRecord *record = m_records.get(id);
+    if (!record) {
+        return info;
+    }
+
+    info.type = record->type;
+    info.coordinate = record->coordinate;
+    info.vertices = record->vertices;
+    info.radius = record->radius;
+    info.color = record->color;
+    info.taskRegionShape = record->shape;
+    info.annotationId = id;
+    return info;
+}
+
 QMapLibre::Coordinates MapPainter::generateCircleCoordinates(
     double centerLat,
     double centerLon,
@@ -264,25 +507,37 @@ QMapLibre::Coordinates MapPainter::generateCircleCoordinates(
     int numPoints)
 {
     QMapLibre::Coordinates coords;
+    coords.reserve(numPoints + 1);
 
-    // 地球半径（米）
-    const double EARTH_RADIUS = 6378137.0;
-
-    // 将半径转换为度数（近似）
-    double radiusInDegLat = (radiusInMeters / EARTH_RADIUS) * (180.0 / M_PI);
+    // 将半径转换为度数（局部平面近似）
+    double radiusInDegLat = radiusInMeters / Geodesy::METERS_PER_DEG_LAT;
     double radiusInDegLon = radiusInDegLat / qCos(centerLat * M_PI / 180.0);
 
     // 生成圆周上的点
-    for (int i = 0; i <= numPoints; ++i) {
-        double angle = 2.0 * M_PI * i / numPoints;
-        double lat = centerLat + radiusInDegLat * qSin(angle);
-        double lon = centerLon + radiusInDegLon * qCos(angle);
+    for (const auto &unit : unitCircle(numPoints)) {
+        double lat = centerLat + radiusInDegLat * unit.first;
+        double lon = centerLon + radiusInDegLon * unit.second;
         coords.append(QMapLibre::Coordinate(lat, lon));
     }
 
     return coords;
 }
 
+const QVector<QPair<double, double>> &MapPainter::unitCircle(int numPoints)
+{
+    // 每种点数的单位圆 sin/cos 只计算一次，批量绘制大量禁飞区时复用
+    auto it = m_unitCircles.find(numPoints);
+    if (it == m_unitCircles.end()) {
+        QVector<QPair<double, double>> points(numPoints + 1);
+        for (int i = 0; i <= numPoints; ++i) {
+            double angle = 2.0 * M_PI * i / numPoints;
+            points[i] = qMakePair(qSin(angle), qCos(angle));
+        }
+        it = m_unitCircles.insert(numPoints, points);
+    }
+    return it.value();
+}
+
 QMapLibre::AnnotationID MapPainter::drawTaskRegionArea(const QMapLibre::Coordinates &coordinates,
                                                        const QMapLibre::Coordinate &center,
                                                        double radius,
@@ -293,39 +548,15 @@ QMapLibre::AnnotationID MapPainter::drawTaskRegionArea(const QMapLibre::Coordina
         return 0;
     }
 
-    // 创建填充标注（多边形）
-    QMapLibre::FillAnnotation polygon;
-    polygon.geometry.type = QMapLibre::ShapeAnnotationGeometry::PolygonType;
-
-    // 确保多边形闭合
-    QMapLibre::Coordinates closedCoords = coordinates;
-    if (closedCoords.first() != closedCoords.last()) {
-        closedCoords.append(closedCoords.first());
-    }
-
-    QMapLibre::CoordinatesCollection polygonCoords;
-    polygonCoords.append(closedCoords);
-    polygon.geometry.geometry.append(polygonCoords);
-
-    // 设置样式：蓝色半透明
-    polygon.color = QColor(0, 120, 255, 100);        // 蓝色，半透明
-    polygon.outlineColor = QColor(0, 80, 200, 200);  // 深蓝色边框
-    polygon.opacity = 0.6f;
-
-    // 添加到地图
-    QVariant annotation = QVariant::fromValue(polygon);
-    QMapLibre::AnnotationID id = m_map->addAnnotation(annotation);
-    m_annotations.append(id);
-
-    // 保存元素信息
-    RegionInfo info;
-    info.type = RegionType::TaskRegion;
-    info.vertices = coordinates;
-    info.coordinate = center;  // 保存圆心（圆形区域）或几何中心（多边形）
-    info.radius = radius;      // 保存半径（圆形区域才有）
-    info.taskRegionShape = shape;  // 保存任务区域形状类型
-    info.annotationId = id;
-    m_regionInfo[id] = info;
+    // 保存元素信息，登记后按视口裁剪状态添加到地图
+    AnnotationRecord record;
+    record.type = RegionType::TaskRegion;
+    record.vertices = coordinates;
+    record.coordinate = center;  // 保存圆心（圆形区域）或几何中心（多边形）
+    record.radius = radius;      // 保存半径（圆形区域才有）
+    record.shape = shape;        // 保存任务区域形状类型
+    prepareTaskRegion(record);
+    QMapLibre::AnnotationID id = registerAnnotation(std::move(record));
 
     if (radius > 0) {
         qDebug() << QString("添加圆形任务区域: 圆心(%1, %2), 半径 %3m, 顶点数 %4, ID: %5")
@@ -483,170 +714,443 @@ bool MapPainter::loadUAVIcon(const QString &color)
     return true;
 }
 
-// 计算两点之间的距离（米）
-static double calculateDistance(double lat1, double lon1, double lat2, double lon2)
+QMapLibre::AnnotationID MapPainter::findRegionNear(const QMapLibre::Coordinate &clickCoord, double threshold) const
 {
-    const double EARTH_RADIUS = 6378137.0; // 地球半径（米）
+    QMapLibre::AnnotationID nearestPointElement = 0;   // 最近的点状元素（UAV/盘旋点）
+    QMapLibre::AnnotationID nearestAreaElement = 0;    // 最近的区域元素（多边形/禁飞区）
+    double minPointDistance = threshold;
+    double minAreaDistance = threshold;
+
+    // 通过空间索引只取包围盒落在阈值范围内的候选元素
+    GeoBounds searchBounds = GeoBounds::fromPoint(clickCoord).expanded(threshold);
+    m_spatialIndex.visit(searchBounds, [&](int id, const GeoBounds &) {
+        const AnnotationRecord *record = m_records.get(QMapLibre::AnnotationID(id));
+        if (!record || record->hidden) {
+            return true;
+        }
+
+        double distance = 0.0;
+
+        switch (record->type) {
+        case RegionType::LoiterPoint:
+            // 盘旋点图标：底部中心是真实位置，需要调整检测范围
+            // 图标 32x32 像素，约等于地图上 10-20 米的范围（取决于缩放级别）
+            // 我们使用更宽松的阈值来检测
+        case RegionType::UAV:
+            // 无人机图标：中心对齐（阈值范围内的命中测试，近似距离足够）
+            distance = Geodesy::fastDistance(clickCoord.first, clickCoord.second,
+                                            record->coordinate.first, record->coordinate.second);
+            if (distance < minPointDistance) {
+                minPointDistance = distance;
+                nearestPointElement = QMapLibre::AnnotationID(id);
+            }
+            break;
 
-    double dLat = (lat2 - lat1) * M_PI / 180.0;
-    double dLon = (lon2 - lon1) * M_PI / 180.0;
+        case RegionType::NoFlyZone:
+            // 计算点到圆心的距离
+            distance = Geodesy::distance(clickCoord.first, clickCoord.second,
+                                        record->coordinate.first, record->coordinate.second);
+            // 如果点在圆内，距离设为0，否则计算到圆边界的距离
+            distance = distance <= record->radius ? 0.0 : distance - record->radius;
+            if (distance < minAreaDistance) {
+                minAreaDistance = distance;
+                nearestAreaElement = QMapLibre::AnnotationID(id);
+            }
+            break;
 
-    double a = qSin(dLat / 2) * qSin(dLat / 2) +
-               qCos(lat1 * M_PI / 180.0) * qCos(lat2 * M_PI / 180.0) *
-               qSin(dLon / 2) * qSin(dLon / 2);
+        case RegionType::TaskRegion:
+            // 计算点到多边形边界的精确距离（使用缓存的投影几何）
+            distance = record->geometry.distanceTo(clickCoord, minAreaDistance);
+            if (distance < minAreaDistance) {
+                minAreaDistance = distance;
+                nearestAreaElement = QMapLibre::AnnotationID(id);
+            }
+            break;
+        }
+        return true;
+    });
 
-    double c = 2 * qAtan2(qSqrt(a), qSqrt(1 - a));
-    return EARTH_RADIUS * c;
+    // 优先返回点状元素（如果存在且在阈值内）
+    if (nearestPointElement != 0) {
+        return nearestPointElement;
+    }
+
+    // 否则返回区域元素
+    return nearestAreaElement;
 }
 
-// 使用射线法判断点是否在多边形内部
-static bool isPointInPolygon(const QMapLibre::Coordinate &point, const QMapLibre::Coordinates &vertices)
+QMapLibre::AnnotationID MapPainter::findRegionAtPixel(const QPointF &pixel, double tolerance) const
 {
-    if (vertices.size() < 3) {
-        return false;
+    if (m_hitIndexDirty) {
+        rebuildHitIndex();
     }
+    return m_hitIndex.pick(pixel, tolerance);
+}
 
-    int crossings = 0;
-    for (int i = 0; i < vertices.size(); ++i) {
-        int j = (i + 1) % vertices.size();
+void MapPainter::rebuildHitIndex() const
+{
+    m_hitIndex.clear();
+    m_hitIndexDirty = false;
+
+    // 无倾角时墨卡托平面到屏幕是仿射变换（平移 + 旋转 + 缩放），由三个参考点求出后
+    // 可以直接换算所有顶点；有倾角时退回逐点调用 pixelForCoordinate
+    auto mercatorX = [](double lon) { return lon / 360.0 + 0.5; };
+    auto mercatorY = [](double lat) {
+        double s = qSin(qDegreesToRadians(qBound(-85.0511, lat, 85.0511)));
+        return 0.5 - 0.25 * std::log((1.0 + s) / (1.0 - s)) / M_PI;
+    };
+
+    const QMapLibre::Coordinate center(m_map->latitude(), m_map->longitude());
+    const double offset = 0.01;  // 参考点间距（度）
+    const QMapLibre::Coordinate refs[] = {center,
+                                          QMapLibre::Coordinate(center.first, center.second + offset),
+                                          QMapLibre::Coordinate(center.first + offset, center.second)};
+    double mx[3], my[3], px[3], py[3];
+    for (int i = 0; i < 3; ++i) {
+        QPointF p = m_map->pixelForCoordinate(refs[i]);
+        mx[i] = mercatorX(refs[i].second);
+        my[i] = mercatorY(refs[i].first);
+        px[i] = p.x();
+        py[i] = p.y();
+    }
+    // 解 [px,py] = A * [mx - mx0, my - my0] + [px0, py0]
+    const double ux = mx[1] - mx[0], uy = my[1] - my[0];
+    const double vx = mx[2] - mx[0], vy = my[2] - my[0];
+    const double det = ux * vy - uy * vx;
+    const bool affine = qAbs(m_map->pitch()) < 0.01 && qAbs(det) > 0.0;
+    double a = 0, b = 0, c = 0, d = 0;
+    if (affine) {
+        a = ((px[1] - px[0]) * vy - (px[2] - px[0]) * uy) / det;
+        b = ((px[2] - px[0]) * ux - (px[1] - px[0]) * vx) / det;
+        c = ((py[1] - py[0]) * vy - (py[2] - py[0]) * uy) / det;
+        d = ((py[2] - py[0]) * ux - (py[1] - py[0]) * vx) / det;
+    }
+    auto project = [&](const QMapLibre::Coordinate &coord) {
+        if (!affine) {
+            return m_map->pixelForCoordinate(coord);
+        }
+        double dx = mercatorX(coord.second) - mx[0];
+        double dy = mercatorY(coord.first) - my[0];
+        return QPointF(px[0] + a * dx + b * dy, py[0] + c * dx + d * dy);
+    };
+    // 地面上 1 米对应的像素数（用于禁飞区半径换算），沿经线方向取 100 米测量
+    const double meterDegrees = 100.0 / Geodesy::METERS_PER_DEG_LAT;
+    const QPointF delta = project(QMapLibre::Coordinate(center.first + meterDegrees, center.second)) - project(center);
+    const double pixelsPerMeter = std::sqrt(delta.x() * delta.x() + delta.y() * delta.y()) / 100.0;
+
+    // 只投影地图上实际显示的元素（已隐藏、已裁剪和被聚合的不可点击）
+    for (QMapLibre::AnnotationID id : m_unculled) {
+        const AnnotationRecord *found = m_records.get(id);
+        if (!found || found->hidden || found->clustered) {
+            continue;
+        }
+        const AnnotationRecord &record = *found;
+        switch (record.type) {
+        case RegionType::LoiterPoint:
+            // 盘旋点图标画在 32x48 画布上半部分，可见部分中心在坐标点上方 8 像素
+            m_hitIndex.addPoint(id, project(record.coordinate) - QPointF(0, 8), 16.0);
+            break;
+        case RegionType::UAV:
+            m_hitIndex.addPoint(id, project(record.coordinate), 16.0);
+            break;
+        case RegionType::NoFlyZone:
+            m_hitIndex.addCircle(id, project(record.coordinate), record.radius * pixelsPerMeter);
+            break;
+        case RegionType::TaskRegion: {
+            // 使用当前显示的简化顶点：简化误差不超过 1 像素，与屏幕上看到的一致
+            const QMapLibre::Coordinates &vertices = record.lods.isEmpty() ? record.vertices
+                                                                            : record.lods[record.lod];
+            QVector<QPointF> ring;
+            ring.reserve(vertices.size());
+            for (const QMapLibre::Coordinate &vertex : vertices) {
+                ring.append(project(vertex));
+            }
+            m_hitIndex.addPolygon(id, ring);
+            break;
+        }
+        }
+    }
+}
 
-        double lat1 = vertices[i].first;
-        double lon1 = vertices[i].second;
-        double lat2 = vertices[j].first;
-        double lon2 = vertices[j].second;
+bool MapPainter::isInNoFlyZone(const QMapLibre::Coordinate &coord) const
+{
+    // 只检查包围盒覆盖该点的元素
+    bool inZone = false;
+    m_spatialIndex.visit(GeoBounds::fromPoint(coord), [&](int id, const GeoBounds &) {
+        const AnnotationRecord *record = m_records.get(QMapLibre::AnnotationID(id));
+        if (!record || record->hidden || record->type != RegionType::NoFlyZone) {
+            return true;
+        }
 
-        // 检查射线是否与边相交
-        if (((lat1 <= point.first && point.first < lat2) ||
-             (lat2 <= point.first && point.first < lat1)) &&
-            (point.second < (lon2 - lon1) * (point.first - lat1) / (lat2 - lat1) + lon1)) {
-            crossings++;
+        // 计算点到圆心的距离，小于半径说明在禁飞区内
+        double distance = Geodesy::distance(coord.first, coord.second,
+                                            record->coordinate.first, record->coordinate.second);
+        if (distance <= record->radius) {
+            inZone = true;
+            return false;
         }
-    }
+        return true;
+    });
 
-    return (crossings % 2) == 1;
+    return inZone;
 }
 
-// 计算点到多边形的最小距离（米）
-static double distanceToPolygon(const QMapLibre::Coordinate &point, const QMapLibre::Coordinates &vertices)
+// ==================== 点标注聚合 ====================
+
+void MapPainter::setClusteringEnabled(bool enabled)
 {
-    if (vertices.isEmpty()) {
-        return std::numeric_limits<double>::max();
+    if (m_clusteringEnabled == enabled) {
+        return;
     }
+    m_clusteringEnabled = enabled;
+    refreshClusters();
+}
 
-    // 先检查点是否在多边形内部
-    if (isPointInPolygon(point, vertices)) {
-        return 0.0;  // 在多边形内部，距离为0
-    }
+void MapPainter::onMapChanged(QMapLibre::Map::MapChange change)
+{
+    // 相机移动过程中屏幕坐标随时变化，缓存的投影全部作废
+    invalidateHitIndex();
 
-    // 不在内部，计算到边界的最小距离
-    double minDistance = std::numeric_limits<double>::max();
+    if (change != QMapLibre::Map::MapChangeRegionDidChange &&
+        change != QMapLibre::Map::MapChangeRegionDidChangeAnimated) {
+        return;
+    }
 
-    // 计算点到每条边的距离
-    for (int i = 0; i < vertices.size(); ++i) {
-        int nextIdx = (i + 1) % vertices.size();
-        const auto &v1 = vertices[i];
-        const auto &v2 = vertices[nextIdx];
+    // 先更新裁剪状态，再按缩放级别聚合/简化，避免为即将移除的标注做无用更新
+    updateViewport();
 
-        // 计算点到顶点的距离
-        double dist1 = calculateDistance(point.first, point.second, v1.first, v1.second);
-        double dist2 = calculateDistance(point.first, point.second, v2.first, v2.second);
+    double zoom = m_map->zoom();
 
-        minDistance = qMin(minDistance, qMin(dist1, dist2));
+    // 聚合结果与缩放级别的整数部分有关；地图上只有上次加载范围内的聚合，
+    // 视口移出该范围（或上次视口未知、这次已知）时按新的加载范围重新查询
+    if (m_clusteringEnabled) {
+        const GeoBounds view = cameraBounds();
+        bool moved = m_clusterBounds.isValid() ? !m_clusterBounds.contains(view) : view.isValid();
+        if (int(std::floor(zoom)) != m_clusterZoom || moved) {
+            refreshClusters();
+        }
     }
 
-    return minDistance;
+    // 多边形简化级别只在跨越级别边界时切换
+    int level = PolygonSimplifier::levelForZoom(zoom);
+    if (level != m_simplifyLevel) {
+        updateSimplification(level);
+    }
 }
 
-const RegionInfo* MapPainter::findRegionNear(const QMapLibre::Coordinate &clickCoord, double threshold) const
+void MapPainter::scheduleClusterRefresh()
 {
-    const RegionInfo* nearestPointElement = nullptr;   // 最近的点状元素（UAV/盘旋点）
-    const RegionInfo* nearestAreaElement = nullptr;    // 最近的区域元素（多边形/禁飞区）
-    double minPointDistance = threshold;
-    double minAreaDistance = threshold;
+    if (!m_clusteringEnabled || m_clusterRefreshPending) {
+        return;
+    }
 
-    // 遍历所有元素，分别记录点状和区域元素
-    for (auto it = m_regionInfo.constBegin(); it != m_regionInfo.constEnd(); ++it) {
-        const RegionInfo &info = it.value();
-        double distance = 0.0;
+    m_clusterRefreshPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_clusterRefreshPending = false;
+        refreshClusters();
+    });
+}
 
-        switch (info.type) {
-        case RegionType::LoiterPoint:
-            // 盘旋点图标：底部中心是真实位置，需要调整检测范围
-            // 图标 32x32 像素，约等于地图上 10-20 米的范围（取决于缩放级别）
-            // 我们使用更宽松的阈值来检测
-            distance = calculateDistance(clickCoord.first, clickCoord.second,
-                                        info.coordinate.first, info.coordinate.second);
-            if (distance < minPointDistance) {
-                minPointDistance = distance;
-                nearestPointElement = &info;
+void MapPainter::refreshClusters()
+{
+    clearClusterAnnotations();
+
+    if (!m_clusteringEnabled) {
+        // 关闭聚合：恢复所有点标注（仍受视口裁剪约束）
+        for (AnnotationRecord &record : m_records) {
+            if (isPointType(record.type)) {
+                record.clustered = false;
+                syncMaterialized(record);
             }
-            break;
+        }
+        invalidateHitIndex();
+        emit displayedAnnotationsChanged();
+        m_clusterZoom = -1;
+        m_clusterBounds = GeoBounds();
+        return;
+    }
 
-        case RegionType::UAV:
-            // 无人机图标：中心对齐
-            distance = calculateDistance(clickCoord.first, clickCoord.second,
-                                        info.coordinate.first, info.coordinate.second);
-            if (distance < minPointDistance) {
-                minPointDistance = distance;
-                nearestPointElement = &info;
-            }
-            break;
+    double zoom = m_map->zoom();
+    m_clusterZoom = int(std::floor(zoom));
+    m_clusterBounds = m_loadBounds;
+
+    // 只查询加载范围内的聚合（视口未知时不限范围），地图上的聚合图标数量随视口而不是点总数增长；
+    // 聚合图标直接画在地图上，单点保留原标注
+    QSet<QMapLibre::AnnotationID> standalone;
+    const QVector<PointClusterIndex::Cluster> clusters = m_clusterIndex.clusters(zoom, m_clusterBounds);
+    for (const PointClusterIndex::Cluster &cluster : clusters) {
+        if (cluster.count == 1) {
+            standalone.insert(cluster.id);
+            continue;
+        }
 
-        case RegionType::NoFlyZone:
-            // 计算点到圆心的距离
-            distance = calculateDistance(clickCoord.first, clickCoord.second,
-                                        info.coordinate.first, info.coordinate.second);
-            // 如果点在圆内，距离设为0
-            if (distance <= info.radius) {
-                distance = 0.0;
-            } else {
-                // 计算到圆边界的距离
-                distance = distance - info.radius;
-            }
-            if (distance < minAreaDistance) {
-                minAreaDistance = distance;
-                nearestAreaElement = &info;
-            }
-            break;
+        QString iconName = loadClusterIcon(cluster.count < 1000 ? QString::number(cluster.count)
+                                                                : QString("999+"));
+        if (iconName.isEmpty()) {
+            continue;
+        }
 
-        case RegionType::TaskRegion:
-            // 计算点到多边形的距离
-            distance = distanceToPolygon(clickCoord, info.vertices);
-            if (distance < minAreaDistance) {
-                minAreaDistance = distance;
-                nearestAreaElement = &info;
-            }
-            break;
+        QMapLibre::SymbolAnnotation marker;
+        marker.geometry = cluster.coordinate;
+        marker.icon = iconName;
+        m_clusterAnnotations.append(m_map->addAnnotation(QVariant::fromValue(marker)));
+    }
+
+    // 被聚合的成员和加载范围外的点从地图移除，独立点重新显示（仍受视口裁剪约束）
+    for (int i = 0; i < m_records.size(); ++i) {
+        AnnotationRecord &record = m_records.valueAt(i);
+        if (!isPointType(record.type)) {
+            continue;
         }
+        record.clustered = !standalone.contains(m_records.handleAt(i));
+        syncMaterialized(record);
     }
+    invalidateHitIndex();
+    emit displayedAnnotationsChanged();
 
-    // 优先返回点状元素（如果存在且在阈值内）
-    if (nearestPointElement != nullptr) {
-        return nearestPointElement;
+    qDebug() << QString("点标注聚合: 缩放级别 %1, 聚合 %2 个, 独立点 %3 个")
+                    .arg(m_clusterZoom).arg(m_clusterAnnotations.size()).arg(standalone.size());
+}
+
+void MapPainter::clearClusterAnnotations()
+{
+    for (QMapLibre::AnnotationID id : m_clusterAnnotations) {
+        m_map->removeAnnotation(id);
     }
+    m_clusterAnnotations.clear();
+}
 
-    // 否则返回区域元素
-    return nearestAreaElement;
+QString MapPainter::loadClusterIcon(const QString &label)
+{
+    QString iconName = QString("cluster-icon-%1").arg(label);
+    if (m_loadedClusterIcons.contains(iconName)) {
+        return iconName;
+    }
+
+    // 数量越多颜色越深：蓝 -> 橙 -> 红
+    int count = label.endsWith('+') ? 1000 : label.toInt();
+    QColor fillColor = count < 10 ? QColor(33, 150, 243)
+                     : count < 100 ? QColor(255, 152, 0)
+                                   : QColor(229, 57, 53);
+
+    const int size = 40;
+    QImage icon(size, size, QImage::Format_ARGB32);
+    icon.fill(Qt::transparent);
+
+    QPainter painter(&icon);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(Qt::white, 2));
+    painter.setBrush(fillColor);
+    painter.drawEllipse(2, 2, size - 4, size - 4);
+
+    QFont font = painter.font();
+    font.setBold(true);
+    font.setPixelSize(label.size() > 3 ? 11 : 14);
+    painter.setFont(font);
+    painter.drawText(QRect(0, 0, size, size), Qt::AlignCenter, label);
+    painter.end();
+
+    m_map->addAnnotationIcon(iconName, icon);
+    m_loadedClusterIcons.insert(iconName);
+    return iconName;
 }
 
-bool MapPainter::isInNoFlyZone(const QMapLibre::Coordinate &coord) const
+// ==================== 视口裁剪 ====================
+
+void MapPainter::setViewportSize(const QSize &size)
 {
-    // 遍历所有元素，检查是否在禁飞区内
-    for (auto it = m_regionInfo.constBegin(); it != m_regionInfo.constEnd(); ++it) {
-        const RegionInfo &info = it.value();
+    if (m_viewportSize == size) {
+        return;
+    }
+    m_viewportSize = size;
+    updateViewport();
+    scheduleClusterRefresh();
+}
 
-        // 只检查禁飞区类型
-        if (info.type == RegionType::NoFlyZone) {
-            // 计算点到圆心的距离
-            double distance = calculateDistance(coord.first, coord.second,
-                                                info.coordinate.first, info.coordinate.second);
+int MapPainter::materializedCount() const
+{
+    int count = 0;
+    for (const AnnotationRecord &record : m_records) {
+        if (record.mapId != 0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+GeoBounds MapPainter::cameraBounds() const
+{
+    GeoBounds bounds;
+    if (m_viewportSize.isEmpty()) {
+        return bounds;
+    }
+
+    // 地图可能旋转，四个角都要反算
+    const double w = m_viewportSize.width();
+    const double h = m_viewportSize.height();
+    const QPointF corners[] = {QPointF(0, 0), QPointF(w, 0), QPointF(0, h), QPointF(w, h)};
+    for (const QPointF &corner : corners) {
+        QMapLibre::Coordinate coord = m_map->coordinateForPixel(corner);
+        if (!qIsFinite(coord.first) || !qIsFinite(coord.second)) {
+            return GeoBounds();  // 大倾角时角点可能落在地平线以上，此时不裁剪
+        }
+        bounds.extend(coord);
+    }
+    return bounds;
+}
 
-            // 如果距离小于半径，说明在禁飞区内
-            if (distance <= info.radius) {
-                return true;
+void MapPainter::updateViewport()
+{
+    GeoBounds view = cameraBounds();
+    m_loadBounds = view.grown(LOAD_MARGIN);
+
+    int loaded = 0;
+    int unloaded = 0;
+
+    if (!m_loadBounds.isValid()) {
+        // 视口未知：取消所有裁剪
+        for (int i = 0; i < m_records.size(); ++i) {
+            AnnotationRecord &record = m_records.valueAt(i);
+            if (record.culled) {
+                record.culled = false;
+                m_unculled.insert(m_records.handleAt(i));
+                syncMaterialized(record);
+                ++loaded;
+            }
+        }
+    } else {
+        // 离开保留范围的才移除，只需检查当前未被裁剪的记录
+        const GeoBounds keepBounds = view.grown(KEEP_MARGIN);
+        for (auto it = m_unculled.begin(); it != m_unculled.end();) {
+            AnnotationRecord *record = m_records.get(*it);
+            if (record && record->bounds.intersects(keepBounds)) {
+                ++it;
+                continue;
             }
+            if (record) {
+                record->culled = true;
+                syncMaterialized(*record);
+                ++unloaded;
+            }
+            it = m_unculled.erase(it);
         }
+
+        // 进入加载范围的通过空间索引查出，不必遍历全部记录
+        m_spatialIndex.visit(m_loadBounds, [&](int id, const GeoBounds &) {
+            AnnotationRecord *record = m_records.get(QMapLibre::AnnotationID(id));
+            if (record && record->culled) {
+                record->culled = false;
+                m_unculled.insert(QMapLibre::AnnotationID(id));
+                syncMaterialized(*record);
+                ++loaded;
+            }
+            return true;
+        });
     }
 
-    return false;
+    if (loaded > 0 || unloaded > 0) {
+        emit displayedAnnotationsChanged();
+        qDebug() << QString("视口裁剪: 加载 %1 个, 移除 %2 个, 共 %3 个标注")
+                        .arg(loaded).arg(unloaded).arg(m_records.size());
+    }
 }
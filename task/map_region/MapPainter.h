@@ -5,17 +5,34 @@
 #define MAPPAINTER_H
 
 #include "MapRegionTypes.h"
+#include "RegionRenderer.h"
+#include "SpatialIndex.h"
+#include "PolygonGeometry.h"
+#include "SlotMap.h"
+#include "PointClusterIndex.h"
+#include "PolygonSimplifier.h"
+#include "ScreenHitIndex.h"
 #include <QMapLibre/Map>
 #include <QObject>
 #include <QString>
 #include <QVector>
-#include <QMap>
+#include <QSet>
+#include <QHash>
+#include <QPair>
+#include <QSize>
 
 /**
  * @brief 地图画家类 - 用于在地图上绘制区域标记
  *
+ * draw* 返回的标注 ID 是画家分配的稳定句柄，而不是 MapLibre 内部的标注 ID；
+ * 每个句柄对应槽位表中的一条紧凑记录，记录里保存实际的 MapLibre 标注 ID。
+ *
+ * 记录始终保留（隐藏时也不删除），但只有未被隐藏、落在视口附近且未被聚合的
+ * 记录才会真正添加到地图上。
+ *
+ * 实现 RegionRenderer 接口，供 RegionManager 使用。
  */
-class MapPainter : public QObject {
+class MapPainter : public QObject, public RegionRenderer {
     Q_OBJECT
 
 public:
@@ -33,7 +50,7 @@ public:
      * @param longitude 经度
      * @return 标注 ID，用于后续删除
      */
-    QMapLibre::AnnotationID drawLoiterPoint(double latitude, double longitude);
+    QMapLibre::AnnotationID drawLoiterPoint(double latitude, double longitude) override;
 
     /**
      * @brief 画无人机图标（使用 UAV 图标）
@@ -42,7 +59,7 @@ public:
      * @param color 颜色（black=不染色, red, blue, purple, green, yellow）
      * @return 标注 ID，用于后续删除
      */
-    QMapLibre::AnnotationID drawUAV(double latitude, double longitude, const QString &color = "black");
+    QMapLibre::AnnotationID drawUAV(double latitude, double longitude, const QString &color = "black") override;
 
     /**
      * @brief 画禁飞区域（红色半透明圆形）
@@ -51,7 +68,7 @@ public:
      * @param radiusInMeters 半径（米）
      * @return 区域标注 ID
      */
-    QMapLibre::AnnotationID drawNoFlyZone(double latitude, double longitude, double radiusInMeters);
+    QMapLibre::AnnotationID drawNoFlyZone(double latitude, double longitude, double radiusInMeters) override;
 
     /**
      * @brief 绘制任务区域（蓝色半透明）
@@ -64,21 +81,78 @@ public:
     QMapLibre::AnnotationID drawTaskRegionArea(const QMapLibre::Coordinates &coordinates,
                                                const QMapLibre::Coordinate &center = QMapLibre::Coordinate(),
                                                double radius = 0.0,
-                                               TaskRegionShape shape = TaskRegionShape::Polygon);
+                                               TaskRegionShape shape = TaskRegionShape::Polygon) override;
+
+    /**
+     * @brief 批量绘制区域（导入/整体显示时使用）
+     *
+     * 只是逐个登记的便捷循环：QMapLibre 的标注接口没有批量添加，
+     * 添加到地图的每个区域仍各调用一次 addAnnotation。与逐个调用 draw* 相比
+     * 只省去重复的存储扩容、图标检查和逐条日志。
+     * @param specs 区域绘制参数列表
+     * @return 与 specs 一一对应的标注 ID，绘制失败的位置为 0
+     */
+    QVector<QMapLibre::AnnotationID> drawRegions(const QVector<RegionDrawSpec> &specs) override;
 
     /**
      * @brief 删除指定标注
      * @param id 标注 ID
      */
-    void removeAnnotation(QMapLibre::AnnotationID id);
+    void removeAnnotation(QMapLibre::AnnotationID id) override;
+
+    /**
+     * @brief 批量显示/隐藏标注（只切换记录的隐藏标记，不删除记录、不重新计算几何）
+     *
+     * 隐藏的标注从地图移除，不参与聚合、命中测试和禁飞区检查；重新显示时使用缓存的几何
+     * 添加到地图（仍受视口裁剪和聚合约束）。整批只发出一次 displayedAnnotationsChanged。
+     * @param ids 标注 ID 列表
+     * @param visible 是否显示
+     */
+    void setAnnotationsVisible(const QVector<QMapLibre::AnnotationID> &ids, bool visible) override;
+
+    /**
+     * @brief 标注是否处于显示状态（未被隐藏；是否真正添加到地图见 isDisplayed）
+     */
+    bool isAnnotationVisible(QMapLibre::AnnotationID id) const override;
 
     /**
      * @brief 根据点击位置查找最近的区域
      * @param clickCoord 点击的地理坐标
      * @param threshold 阈值距离（米）
-     * @return 区域信息指针，未找到则返回 nullptr
+     * @return 标注 ID，未找到则返回 0
+     */
+    QMapLibre::AnnotationID findRegionNear(const QMapLibre::Coordinate &clickCoord, double threshold = 100.0) const override;
+
+    /**
+     * @brief 根据屏幕位置查找区域（像素空间命中测试）
+     *
+     * 地图上显示的元素在相机变化后投影到屏幕一次并缓存，之后的查询直接比较像素距离，
+     * 拾取容差不随缩放级别和纬度变化。被聚合的点不参与命中测试。
+     * @param pixel 屏幕位置（地图控件坐标，像素）
+     * @param tolerance 容差（像素）
+     * @return 标注 ID，未找到则返回 0
      */
-    const RegionInfo* findRegionNear(const QMapLibre::Coordinate &clickCoord, double threshold = 100.0) const;
+    QMapLibre::AnnotationID findRegionAtPixel(const QPointF &pixel, double tolerance = HIT_TOLERANCE_PX) const override;
+
+    /**
+     * @brief 获取标注对应的区域信息
+     * @param id 标注 ID
+     * @return 区域信息（标注不存在时 annotationId 为 0）
+     */
+    RegionInfo regionInfo(QMapLibre::AnnotationID id) const override;
+
+    /**
+     * @brief 检查标注是否存在
+     */
+    bool hasAnnotation(QMapLibre::AnnotationID id) const { return m_records.contains(id); }
+
+    /**
+     * @brief 标注当前是否实际显示在地图上（未被隐藏、未被视口裁剪、未被聚合）
+     */
+    bool isDisplayed(QMapLibre::AnnotationID id) const {
+        const AnnotationRecord *record = m_records.get(id);
+        return record && record->mapId != 0;
+    }
 
     // ==================== MapPainter 特有方法 ====================
 
@@ -147,6 +221,43 @@ public:
      */
     bool isInNoFlyZone(const QMapLibre::Coordinate &coord) const;
 
+    // ==================== 点标注聚合 ====================
+
+    /**
+     * @brief 启用/禁用 UAV 和盘旋点的按缩放级别聚合（默认启用）
+     * @param enabled 是否启用
+     */
+    void setClusteringEnabled(bool enabled);
+
+    bool isClusteringEnabled() const { return m_clusteringEnabled; }
+
+    // ==================== 视口裁剪 ====================
+
+    /**
+     * @brief 设置地图视口尺寸（像素），用于计算当前可见范围
+     *
+     * 尺寸为空时不做裁剪，所有标注都添加到地图上。
+     * @param size 地图控件尺寸
+     */
+    void setViewportSize(const QSize &size);
+
+    /**
+     * @brief 当前添加到地图上的区域标注数量（不含预览和聚合图标）
+     */
+    int materializedCount() const;
+
+signals:
+    /**
+     * @brief 聚合或视口裁剪改变了实际显示在地图上的标注集合
+     */
+    void displayedAnnotationsChanged();
+
+private slots:
+    /**
+     * @brief 地图相机变化（更新视口裁剪；缩放级别变化时重新聚合、切换多边形简化级别）
+     */
+    void onMapChanged(QMapLibre::Map::MapChange change);
+
 private:
     /**
      * @brief 加载盘旋点图标
@@ -161,6 +272,123 @@ private:
      */
     bool loadUAVIcon(const QString &color);
 
+    /**
+     * @brief 标注记录（紧凑存储，只保留绘制和命中测试需要的字段）
+     */
+    struct AnnotationRecord {
+        QMapLibre::AnnotationID mapId = 0;           // MapLibre 标注 ID
+        RegionType type = RegionType::LoiterPoint;
+        TaskRegionShape shape = TaskRegionShape::Polygon;
+        QMapLibre::Coordinate coordinate;            // 位置/圆心/中心点
+        double radius = 0.0;                         // 半径（米）
+        QString color;                               // UAV 颜色
+        QMapLibre::Coordinates vertices;             // 任务区域顶点（隐式共享）
+        PolygonGeometry geometry;                    // 任务区域投影几何（精确，用于命中测试）
+        QVector<QMapLibre::Coordinates> lods;        // 任务区域各级简化顶点（仅用于显示）
+        int lod = PolygonSimplifier::LEVEL_COUNT - 1; // 当前显示的简化级别
+        GeoBounds bounds;                            // 包围盒（视口裁剪用）
+        bool culled = false;                         // 在视口范围外，不添加到地图
+        bool clustered = false;                      // 被聚合图标代替，不添加到地图
+        bool hidden = false;                         // 被隐藏（所属任务不可见），不添加到地图
+    };
+
+    /**
+     * @brief 预计算任务区域的投影几何和各级简化顶点
+     */
+    void prepareTaskRegion(AnnotationRecord &record) const;
+
+    /**
+     * @brief 切换所有任务区域的显示简化级别
+     * @param level 简化级别
+     */
+    void updateSimplification(int level);
+
+    /**
+     * @brief 是否为参与聚合的点状元素（UAV/盘旋点）
+     */
+    static bool isPointType(RegionType type) {
+        return type == RegionType::UAV || type == RegionType::LoiterPoint;
+    }
+
+    /**
+     * @brief 把记录添加到地图（已在地图上则跳过）
+     */
+    void materialize(AnnotationRecord &record);
+
+    /**
+     * @brief 把记录从地图移除，但保留记录本身（用于聚合/裁剪）
+     */
+    void dematerialize(AnnotationRecord &record);
+
+    /**
+     * @brief 根据裁剪/聚合状态决定记录是否在地图上
+     */
+    void syncMaterialized(AnnotationRecord &record);
+
+    /**
+     * @brief 计算当前相机可见范围（视口四角反算经纬度）
+     * @return 视口尺寸未知时返回空包围盒
+     */
+    GeoBounds cameraBounds() const;
+
+    /**
+     * @brief 按当前相机范围增量更新裁剪状态
+     *
+     * 进入加载范围（视口外扩 LOAD_MARGIN）的记录添加到地图，离开保留范围（视口外扩
+     * KEEP_MARGIN）的记录才移除；两个范围之间的记录保持原状，避免来回平移时反复增删。
+     */
+    void updateViewport();
+
+    /**
+     * @brief 把当前可见范围内的元素投影到屏幕并重建命中测试索引
+     */
+    void rebuildHitIndex() const;
+
+    /**
+     * @brief 标记命中测试索引失效（相机或元素变化时调用，下次查询时重建）
+     */
+    void invalidateHitIndex() { m_hitIndexDirty = true; }
+
+    /**
+     * @brief 在下一次事件循环中重新聚合（合并多次绘制/删除）
+     */
+    void scheduleClusterRefresh();
+
+    /**
+     * @brief 按当前缩放级别和加载范围重新查询聚合并更新地图上的点标注
+     *
+     * 只为加载范围内的聚合添加图标，范围外的点一律不显示；相机平移出上次的查询范围时重新查询。
+     */
+    void refreshClusters();
+
+    /**
+     * @brief 删除地图上的所有聚合图标
+     */
+    void clearClusterAnnotations();
+
+    /**
+     * @brief 加载聚合图标（圆形底色 + 成员数量）
+     * @param label 显示的数量文字
+     * @return 图标名称，加载失败返回空字符串
+     */
+    QString loadClusterIcon(const QString &label);
+
+    /**
+     * @brief 根据标注记录构造 MapLibre 标注对象（符号/填充）
+     */
+    QVariant buildAnnotation(const AnnotationRecord &record);
+
+    /**
+     * @brief 登记标注记录：分配句柄并加入空间索引
+     * @return 标注 ID（句柄）
+     */
+    QMapLibre::AnnotationID registerAnnotation(AnnotationRecord &&record);
+
+    /**
+     * @brief 计算元素的包围盒（圆形区域按半径外扩）
+     */
+    static GeoBounds boundsOf(const AnnotationRecord &record);
+
     /**
      * @brief 生成圆形的坐标点集合
      * @param centerLat 中心纬度
@@ -176,16 +404,39 @@ private:
         int numPoints = 64
     );
 
+    /**
+     * @brief 单位圆上 numPoints + 1 个点的 (sin, cos)，首尾重合（按点数缓存）
+     */
+    const QVector<QPair<double, double>> &unitCircle(int numPoints);
+
 private:
     QMapLibre::Map *m_map;                          // 地图对象
     QString m_loiterIconPath;                       // 盘旋点图标路径
     bool m_iconLoaded;                              // 盘旋点图标是否已加载
     QSet<QString> m_loadedUAVColors;                // 已加载的 UAV 图标颜色集合
-    QVector<QMapLibre::AnnotationID> m_annotations; // 所有标注 ID
-    QMap<QMapLibre::AnnotationID, RegionInfo> m_regionInfo; // 区域信息映射表
+    SlotMap<AnnotationRecord> m_records;            // 标注 ID -> 标注记录（稠密存储）
+    SpatialIndex m_spatialIndex;                    // 标注包围盒空间索引（标注 ID -> 包围盒）
+    PointClusterIndex m_clusterIndex;               // 点标注聚合索引（标注 ID -> 坐标）
+    QVector<QMapLibre::AnnotationID> m_clusterAnnotations; // 地图上的聚合图标（MapLibre 标注 ID）
+    QSet<QString> m_loadedClusterIcons;             // 已加载的聚合图标名称
     QMapLibre::AnnotationID m_previewAnnotationId;  // 预览区域标注 ID
     QMapLibre::AnnotationID m_taskRegionPreviewLineId; // 任务区域预览线段 ID
     QMapLibre::AnnotationID m_dynamicLineId;        // 动态预览线 ID
+    QHash<int, QVector<QPair<double, double>>> m_unitCircles; // 圆周点数 -> 单位圆 (sin, cos)
+    bool m_clusteringEnabled;                       // 是否启用点聚合
+    bool m_clusterRefreshPending;                   // 是否已安排重新聚合
+    int m_clusterZoom;                              // 当前聚合结果对应的缩放级别
+    GeoBounds m_clusterBounds;                      // 当前聚合结果对应的查询范围，空包围盒表示不限范围
+    int m_simplifyLevel;                            // 当前任务区域显示的简化级别
+    QSize m_viewportSize;                           // 地图视口尺寸（像素）
+    GeoBounds m_loadBounds;                         // 当前加载范围，空包围盒表示不裁剪
+    QSet<QMapLibre::AnnotationID> m_unculled;       // 未被裁剪的标注 ID（离开保留范围时只需检查这些）
+
+    mutable ScreenHitIndex m_hitIndex;              // 屏幕空间命中测试索引（按需重建）
+    mutable bool m_hitIndexDirty = true;            // 命中测试索引是否需要重建
+
+    static constexpr double LOAD_MARGIN = 0.25;     // 加载范围：视口每边外扩 1/4
+    static constexpr double KEEP_MARGIN = 0.75;     // 保留范围：视口每边外扩 3/4
 
     static constexpr const char* LOITER_ICON_NAME = "loiter-point-icon";
     static constexpr const char* UAV_ICON_PATH = "image/uav.png";
@@ -44,6 +44,7 @@ struct RegionInfo {
     QMapLibre::Coordinate coordinate;  // 对于点类型：位置；对于区域类型：中心点
     QMapLibre::Coordinates vertices;   // 对于任务区域：所有顶点
     double radius;                     // 对于禁飞区：半径（米）
+    double area;                       // 面积（平方米，来自区域的派生几何；点类型为 0）
     QString color;                     // 对于 UAV：颜色
     QMapLibre::AnnotationID annotationId;  // 标注ID
     TerrainType terrainType;           // 地形类型
@@ -54,6 +55,34 @@ struct RegionInfo {
     QString regionName;                // 区域名称
 };
 
+/**
+ * @brief 区域绘制参数（用于批量绘制）
+ */
+struct RegionDrawSpec {
+    RegionType type = RegionType::LoiterPoint;
+    QMapLibre::Coordinate coordinate;  // 点类型：位置；区域类型：中心点/圆心
+    QMapLibre::Coordinates vertices;   // 任务区域顶点
+    double radius = 0.0;               // 禁飞区/圆形任务区域半径（米）
+    QString color;                     // UAV 颜色
+    TaskRegionShape shape = TaskRegionShape::Polygon;  // 任务区域形状类型
+    bool visible = true;               // 是否显示（隐藏时只登记记录，不添加到地图）
+};
+
+/**
+ * @brief 区域创建参数（用于无交互批量创建，如 JSON 导入）
+ */
+struct RegionSpec {
+    RegionType type = RegionType::LoiterPoint;
+    QString name;                      // 区域名称（为空时使用默认名称，不弹出对话框）
+    QMapLibre::Coordinate coordinate;  // 点类型：位置；禁飞区/圆形任务区域：圆心
+    QMapLibre::Coordinates vertices;   // 任务区域顶点
+    double radius = 0.0;               // 禁飞区/圆形任务区域半径（米）
+    QString color = "black";           // UAV 颜色
+    TaskRegionShape shape = TaskRegionShape::Polygon;  // 任务区域形状类型
+    TerrainType terrainType = TerrainType::Plain;      // 地形类型
+    bool visible = true;               // 是否显示
+};
+
 /**
  * @brief 辅助函数：将整数转换为 RegionType
  */
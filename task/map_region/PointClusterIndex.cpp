@@ -0,0 +1,176 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "PointClusterIndex.h"
+
+PointClusterIndex::PointClusterIndex(double radius, int minZoom, int maxZoom)
+    : m_radius(radius)
+    , m_minZoom(minZoom)
+    , m_maxZoom(maxZoom)
+{
+}
+
+void PointClusterIndex::insert(quint32 id, const QMapLibre::Coordinate &coord)
+{
+    m_points.insert(id, coord);
+    m_dirty = true;
+}
+
+bool PointClusterIndex::remove(quint32 id)
+{
+    if (m_points.remove(id) == 0) {
+        return false;
+    }
+    m_dirty = true;
+    return true;
+}
+
+void PointClusterIndex::clear()
+{
+    m_points.clear();
+    m_levels.clear();
+    m_dirty = true;
+}
+
+void PointClusterIndex::build()
+{
+    m_levels.clear();
+    m_levels.resize(m_maxZoom + 2);
+
+    // 最高一级为原始点
+    QVector<Node> &leaves = m_levels[m_maxZoom + 1];
+    leaves.reserve(m_points.size());
+    for (auto it = m_points.constBegin(); it != m_points.constEnd(); ++it) {
+        leaves.append(Node{lonToX(it.value().second), latToY(it.value().first), 1, it.key()});
+    }
+
+    // 逐级向下聚合，每一级只处理上一级的结果
+    for (int z = m_maxZoom; z >= m_minZoom; --z) {
+        m_levels[z] = clusterLevel(m_levels[z + 1], z);
+    }
+
+    m_dirty = false;
+}
+
+QVector<PointClusterIndex::Node> PointClusterIndex::clusterLevel(const QVector<Node> &nodes, int zoom) const
+{
+    QVector<Node> result;
+    result.reserve(nodes.size());
+
+    // 聚合半径（墨卡托单位）
+    const double r = m_radius / (EXTENT * std::pow(2.0, zoom));
+    const double rSq = r * r;
+
+    // 用边长为 r 的网格做近邻查找，只需检查相邻 3x3 个单元格
+    QHash<quint64, QVector<int>> grid;
+    grid.reserve(nodes.size());
+    auto cellOf = [r](double v) { return qint64(std::floor(v / r)); };
+    auto keyOf = [](qint64 cx, qint64 cy) {
+        return (quint64(quint32(qint32(cx))) << 32) | quint64(quint32(qint32(cy)));
+    };
+    for (int i = 0; i < nodes.size(); ++i) {
+        grid[keyOf(cellOf(nodes[i].x), cellOf(nodes[i].y))].append(i);
+    }
+
+    QVector<bool> assigned(nodes.size(), false);
+    for (int i = 0; i < nodes.size(); ++i) {
+        if (assigned[i]) {
+            continue;
+        }
+        assigned[i] = true;
+
+        const Node &node = nodes[i];
+        int count = node.count;
+        double wx = node.x * node.count;
+        double wy = node.y * node.count;
+
+        const qint64 cx = cellOf(node.x);
+        const qint64 cy = cellOf(node.y);
+        for (qint64 gx = cx - 1; gx <= cx + 1; ++gx) {
+            for (qint64 gy = cy - 1; gy <= cy + 1; ++gy) {
+                auto cell = grid.constFind(keyOf(gx, gy));
+                if (cell == grid.constEnd()) {
+                    continue;
+                }
+                for (int j : cell.value()) {
+                    if (assigned[j]) {
+                        continue;
+                    }
+                    const Node &other = nodes[j];
+                    double dx = other.x - node.x;
+                    double dy = other.y - node.y;
+                    if (dx * dx + dy * dy <= rSq) {
+                        assigned[j] = true;
+                        count += other.count;
+                        wx += other.x * other.count;
+                        wy += other.y * other.count;
+                    }
+                }
+            }
+        }
+
+        if (count == node.count) {
+            result.append(node);  // 附近没有其他点，原样保留到下一级
+        } else {
+            result.append(Node{wx / count, wy / count, count, 0});
+        }
+    }
+
+    return result;
+}
+
+QVector<PointClusterIndex::Cluster> PointClusterIndex::clusters(double zoom, const GeoBounds &bounds)
+{
+    if (m_dirty) {
+        build();
+    }
+
+    int level = qBound(m_minZoom, int(std::floor(zoom)), m_maxZoom + 1);
+    const QVector<Node> &nodes = m_levels[level];
+
+    // 查询范围换算到墨卡托平面（y 轴方向与纬度相反）
+    const bool filter = bounds.isValid();
+    double minX = 0.0, maxX = 1.0, minY = 0.0, maxY = 1.0;
+    if (filter) {
+        minX = lonToX(bounds.minLon);
+        maxX = lonToX(bounds.maxLon);
+        minY = latToY(bounds.maxLat);
+        maxY = latToY(bounds.minLat);
+    }
+
+    QVector<Cluster> result;
+    result.reserve(nodes.size());
+    for (const Node &node : nodes) {
+        if (filter && (node.x < minX || node.x > maxX || node.y < minY || node.y > maxY)) {
+            continue;
+        }
+        Cluster cluster;
+        cluster.coordinate = QMapLibre::Coordinate(yToLat(node.y), xToLon(node.x));
+        cluster.count = node.count;
+        cluster.id = node.id;
+        result.append(cluster);
+    }
+    return result;
+}
+
+double PointClusterIndex::lonToX(double lon)
+{
+    return lon / 360.0 + 0.5;
+}
+
+double PointClusterIndex::latToY(double lat)
+{
+    double s = qSin(qDegreesToRadians(qBound(-85.0511, lat, 85.0511)));
+    return 0.5 - 0.25 * std::log((1.0 + s) / (1.0 - s)) / M_PI;
+}
+
+double PointClusterIndex::xToLon(double x)
+{
+    return (x - 0.5) * 360.0;
+}
+
+double PointClusterIndex::yToLat(double y)
+{
+    double y2 = (180.0 - y * 360.0) * M_PI / 180.0;
+    return 360.0 * std::atan(std::exp(y2)) / M_PI - 90.0;
+}
@@ -0,0 +1,103 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef POINTCLUSTERINDEX_H
+#define POINTCLUSTERINDEX_H
+
+#include "GeoBounds.h"
+#include <QHash>
+#include <QVector>
+
+/**
+ * @brief 分层点聚合索引（supercluster 思路）
+ *
+ * 点先投影到 Web 墨卡托单位平面 [0,1]²，然后从最大缩放级别逐级向下聚合：
+ * 每一级把上一级的节点按聚合半径（像素）合并，得到该缩放级别下的聚合结果。
+ * 索引只在点集变化后重建一次，之后按缩放级别查询是 O(该级节点数)。
+ *
+ * 点集变化不做增量更新：一个点的增删可能改变各级的合并结果，insert/remove 只标记脏，
+ * 下一次查询时整体重建（O(点数 × 级数)）。调用方应把一批增删合并后再查询，
+ * MapPainter 通过 scheduleClusterRefresh 在下一次事件循环中统一刷新。
+ */
+class PointClusterIndex {
+public:
+    /**
+     * @brief 聚合结果
+     */
+    struct Cluster {
+        QMapLibre::Coordinate coordinate;  // 聚合中心（成员加权平均）
+        int count = 0;                     // 成员数量
+        quint32 id = 0;                    // 单点时为该点ID，聚合时为 0
+    };
+
+    /**
+     * @param radius 聚合半径（像素）
+     * @param minZoom 最小聚合缩放级别
+     * @param maxZoom 最大聚合缩放级别，超过后不再聚合
+     */
+    explicit PointClusterIndex(double radius = 40.0, int minZoom = 0, int maxZoom = 16);
+
+    // ==================== 点集维护 ====================
+
+    /**
+     * @brief 添加或更新点（仅标记需要重建）
+     */
+    void insert(quint32 id, const QMapLibre::Coordinate &coord);
+
+    /**
+     * @brief 删除点（仅标记需要重建）
+     */
+    bool remove(quint32 id);
+
+    void clear();
+
+    bool contains(quint32 id) const { return m_points.contains(id); }
+    int size() const { return m_points.size(); }
+
+    /**
+     * @brief 点集变化后是否需要重建
+     */
+    bool isDirty() const { return m_dirty; }
+
+    /**
+     * @brief 重建各缩放级别的聚合结果
+     */
+    void build();
+
+    // ==================== 查询 ====================
+
+    /**
+     * @brief 查询指定缩放级别下的聚合结果（需要时自动重建）
+     * @param zoom 缩放级别（取整数部分）
+     * @param bounds 只返回落在该范围内的结果；空包围盒表示不限范围
+     */
+    QVector<Cluster> clusters(double zoom, const GeoBounds &bounds = GeoBounds());
+
+    int maxZoom() const { return m_maxZoom; }
+
+private:
+    struct Node {
+        double x;      // 墨卡托 x [0,1]
+        double y;      // 墨卡托 y [0,1]
+        int count;     // 成员数量
+        quint32 id;    // 单点ID，聚合节点为 0
+    };
+
+    static double lonToX(double lon);
+    static double latToY(double lat);
+    static double xToLon(double x);
+    static double yToLat(double y);
+
+    QVector<Node> clusterLevel(const QVector<Node> &nodes, int zoom) const;
+
+    double m_radius;
+    int m_minZoom;
+    int m_maxZoom;
+    QHash<quint32, QMapLibre::Coordinate> m_points;  // 原始点
+    QVector<QVector<Node>> m_levels;                 // 下标 = 缩放级别，m_levels[maxZoom+1] 为原始点
+    bool m_dirty = true;
+
+    static constexpr double EXTENT = 512.0;  // 瓦片像素尺寸，与 MapLibre 缩放级别一致
+};
+
+#endif // POINTCLUSTERINDEX_H
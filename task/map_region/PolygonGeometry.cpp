@@ -0,0 +1,243 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "PolygonGeometry.h"
+#include "Geodesy.h"
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+PolygonGeometry::PolygonGeometry(const QMapLibre::Coordinates &vertices)
+    : m_bounds(GeoBounds::fromCoordinates(vertices))
+{
+    if (!m_bounds.isValid()) {
+        return;
+    }
+
+    // 以包围盒中心为投影原点，经度方向按原点纬度缩放
+    m_originLat = (m_bounds.minLat + m_bounds.maxLat) * 0.5;
+    m_originLon = (m_bounds.minLon + m_bounds.maxLon) * 0.5;
+    m_metersPerDegLat = Geodesy::METERS_PER_DEG_LAT;
+    m_metersPerDegLon = m_metersPerDegLat * qCos(qDegreesToRadians(m_originLat));
+
+    int count = vertices.size();
+    if (count > 1 && vertices.first() == vertices.last()) {
+        --count;  // 去掉闭合点
+    }
+
+    m_points.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        m_points.append(project(vertices[i]));
+    }
+
+    m_minX = m_maxX = m_points.isEmpty() ? 0.0 : m_points.first().x;
+    m_minY = m_maxY = m_points.isEmpty() ? 0.0 : m_points.first().y;
+    for (const Point &p : m_points) {
+        m_minX = qMin(m_minX, p.x);
+        m_maxX = qMax(m_maxX, p.x);
+        m_minY = qMin(m_minY, p.y);
+        m_maxY = qMax(m_maxY, p.y);
+    }
+}
+
+PolygonGeometry::Point PolygonGeometry::project(const QMapLibre::Coordinate &coord) const
+{
+    return Point{(coord.second - m_originLon) * m_metersPerDegLon,
+                 (coord.first - m_originLat) * m_metersPerDegLat};
+}
+
+QMapLibre::Coordinate PolygonGeometry::unproject(const Point &p) const
+{
+    return QMapLibre::Coordinate(m_originLat + p.y / m_metersPerDegLat,
+                                 m_originLon + p.x / m_metersPerDegLon);
+}
+
+bool PolygonGeometry::contains(const QMapLibre::Coordinate &point) const
+{
+    if (!isValid() || !m_bounds.contains(point)) {
+        return false;
+    }
+    return containsProjected(project(point));
+}
+
+bool PolygonGeometry::containsProjected(const Point &p) const
+{
+    bool inside = false;
+    const int n = m_points.size();
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        const Point &a = m_points[i];
+        const Point &b = m_points[j];
+        // 检查向右的水平射线是否与边 (b, a) 相交
+        if ((a.y > p.y) != (b.y > p.y) &&
+            p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+double PolygonGeometry::distanceTo(const QMapLibre::Coordinate &point, double maxDistance) const
+{
+    if (!isValid()) {
+        return std::numeric_limits<double>::max();
+    }
+
+    const Point p = project(point);
+
+    // 包围盒粗筛：点到平面包围盒的距离是到多边形距离的下界
+    double dx = qMax(qMax(m_minX - p.x, 0.0), p.x - m_maxX);
+    double dy = qMax(qMax(m_minY - p.y, 0.0), p.y - m_maxY);
+    double boxDistSq = dx * dx + dy * dy;
+    if (boxDistSq >= maxDistance * maxDistance) {
+        return qSqrt(boxDistSq);
+    }
+
+    if (boxDistSq == 0.0 && containsProjected(p)) {
+        return 0.0;
+    }
+
+    return edgeDistanceProjected(p);
+}
+
+double PolygonGeometry::edgeDistanceProjected(const Point &p) const
+{
+    // 逐边计算点到线段距离的平方，最后只开一次方
+    double minDistSq = std::numeric_limits<double>::max();
+    const int n = m_points.size();
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        const Point &a = m_points[j];
+        const Point &b = m_points[i];
+        double ex = b.x - a.x;
+        double ey = b.y - a.y;
+        double wx = p.x - a.x;
+        double wy = p.y - a.y;
+        double lenSq = ex * ex + ey * ey;
+        double t = lenSq > 0.0 ? (wx * ex + wy * ey) / lenSq : 0.0;
+        t = qBound(0.0, t, 1.0);
+        double cx = wx - t * ex;
+        double cy = wy - t * ey;
+        minDistSq = qMin(minDistSq, cx * cx + cy * cy);
+    }
+
+    return qSqrt(minDistSq);
+}
+
+double PolygonGeometry::signedDistanceProjected(const Point &p) const
+{
+    double distance = edgeDistanceProjected(p);
+    return containsProjected(p) ? distance : -distance;
+}
+
+bool PolygonGeometry::scanlineInteriorPoint(Point &out) const
+{
+    // 取相邻两个顶点纵坐标之间间隔最大的一段，在其中间高度作水平线（不经过任何顶点）
+    QVector<double> ys;
+    ys.reserve(m_points.size());
+    for (const Point &p : m_points) {
+        ys.append(p.y);
+    }
+    std::sort(ys.begin(), ys.end());
+    double y = 0.0;
+    double gap = 0.0;
+    for (int i = 1; i < ys.size(); ++i) {
+        if (ys[i] - ys[i - 1] > gap) {
+            gap = ys[i] - ys[i - 1];
+            y = (ys[i] + ys[i - 1]) * 0.5;
+        }
+    }
+    if (gap <= 0.0) {
+        return false;
+    }
+
+    // 与各边的交点（与 containsProjected 的射线判断用同一公式），排序后两两构成内部区间
+    QVector<double> xs;
+    const int n = m_points.size();
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        const Point &a = m_points[i];
+        const Point &b = m_points[j];
+        if ((a.y > y) != (b.y > y)) {
+            xs.append((b.x - a.x) * (y - a.y) / (b.y - a.y) + a.x);
+        }
+    }
+    std::sort(xs.begin(), xs.end());
+
+    // 取最宽区间的中点
+    double width = 0.0;
+    for (int i = 0; i + 1 < xs.size(); i += 2) {
+        if (xs[i + 1] - xs[i] > width) {
+            width = xs[i + 1] - xs[i];
+            out = Point{(xs[i] + xs[i + 1]) * 0.5, y};
+        }
+    }
+    return width > 0.0;
+}
+
+QMapLibre::Coordinate PolygonGeometry::poleOfInaccessibility(double precision) const
+{
+    const Point boxCenter{(m_minX + m_maxX) * 0.5, (m_minY + m_maxY) * 0.5};
+    const double width = m_maxX - m_minX;
+    const double height = m_maxY - m_minY;
+    const double shortSide = qMin(width, height);
+    const double longSide = qMax(width, height);
+    if (!isValid() || shortSide <= 0.0) {
+        return unproject(boxCenter);
+    }
+    if (precision <= 0.0) {
+        precision = shortSide * 0.01;
+    }
+
+    struct Cell {
+        Point center;
+        double half;       // 半边长
+        double distance;   // 格心的有向距离
+        double potential;  // 格内可能达到的最大距离
+    };
+    auto makeCell = [this](double x, double y, double half) {
+        Cell cell{Point{x, y}, half, signedDistanceProjected(Point{x, y}), 0.0};
+        cell.potential = cell.distance + half * M_SQRT2;
+        return cell;
+    };
+    auto lessPotential = [](const Cell &a, const Cell &b) { return a.potential < b.potential; };
+    std::priority_queue<Cell, std::vector<Cell>, decltype(lessPotential)> queue(lessPotential);
+
+    // 初始网格：以较短边为格子边长覆盖包围盒，较长边方向最多 MAX_INITIAL_CELLS 格
+    const double cellSize = qMax(shortSide, longSide / MAX_INITIAL_CELLS);
+    const double half = cellSize * 0.5;
+    for (double x = m_minX; x < m_maxX; x += cellSize) {
+        for (double y = m_minY; y < m_maxY; y += cellSize) {
+            queue.push(makeCell(x + half, y + half, half));
+        }
+    }
+
+    // 初始最优值取包围盒中心和扫描线内部点中较好的一个。细长的凹多边形（如窄 L 形走廊）
+    // 的格心可能全部落在外部，有了内部的初值，提前停止时结果也一定在内部
+    Cell best = makeCell(boxCenter.x, boxCenter.y, 0.0);
+    Point interior;
+    if (scanlineInteriorPoint(interior)) {
+        Cell cell = makeCell(interior.x, interior.y, 0.0);
+        if (cell.distance > best.distance) {
+            best = cell;
+        }
+    }
+
+    while (!queue.empty()) {
+        Cell cell = queue.top();
+        queue.pop();
+
+        if (cell.distance > best.distance) {
+            best = cell;
+        }
+        // 剩余方格的上界都不可能明显超过当前最优值
+        if (cell.potential - best.distance <= precision) {
+            break;
+        }
+
+        const double h = cell.half * 0.5;
+        queue.push(makeCell(cell.center.x - h, cell.center.y - h, h));
+        queue.push(makeCell(cell.center.x + h, cell.center.y - h, h));
+        queue.push(makeCell(cell.center.x - h, cell.center.y + h, h));
+        queue.push(makeCell(cell.center.x + h, cell.center.y + h, h));
+    }
+
+    return best.distance > 0.0 ? unproject(best.center) : unproject(boxCenter);
+}
@@ -0,0 +1,98 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef POLYGONGEOMETRY_H
+#define POLYGONGEOMETRY_H
+
+#include "GeoBounds.h"
+#include <QVector>
+#include <limits>
+
+/**
+ * @brief 多边形几何内核 - 用于点击命中测试
+ *
+ * 构造时把多边形一次性投影到以包围盒中心为原点的局部平面坐标系（等距圆柱投影，单位：米），
+ * 之后的点内判断和点到边距离都在平面上计算，不再逐顶点调用 haversine。
+ * 作业区域尺度（几十公里以内）下投影误差远小于点击阈值。
+ */
+class PolygonGeometry {
+public:
+    PolygonGeometry() = default;
+
+    /**
+     * @brief 构造多边形几何
+     * @param vertices 多边形顶点（首尾可以闭合也可以不闭合）
+     */
+    explicit PolygonGeometry(const QMapLibre::Coordinates &vertices);
+
+    bool isValid() const { return m_points.size() >= 3; }
+
+    /**
+     * @brief 多边形的经纬度包围盒
+     */
+    const GeoBounds& bounds() const { return m_bounds; }
+
+    /**
+     * @brief 判断点是否在多边形内部（射线法）
+     */
+    bool contains(const QMapLibre::Coordinate &point) const;
+
+    /**
+     * @brief 计算点到多边形的精确距离（米），点在内部时为 0
+     * @param point 地理坐标
+     * @param maxDistance 只关心小于该值的结果；包围盒距离已超过时直接返回，跳过逐边计算
+     * @return 距离（米），超出 maxDistance 时返回值不小于 maxDistance
+     */
+    double distanceTo(const QMapLibre::Coordinate &point,
+                      double maxDistance = std::numeric_limits<double>::max()) const;
+
+    /**
+     * @brief 不可达极点：多边形内部离边界最远的点（polylabel 网格细分）
+     *
+     * 凹多边形（C 形、L 形）的质心可能落在外部，需要一个保证在内部的点时使用。
+     * 按包围盒划分方格，优先细分“格心距离 + 半对角线”上界最大的方格，
+     * 上界不超过当前最优值 + precision 的方格直接丢弃。初始最优值取一个扫描线内部点，
+     * 即使方格全部落在多边形外（比精度还窄的走廊），结果也在内部。
+     * @param precision 精度（米），不大于 0 时取包围盒较短边的 1%
+     * @return 内部点；多边形无效或退化（面积为 0）时返回包围盒中心
+     */
+    QMapLibre::Coordinate poleOfInaccessibility(double precision = 0.0) const;
+
+    static constexpr int MAX_INITIAL_CELLS = 64;  // 初始网格沿较长边的最大格数
+
+private:
+    struct Point {
+        double x;  // 东向（米）
+        double y;  // 北向（米）
+    };
+
+    Point project(const QMapLibre::Coordinate &coord) const;
+    QMapLibre::Coordinate unproject(const Point &p) const;
+    bool containsProjected(const Point &p) const;
+
+    /**
+     * @brief 点到边界的最近距离（米，不判断内外）
+     */
+    double edgeDistanceProjected(const Point &p) const;
+
+    /**
+     * @brief 有向距离：内部为正、外部为负
+     */
+    double signedDistanceProjected(const Point &p) const;
+
+    /**
+     * @brief 扫描线内部点：水平线与多边形相交的最宽区间的中点
+     * @return 多边形面积为 0、找不到内部区间时返回 false
+     */
+    bool scanlineInteriorPoint(Point &out) const;
+
+    QVector<Point> m_points;   // 投影后的顶点（不重复闭合点）
+    GeoBounds m_bounds;        // 经纬度包围盒
+    double m_originLat = 0.0;  // 投影原点纬度
+    double m_originLon = 0.0;  // 投影原点经度
+    double m_metersPerDegLat = 0.0;
+    double m_metersPerDegLon = 0.0;
+    double m_minX = 0.0, m_minY = 0.0, m_maxX = 0.0, m_maxY = 0.0;  // 平面包围盒
+};
+
+#endif // POLYGONGEOMETRY_H
@@ -0,0 +1,113 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "PolygonSimplifier.h"
+#include "Geodesy.h"
+#include <QtMath>
+
+namespace {
+
+// 各简化级别适用的缩放级别上限（不含）；最后一级不简化
+const double LEVEL_MAX_ZOOM[PolygonSimplifier::LEVEL_COUNT - 1] = {8.0, 11.0, 14.0};
+
+// 512 像素瓦片下 0 级的每像素米数
+const double METERS_PER_PIXEL_Z0 = 2.0 * M_PI * Geodesy::EARTH_RADIUS / 512.0;
+
+} // namespace
+
+QMapLibre::Coordinates PolygonSimplifier::simplify(const QMapLibre::Coordinates &vertices, double toleranceMeters)
+{
+    int n = vertices.size();
+    if (n > 1 && vertices.first() == vertices.last()) {
+        --n;  // 去掉闭合点
+    }
+    if (n <= 3 || toleranceMeters <= 0.0) {
+        return vertices;
+    }
+
+    // 投影到以第一个顶点为原点的局部平面（米）
+    const double metersPerDegLat = Geodesy::METERS_PER_DEG_LAT;
+    const double metersPerDegLon = metersPerDegLat * qCos(qDegreesToRadians(vertices.first().first));
+    QVector<double> xs(n + 1), ys(n + 1);
+    for (int i = 0; i < n; ++i) {
+        xs[i] = (vertices[i].second - vertices.first().second) * metersPerDegLon;
+        ys[i] = (vertices[i].first - vertices.first().first) * metersPerDegLat;
+    }
+    // 首尾都以第一个顶点为锚点，环上离它最远的点必然被保留
+    xs[n] = xs[0];
+    ys[n] = ys[0];
+
+    const double toleranceSq = toleranceMeters * toleranceMeters;
+    QVector<bool> keep(n + 1, false);
+    keep[0] = keep[n] = true;
+
+    // 显式栈代替递归，避免数千顶点时栈过深
+    QVector<QPair<int, int>> stack;
+    stack.append(qMakePair(0, n));
+    while (!stack.isEmpty()) {
+        QPair<int, int> range = stack.takeLast();
+        const int first = range.first;
+        const int last = range.second;
+
+        const double ax = xs[first], ay = ys[first];
+        const double ex = xs[last] - ax, ey = ys[last] - ay;
+        const double lenSq = ex * ex + ey * ey;
+
+        double maxDistSq = -1.0;
+        int index = -1;
+        for (int i = first + 1; i < last; ++i) {
+            double wx = xs[i] - ax;
+            double wy = ys[i] - ay;
+            double t = lenSq > 0.0 ? qBound(0.0, (wx * ex + wy * ey) / lenSq, 1.0) : 0.0;
+            double dx = wx - t * ex;
+            double dy = wy - t * ey;
+            double distSq = dx * dx + dy * dy;
+            if (distSq > maxDistSq) {
+                maxDistSq = distSq;
+                index = i;
+            }
+        }
+
+        if (index >= 0 && maxDistSq > toleranceSq) {
+            keep[index] = true;
+            stack.append(qMakePair(first, index));
+            stack.append(qMakePair(index, last));
+        }
+    }
+
+    QMapLibre::Coordinates result;
+    for (int i = 0; i < n; ++i) {
+        if (keep[i]) {
+            result.append(vertices[i]);
+        }
+    }
+
+    return result.size() >= 3 ? result : vertices;
+}
+
+QVector<QMapLibre::Coordinates> PolygonSimplifier::buildLevels(const QMapLibre::Coordinates &vertices)
+{
+    QVector<QMapLibre::Coordinates> levels(LEVEL_COUNT, vertices);  // 隐式共享，不复制顶点
+    if (vertices.size() <= MIN_VERTICES) {
+        return levels;
+    }
+
+    // 按多边形所在纬度换算每像素米数；按每一级适用范围的最大缩放级别取容差，保证整个范围内偏差不超过 1 像素
+    const double cosLat = qCos(qDegreesToRadians(vertices.first().first));
+    for (int level = LEVEL_COUNT - 2; level >= 0; --level) {
+        double metersPerPixel = METERS_PER_PIXEL_Z0 * cosLat / qPow(2.0, LEVEL_MAX_ZOOM[level]);
+        // 在上一级（更精细）的结果上继续简化
+        levels[level] = simplify(levels[level + 1], PIXEL_TOLERANCE * metersPerPixel);
+    }
+    return levels;
+}
+
+int PolygonSimplifier::levelForZoom(double zoom)
+{
+    for (int level = 0; level < LEVEL_COUNT - 1; ++level) {
+        if (zoom < LEVEL_MAX_ZOOM[level]) {
+            return level;
+        }
+    }
+    return LEVEL_COUNT - 1;
+}
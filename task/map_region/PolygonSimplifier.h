@@ -0,0 +1,52 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef POLYGONSIMPLIFIER_H
+#define POLYGONSIMPLIFIER_H
+
+#include <QMapLibre/Types>
+#include <QVector>
+
+/**
+ * @brief 多边形简化（Douglas-Peucker）
+ *
+ * 为每个多边形预计算几个容差级别的简化结果，绘制时按当前缩放级别选用。
+ * 简化结果只用于显示，命中测试和面积等分析始终使用原始顶点。
+ */
+class PolygonSimplifier {
+public:
+    /**
+     * @brief 简化多边形
+     * @param vertices 原始顶点（不要求闭合）
+     * @param toleranceMeters 容差（米），偏离不超过该值的顶点会被去掉
+     * @return 简化后的顶点；结果不足3个点时返回原始顶点
+     */
+    static QMapLibre::Coordinates simplify(const QMapLibre::Coordinates &vertices, double toleranceMeters);
+
+    /**
+     * @brief 预计算各级简化结果
+     * @param vertices 原始顶点
+     * @return 下标与 levelForZoom 的返回值对应；最后一级为原始顶点
+     */
+    static QVector<QMapLibre::Coordinates> buildLevels(const QMapLibre::Coordinates &vertices);
+
+    /**
+     * @brief 根据缩放级别选择简化级别
+     */
+    static int levelForZoom(double zoom);
+
+    static constexpr int LEVEL_COUNT = 4;
+
+private:
+    /**
+     * @brief 顶点数不超过该值的多边形不做简化
+     */
+    static constexpr int MIN_VERTICES = 16;
+
+    /**
+     * @brief 显示允许的偏差（像素）
+     */
+    static constexpr double PIXEL_TOLERANCE = 1.0;
+};
+
+#endif // POLYGONSIMPLIFIER_H
@@ -0,0 +1,455 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "PolygonValidator.h"
+#include "Geodesy.h"
+#include <algorithm>
+#include <limits>
+#include <set>
+
+namespace {
+
+const double DUPLICATE_EPS = 1e-6;    // 视为同一顶点的距离（米）
+const double LINE_EPS = 1e-6;         // 视为共线的点线距离（米）
+
+/**
+ * @brief 顶点：局部平面坐标 + 原始经纬度（修复时原样输出，不经过反投影）
+ */
+struct Vertex {
+    double x;
+    double y;
+    QMapLibre::Coordinate coord;
+};
+
+double cross(const Vertex &o, const Vertex &a, const Vertex &b)
+{
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+/**
+ * @brief 方向判断：1 逆时针，-1 顺时针，0 共线
+ *
+ * 叉积 = |oa|·|ob|·sinθ，除以较长边即为较近的点到另一条直线的距离；该距离不超过 LINE_EPS
+ * 时视为共线。容差随边长缩放，经纬度投影带来的舍入误差（远小于 1 微米）不会把共线误判为转向。
+ */
+int orientation(const Vertex &o, const Vertex &a, const Vertex &b)
+{
+    double c = cross(o, a, b);
+    double oa2 = (a.x - o.x) * (a.x - o.x) + (a.y - o.y) * (a.y - o.y);
+    double ob2 = (b.x - o.x) * (b.x - o.x) + (b.y - o.y) * (b.y - o.y);
+    if (c * c <= LINE_EPS * LINE_EPS * qMax(oa2, ob2)) {
+        return 0;
+    }
+    return c > 0.0 ? 1 : -1;
+}
+
+// p 与 a、b 共线时，p 是否落在线段 ab 上
+bool onSegment(const Vertex &p, const Vertex &a, const Vertex &b)
+{
+    return p.x >= qMin(a.x, b.x) - DUPLICATE_EPS && p.x <= qMax(a.x, b.x) + DUPLICATE_EPS &&
+           p.y >= qMin(a.y, b.y) - DUPLICATE_EPS && p.y <= qMax(a.y, b.y) + DUPLICATE_EPS;
+}
+
+bool lessXY(const Vertex &a, const Vertex &b)
+{
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+double signedArea(const QVector<Vertex> &ring)
+{
+    double area2 = 0.0;
+    for (int i = 0; i < ring.size(); ++i) {
+        const Vertex &a = ring[i];
+        const Vertex &b = ring[(i + 1) % ring.size()];
+        area2 += a.x * b.y - b.x * a.y;
+    }
+    return area2 * 0.5;
+}
+
+/**
+ * @brief 去掉闭合点和连续重复点
+ */
+QVector<Vertex> normalized(QVector<Vertex> ring, bool closed)
+{
+    QVector<Vertex> result;
+    result.reserve(ring.size());
+    auto same = [](const Vertex &a, const Vertex &b) {
+        return qAbs(a.x - b.x) <= DUPLICATE_EPS && qAbs(a.y - b.y) <= DUPLICATE_EPS;
+    };
+    for (const Vertex &v : ring) {
+        if (result.isEmpty() || !same(result.last(), v)) {
+            result.append(v);
+        }
+    }
+    while (closed && result.size() > 1 && same(result.first(), result.last())) {
+        result.removeLast();
+    }
+    return result;
+}
+
+QVector<Vertex> project(const QMapLibre::Coordinates &vertices, const QMapLibre::Coordinate &origin)
+{
+    QVector<Vertex> ring;
+    ring.reserve(vertices.size());
+    for (const auto &coord : vertices) {
+        Vertex v;
+        Geodesy::toLocal(origin, coord, v.x, v.y);
+        v.coord = coord;
+        ring.append(v);
+    }
+    return ring;
+}
+
+QMapLibre::Coordinate originOf(const QMapLibre::Coordinates &vertices)
+{
+    GeoBounds bounds = GeoBounds::fromCoordinates(vertices);
+    return QMapLibre::Coordinate((bounds.minLat + bounds.maxLat) * 0.5, (bounds.minLon + bounds.maxLon) * 0.5);
+}
+
+/**
+ * @brief 扫描线检查结果
+ */
+struct Hit {
+    int edgeA = -1;
+    int edgeB = -1;
+    int sharedVertex = -1;   // 相邻边折返时为公共顶点，否则为 -1
+    double x = 0.0;
+    double y = 0.0;
+};
+
+/**
+ * @brief Shamos-Hoey 扫描线
+ *
+ * 事件为各边的左右端点，按 (x, y) 排序，同一点先插入后删除；
+ * 状态为按当前扫描位置处 y 值排序的边集合，插入时与上下邻居比较，删除时比较上下邻居。
+ */
+class Sweep {
+public:
+    Sweep(const QVector<Vertex> &ring, bool closed)
+        : m_ring(ring)
+        , m_count(ring.size())
+        , m_edgeCount(closed ? ring.size() : ring.size() - 1)
+        , m_closed(closed)
+    {}
+
+    bool findIntersection(Hit &hit)
+    {
+        if (m_edgeCount < 2) {
+            return false;
+        }
+
+        struct Event {
+            const Vertex *point;
+            bool isLeft;
+            int edge;
+        };
+        QVector<Event> events;
+        events.reserve(m_edgeCount * 2);
+        for (int e = 0; e < m_edgeCount; ++e) {
+            events.append(Event{&left(e), true, e});
+            events.append(Event{&right(e), false, e});
+        }
+        std::sort(events.begin(), events.end(), [](const Event &a, const Event &b) {
+            if (lessXY(*a.point, *b.point)) return true;
+            if (lessXY(*b.point, *a.point)) return false;
+            if (a.isLeft != b.isLeft) return a.isLeft;
+            return a.edge < b.edge;
+        });
+
+        using Status = std::set<int, EdgeOrder>;
+        Status status(EdgeOrder{this});
+        QVector<Status::iterator> positions(m_edgeCount, status.end());
+
+        for (const Event &event : events) {
+            m_sweepX = event.point->x;
+            m_sweepY = event.point->y;
+
+            if (event.isLeft) {
+                auto it = status.insert(event.edge).first;
+                positions[event.edge] = it;
+                if (std::next(it) != status.end() && conflict(*it, *std::next(it), hit)) {
+                    return true;
+                }
+                if (it != status.begin() && conflict(*std::prev(it), *it, hit)) {
+                    return true;
+                }
+            } else {
+                auto it = positions[event.edge];
+                if (it != status.begin() && std::next(it) != status.end() &&
+                    conflict(*std::prev(it), *std::next(it), hit)) {
+                    return true;
+                }
+                status.erase(it);
+            }
+        }
+        return false;
+    }
+
+private:
+    struct EdgeOrder {
+        const Sweep *sweep;
+        bool operator()(int a, int b) const { return sweep->below(a, b); }
+    };
+
+    const Vertex& start(int e) const { return m_ring[e]; }
+    const Vertex& end(int e) const { return m_ring[(e + 1) % m_count]; }
+    const Vertex& left(int e) const { return lessXY(start(e), end(e)) ? start(e) : end(e); }
+    const Vertex& right(int e) const { return lessXY(start(e), end(e)) ? end(e) : start(e); }
+
+    // 边在当前扫描位置处的 y；竖直边取扫描点 y 截到边的范围内
+    double yAt(int e) const
+    {
+        const Vertex &a = left(e);
+        const Vertex &b = right(e);
+        if (b.x - a.x <= 0.0) {
+            return qBound(a.y, m_sweepY, b.y);
+        }
+        return a.y + (b.y - a.y) * (m_sweepX - a.x) / (b.x - a.x);
+    }
+
+    double slope(int e) const
+    {
+        const Vertex &a = left(e);
+        const Vertex &b = right(e);
+        return b.x - a.x <= 0.0 ? std::numeric_limits<double>::infinity() : (b.y - a.y) / (b.x - a.x);
+    }
+
+    bool below(int a, int b) const
+    {
+        if (a == b) {
+            return false;
+        }
+        double ya = yAt(a);
+        double yb = yAt(b);
+        if (qAbs(ya - yb) > DUPLICATE_EPS) {
+            return ya < yb;
+        }
+        double sa = slope(a);
+        double sb = slope(b);
+        if (sa != sb) {
+            return sa < sb;
+        }
+        return a < b;
+    }
+
+    /**
+     * @brief 两条边除相邻边的公共顶点外是否还有交点
+     */
+    bool conflict(int a, int b, Hit &hit) const
+    {
+        if (a > b) {
+            std::swap(a, b);
+        }
+        hit.edgeA = a;
+        hit.edgeB = b;
+
+        // 相邻边：只在公共顶点处相接是正常的，沿原方向折返才算重叠
+        int shared = -1, prev = -1, next = -1;
+        if ((a + 1) % m_count == b) {
+            shared = b;
+            prev = a;
+            next = (b + 1) % m_count;
+        } else if (m_closed && (b + 1) % m_count == a) {
+            shared = a;
+            prev = b;
+            next = (a + 1) % m_count;
+        }
+        if (shared >= 0) {
+            const Vertex &p = m_ring[prev];
+            const Vertex &s = m_ring[shared];
+            const Vertex &n = m_ring[next];
+            double dot = (p.x - s.x) * (n.x - s.x) + (p.y - s.y) * (n.y - s.y);
+            if (orientation(p, s, n) == 0 && dot > 0.0) {
+                hit.sharedVertex = shared;
+                hit.x = s.x;
+                hit.y = s.y;
+                return true;
+            }
+            return false;
+        }
+
+        const Vertex &p1 = start(a), &q1 = end(a);
+        const Vertex &p2 = start(b), &q2 = end(b);
+        int o1 = orientation(p1, q1, p2);
+        int o2 = orientation(p1, q1, q2);
+        int o3 = orientation(p2, q2, p1);
+        int o4 = orientation(p2, q2, q1);
+
+        hit.sharedVertex = -1;
+        if (o1 != o2 && o3 != o4) {
+            double rx = q1.x - p1.x, ry = q1.y - p1.y;
+            double sx = q2.x - p2.x, sy = q2.y - p2.y;
+            double denom = rx * sy - ry * sx;
+            double t = qAbs(denom) > 0.0 ? ((p2.x - p1.x) * sy - (p2.y - p1.y) * sx) / denom : 0.0;
+            t = qBound(0.0, t, 1.0);
+            hit.x = p1.x + t * rx;
+            hit.y = p1.y + t * ry;
+            return true;
+        }
+
+        // 共线或端点落在另一条边上
+        const Vertex *touch = nullptr;
+        if (o1 == 0 && onSegment(p2, p1, q1)) touch = &p2;
+        else if (o2 == 0 && onSegment(q2, p1, q1)) touch = &q2;
+        else if (o3 == 0 && onSegment(p1, p2, q2)) touch = &p1;
+        else if (o4 == 0 && onSegment(q1, p2, q2)) touch = &q1;
+        if (touch) {
+            hit.x = touch->x;
+            hit.y = touch->y;
+            return true;
+        }
+        return false;
+    }
+
+    const QVector<Vertex> &m_ring;
+    int m_count;
+    int m_edgeCount;
+    bool m_closed;
+    double m_sweepX = 0.0;
+    double m_sweepY = 0.0;
+};
+
+/**
+ * @brief 以包围盒中心为原点投影、去掉重复点后扫描
+ *
+ * isSimple 和 repair 都经过这里，同一组坐标得到的结论完全一致：
+ * repair 输出的每个部分在创建区域时的检查中同样判为有效。
+ * @param ring 输出：投影并去重后的顶点
+ * @param origin 输出：投影原点
+ * @return 找到相交返回 true（顶点不足时返回 false，由调用方按 ring 大小判断）
+ */
+bool scan(const QMapLibre::Coordinates &vertices, bool closed,
+          QVector<Vertex> &ring, QMapLibre::Coordinate &origin, Hit &hit)
+{
+    origin = originOf(vertices);
+    ring = normalized(project(vertices, origin), closed);
+    if (ring.size() < (closed ? 3 : 2)) {
+        return false;
+    }
+    return Sweep(ring, closed).findIntersection(hit);
+}
+
+bool check(const QMapLibre::Coordinates &vertices, bool closed, PolygonValidator::Intersection *intersection)
+{
+    QVector<Vertex> ring;
+    QMapLibre::Coordinate origin;
+    Hit hit;
+    bool found = scan(vertices, closed, ring, origin, hit);
+    if (ring.size() < (closed ? 3 : 2)) {
+        if (intersection) {
+            *intersection = PolygonValidator::Intersection();
+        }
+        return !closed;   // 折线顶点不足时不会相交；多边形不足3个不同顶点无效
+    }
+
+    if (!found) {
+        return true;
+    }
+    if (intersection) {
+        intersection->edgeA = hit.edgeA;
+        intersection->edgeB = hit.edgeB;
+        intersection->point = Geodesy::fromLocal(origin, hit.x, hit.y);
+    }
+    return false;
+}
+
+QMapLibre::Coordinates coordinatesOf(const QVector<Vertex> &ring)
+{
+    QMapLibre::Coordinates coords;
+    coords.reserve(ring.size());
+    for (const Vertex &v : ring) {
+        coords.append(v.coord);
+    }
+    return coords;
+}
+
+} // namespace
+
+bool PolygonValidator::isSimple(const QMapLibre::Coordinates &vertices, Intersection *intersection)
+{
+    return check(vertices, true, intersection);
+}
+
+bool PolygonValidator::isSimplePolyline(const QMapLibre::Coordinates &vertices, Intersection *intersection)
+{
+    return check(vertices, false, intersection);
+}
+
+QVector<QMapLibre::Coordinates> PolygonValidator::repair(const QMapLibre::Coordinates &vertices, int *unrepaired)
+{
+    QVector<QMapLibre::Coordinates> parts;
+    int failed = 0;
+
+    // 每个部分都按经纬度重新投影检查（与 isSimple 相同的过程），拆分出的交点也先换回经纬度，
+    // 避免在旧投影平面上判为有效、创建区域时却被拒绝。
+    // 每次拆分或去掉折返点后顶点数都严格减少，循环必然结束；另设处理次数上限兜底
+    int budget = 4 * vertices.size() + 16;
+    QVector<QMapLibre::Coordinates> pending;
+    pending.append(vertices);
+    while (!pending.isEmpty()) {
+        QMapLibre::Coordinates current = pending.takeLast();
+        if (--budget < 0) {
+            ++failed;
+            continue;
+        }
+
+        QVector<Vertex> ring;
+        QMapLibre::Coordinate origin;
+        Hit hit;
+        bool found = scan(current, true, ring, origin, hit);
+        if (ring.size() < 3) {
+            continue;   // 退化为线段或点，面积为 0
+        }
+
+        // 面积只对简单多边形有意义（8 字形两瓣的有向面积会相互抵消）
+        if (!found) {
+            if (qAbs(signedArea(ring)) < MIN_PART_AREA) {
+                continue;
+            }
+            QMapLibre::Coordinates part = coordinatesOf(ring);
+            // 去掉重复点后包围盒（投影原点）可能变化，按最终坐标再确认一次
+            if (part.size() != current.size() && !isSimple(part)) {
+                pending.append(part);
+                continue;
+            }
+            parts.append(part);
+            continue;
+        }
+
+        if (hit.sharedVertex >= 0) {
+            ring.remove(hit.sharedVertex);
+            pending.append(coordinatesOf(ring));
+            continue;
+        }
+
+        // 在交点 P 处把 edgeA、edgeB 之间的环和其余部分拆开
+        Vertex p;
+        p.x = hit.x;
+        p.y = hit.y;
+        p.coord = Geodesy::fromLocal(origin, hit.x, hit.y);
+
+        QVector<Vertex> first;
+        first.append(p);
+        for (int i = hit.edgeA + 1; i <= hit.edgeB; ++i) {
+            first.append(ring[i]);
+        }
+
+        QVector<Vertex> second;
+        second.append(p);
+        for (int i = hit.edgeB + 1; i < ring.size(); ++i) {
+            second.append(ring[i]);
+        }
+        for (int i = 0; i <= hit.edgeA; ++i) {
+            second.append(ring[i]);
+        }
+
+        pending.append(coordinatesOf(first));
+        pending.append(coordinatesOf(second));
+    }
+
+    if (unrepaired) {
+        *unrepaired = failed;
+    }
+    std::reverse(parts.begin(), parts.end());
+    return parts;
+}
@@ -0,0 +1,59 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef POLYGONVALIDATOR_H
+#define POLYGONVALIDATOR_H
+
+#include <QMapLibre/Types>
+#include <QVector>
+
+/**
+ * @brief 多边形有效性检查（Shamos-Hoey 扫描线）
+ *
+ * 自相交的多边形会让面积、质心和点内判断失去意义，创建任务区域前先做检查。
+ * 顶点投影到局部平面后按 x 排序扫描，只比较扫描线上相邻的边，O(n log n)，
+ * 找到第一处相交即返回，绘制过程中随鼠标移动实时检查也没有压力。
+ * 共线判断的容差按边长缩放（点到直线距离不超过 1 微米），不受经纬度投影舍入误差影响。
+ *
+ * 边 i 指第 i 个顶点到下一个顶点的线段，顶点下标以去掉闭合点和连续重复点之后为准。
+ * 相邻边只允许在公共顶点处相接，折返（与相邻边共线重叠）同样视为无效。
+ */
+class PolygonValidator {
+public:
+    /**
+     * @brief 相交位置
+     */
+    struct Intersection {
+        int edgeA = -1;                  // 相交的两条边（edgeA < edgeB）
+        int edgeB = -1;
+        QMapLibre::Coordinate point;     // 交点（共线重叠时为重叠部分的一个端点）
+    };
+
+    /**
+     * @brief 是否为简单多边形（首尾可以闭合也可以不闭合）
+     * @param vertices 顶点
+     * @param intersection 输出：第一处找到的相交（可为 nullptr；不足3个不同顶点时边号为 -1）
+     * @return 有效返回 true
+     */
+    static bool isSimple(const QMapLibre::Coordinates &vertices, Intersection *intersection = nullptr);
+
+    /**
+     * @brief 折线是否不自相交（绘制中尚未闭合的多边形）
+     */
+    static bool isSimplePolyline(const QMapLibre::Coordinates &vertices, Intersection *intersection = nullptr);
+
+    /**
+     * @brief 自动修复：在交点处反复拆分，得到若干个简单多边形
+     *
+     * 折返的顶点直接去掉；面积小于 MIN_PART_AREA 的碎片丢弃。
+     * 返回的每个部分都经过与 isSimple 相同的检查，可以直接用于创建任务区域。
+     * 输入本身有效时返回只含原多边形（去掉重复点）的列表。
+     * @param unrepaired 输出：无法修复而丢弃的部分数量（可为 nullptr；不含面积过小的碎片）
+     * @return 修复后的多边形（可能为空）
+     */
+    static QVector<QMapLibre::Coordinates> repair(const QMapLibre::Coordinates &vertices, int *unrepaired = nullptr);
+
+    static constexpr double MIN_PART_AREA = 1.0;   // 修复结果保留的最小面积（平方米）
+};
+
+#endif // POLYGONVALIDATOR_H
@@ -5,22 +5,59 @@
 
 Region::Region()
     : m_id(0)
+    , m_number(0)
     , m_type(RegionType::LoiterPoint)
     , m_annotationId(0)
+    , m_visible(true)
     , m_radius(0.0)
     , m_terrainType(TerrainType::Plain)
+    , m_taskRegionShape(TaskRegionShape::Polygon)
 {
 }
 
 Region::Region(int id, Type type)
     : m_id(id)
+    , m_number(0)
     , m_type(type)
     , m_annotationId(0)
+    , m_visible(true)
     , m_radius(0.0)
     , m_terrainType(TerrainType::Plain)
+    , m_taskRegionShape(TaskRegionShape::Polygon)
 {
 }
 
+void Region::setCoordinate(const QMapLibre::Coordinate &coord) {
+    m_coordinate = coord;
+
+    // 多边形/矩形任务区域的几何只由顶点决定，位置（质心）变化不影响缓存
+    if (m_type != RegionType::TaskRegion || m_taskRegionShape == TaskRegionShape::Circle) {
+        invalidateGeometry();
+    }
+}
+
+const RegionGeometry& Region::geometry() const {
+    if (m_geometryValid) {
+        return m_geometry;
+    }
+
+    switch (m_type) {
+        case RegionType::NoFlyZone:
+            m_geometry = RegionGeometry::fromCircle(m_coordinate, m_radius);
+            break;
+        case RegionType::TaskRegion:
+            m_geometry = m_taskRegionShape == TaskRegionShape::Circle
+                ? RegionGeometry::fromCircle(m_coordinate, m_radius, m_vertices)
+                : RegionGeometry::fromPolygon(m_vertices);
+            break;
+        default:
+            m_geometry = RegionGeometry::fromPoint(m_coordinate);
+            break;
+    }
+    m_geometryValid = true;
+    return m_geometry;
+}
+
 QString Region::typeToString(Type type) {
     switch (type) {
         case RegionType::LoiterPoint:
@@ -5,6 +5,7 @@
 #define REGION_H
 
 #include "MapRegionTypes.h"
+#include "RegionGeometry.h"
 #include <QString>
 
 /**
@@ -26,33 +27,53 @@ public:
 
     int id() const { return m_id; }
     QString name() const { return m_name; }
+
+    /**
+     * @brief 显示编号（按创建顺序从 1 递增，不复用；用于界面和默认名称，区域ID是内部句柄）
+     */
+    int number() const { return m_number; }
+    void setNumber(int number) { m_number = number; }
+
     Type type() const { return m_type; }
     QMapLibre::AnnotationID annotationId() const { return m_annotationId; }
 
     void setId(int id) { m_id = id; }
     void setName(const QString &name) { m_name = name; }
-    void setType(Type type) { m_type = type; }
+    void setType(Type type) { m_type = type; invalidateGeometry(); }
     void setAnnotationId(QMapLibre::AnnotationID id) { m_annotationId = id; }
 
+    /**
+     * @brief 是否显示（隐藏时地图标注保留，只是不添加到地图上）
+     */
+    bool isVisible() const { return m_visible; }
+    void setVisible(bool visible) { m_visible = visible; }
+
     // ==================== 几何信息 ====================
 
     /**
      * @brief 获取坐标（点类型：位置；区域类型：中心点）
      */
     QMapLibre::Coordinate coordinate() const { return m_coordinate; }
-    void setCoordinate(const QMapLibre::Coordinate &coord) { m_coordinate = coord; }
+    void setCoordinate(const QMapLibre::Coordinate &coord);
 
     /**
      * @brief 获取多边形顶点（仅用于 Polygon 类型）
      */
     QMapLibre::Coordinates vertices() const { return m_vertices; }
-    void setVertices(const QMapLibre::Coordinates &vertices) { m_vertices = vertices; }
+    void setVertices(const QMapLibre::Coordinates &vertices) { m_vertices = vertices; invalidateGeometry(); }
 
     /**
      * @brief 获取半径（仅用于 NoFlyZone 类型）
      */
     double radius() const { return m_radius; }
-    void setRadius(double radius) { m_radius = radius; }
+    void setRadius(double radius) { m_radius = radius; invalidateGeometry(); }
+
+    /**
+     * @brief 获取派生几何（包围盒、质心、面积、周长、局部投影原点）
+     *
+     * 第一次读取时计算并缓存，之后只有位置/顶点/半径/形状变化才重新计算。
+     */
+    const RegionGeometry& geometry() const;
 
     // ==================== 属性 ====================
 
@@ -72,7 +93,7 @@ public:
      * @brief 获取任务区域形状类型（仅用于 TaskRegion 类型）
      */
     TaskRegionShape taskRegionShape() const { return m_taskRegionShape; }
-    void setTaskRegionShape(TaskRegionShape shape) { m_taskRegionShape = shape; }
+    void setTaskRegionShape(TaskRegionShape shape) { m_taskRegionShape = shape; invalidateGeometry(); }
 
     // ==================== 辅助方法 ====================
 
@@ -80,11 +101,15 @@ public:
     static QString terrainTypeToString(TerrainType type);
 
 private:
+    void invalidateGeometry() { m_geometryValid = false; }
+
     // 基本属性
     int m_id;                              // 全局唯一ID
+    int m_number;                          // 显示编号
     QString m_name;                        // 区域名称（可选）
     Type m_type;                           // 类型
     QMapLibre::AnnotationID m_annotationId; // 地图标注ID
+    bool m_visible;                        // 是否显示
 
     // 几何信息
     QMapLibre::Coordinate m_coordinate;    // 位置/中心点
@@ -95,6 +120,10 @@ private:
     QString m_color;                       // UAV颜色
     TerrainType m_terrainType;             // 地形类型
     TaskRegionShape m_taskRegionShape;     // 任务区域形状类型（仅TaskRegion使用）
+
+    // 派生几何缓存
+    mutable RegionGeometry m_geometry;     // 派生几何
+    mutable bool m_geometryValid = false;  // 缓存是否有效
 };
 
 #endif // REGION_H
@@ -0,0 +1,123 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "RegionArena.h"
+
+RegionArena::~RegionArena()
+{
+    for (Region *chunk : m_chunks) {
+        delete[] chunk;
+    }
+}
+
+Region* RegionArena::create(RegionType type)
+{
+    int slot;
+    if (m_freeHead >= 0) {
+        slot = m_freeHead;
+        m_freeHead = m_slots[slot].nextFree;
+    } else {
+        slot = m_slots.size();
+        Q_ASSERT(quint32(slot) < INDEX_MASK);
+        // 当前块用完时才分配新块
+        if ((slot >> CHUNK_BITS) >= m_chunks.size()) {
+            m_chunks.append(new Region[CHUNK_SIZE]);
+        }
+        m_slots.append(Slot{0, -1, false});
+    }
+
+    Slot &info = m_slots[slot];
+    info.alive = true;
+    info.nextFree = -1;
+    ++m_size;
+
+    Region &region = at(slot);
+    region = Region(makeId(slot, info.generation), type);
+    region.setNumber(m_nextNumber++);
+    return &region;
+}
+
+bool RegionArena::destroy(int regionId)
+{
+    int slot;
+    if (!resolve(regionId, &slot)) {
+        return false;
+    }
+
+    // 重置为空区域，释放名称、顶点等属性占用的内存
+    at(slot) = Region();
+
+    // 代数加一使旧ID失效，槽位放回空闲链表（代数用尽则退役）
+    Slot &info = m_slots[slot];
+    info.alive = false;
+    --m_size;
+    if (advanceGeneration(info)) {
+        info.nextFree = m_freeHead;
+        m_freeHead = slot;
+    }
+    return true;
+}
+
+void RegionArena::clear()
+{
+    m_freeHead = -1;
+    for (int slot = m_slots.size() - 1; slot >= 0; --slot) {
+        Slot &info = m_slots[slot];
+        if (info.alive) {
+            at(slot) = Region();
+            info.alive = false;
+            if (!advanceGeneration(info)) {
+                continue;
+            }
+        } else if (info.generation == RETIRED) {
+            continue;
+        }
+        info.nextFree = m_freeHead;
+        m_freeHead = slot;
+    }
+    m_size = 0;
+}
+
+bool RegionArena::advanceGeneration(Slot &info)
+{
+    if (info.generation >= GENERATION_MASK) {
+        info.generation = RETIRED;
+        info.nextFree = -1;
+        return false;
+    }
+    ++info.generation;
+    return true;
+}
+
+Region* RegionArena::get(int regionId) const
+{
+    int slot;
+    return resolve(regionId, &slot) ? &at(slot) : nullptr;
+}
+
+int RegionArena::nextAlive(int slot) const
+{
+    while (slot < m_slots.size() && !m_slots[slot].alive) {
+        ++slot;
+    }
+    return slot;
+}
+
+bool RegionArena::resolve(int regionId, int *slot) const
+{
+    if (regionId <= 0) {
+        return false;
+    }
+    const quint32 handle = quint32(regionId);
+    const quint32 low = handle & INDEX_MASK;
+    if (low == 0 || low > quint32(m_slots.size())) {
+        return false;
+    }
+
+    const Slot &info = m_slots[int(low - 1)];
+    if (!info.alive || info.generation != (handle >> INDEX_BITS)) {
+        return false;
+    }
+    *slot = int(low - 1);
+    return true;
+}
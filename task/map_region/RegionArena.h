@@ -0,0 +1,127 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef REGIONARENA_H
+#define REGIONARENA_H
+
+#include "Region.h"
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief 区域对象池 - 分块连续存储 + 代数句柄
+ *
+ * - 区域按固定大小的块连续存放，块一旦分配就不再移动，Region* 在区域删除前一直有效
+ * - 删除的槽位放回空闲链表，再次创建时直接复用，不经过内存分配器
+ * - 区域ID = (代数 << 24) | (槽位下标 + 1)：首次使用的槽位代数为 0，ID 即 1, 2, 3...；
+ *   槽位复用时代数加一，已删除区域的旧ID不会指向新区域
+ * - 代数只有 7 位，槽位用到最后一代后退役、不再复用，旧ID不会因代数回绕重新生效
+ *   （每复用 128 次浪费一个槽位）
+ * - 区域ID是内部句柄，不用于显示；界面和默认名称使用按创建顺序递增的显示编号（Region::number）
+ * - 遍历按槽位顺序线性扫描各块，跳过空槽位
+ */
+class RegionArena {
+public:
+    RegionArena() = default;
+    ~RegionArena();
+
+    RegionArena(const RegionArena &) = delete;
+    RegionArena &operator=(const RegionArena &) = delete;
+
+    // ==================== 创建/删除 ====================
+
+    /**
+     * @brief 创建区域（已设置ID和类型，其余属性为默认值）
+     * @return 区域指针，区域删除前一直有效
+     */
+    Region* create(RegionType type);
+
+    /**
+     * @brief 删除区域，释放其属性占用的内存并回收槽位
+     * @return ID 有效返回 true
+     */
+    bool destroy(int regionId);
+
+    /**
+     * @brief 删除所有区域（保留已分配的块供后续复用）
+     */
+    void clear();
+
+    // ==================== 查询 ====================
+
+    /**
+     * @brief 获取区域，ID 无效或已删除返回 nullptr
+     */
+    Region* get(int regionId) const;
+
+    bool contains(int regionId) const { return get(regionId) != nullptr; }
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    // ==================== 遍历 ====================
+
+    class const_iterator {
+    public:
+        Region* operator*() const { return &m_arena->at(m_slot); }
+        const_iterator &operator++() {
+            m_slot = m_arena->nextAlive(m_slot + 1);
+            return *this;
+        }
+        bool operator==(const const_iterator &other) const { return m_slot == other.m_slot; }
+        bool operator!=(const const_iterator &other) const { return m_slot != other.m_slot; }
+
+    private:
+        friend class RegionArena;
+        const_iterator(const RegionArena *arena, int slot) : m_arena(arena), m_slot(slot) {}
+
+        const RegionArena *m_arena;
+        int m_slot;
+    };
+
+    const_iterator begin() const { return const_iterator(this, nextAlive(0)); }
+    const_iterator end() const { return const_iterator(this, m_slots.size()); }
+
+private:
+    struct Slot {
+        quint32 generation;  // 代数
+        int nextFree;        // 空闲时：下一个空闲槽位，-1 表示链表结束
+        bool alive;          // 是否存放着有效区域
+    };
+
+    Region &at(int slot) const { return m_chunks[slot >> CHUNK_BITS][slot & CHUNK_MASK]; }
+
+    /**
+     * @brief 从指定槽位开始查找第一个有效槽位，找不到返回槽位总数
+     */
+    int nextAlive(int slot) const;
+
+    /**
+     * @brief 解析区域ID，校验代数和占用状态
+     */
+    bool resolve(int regionId, int *slot) const;
+
+    /**
+     * @brief 槽位释放后代数加一；最后一代用完时退役，返回 false（不再放回空闲链表）
+     */
+    static bool advanceGeneration(Slot &info);
+
+    static int makeId(int slot, quint32 generation) {
+        return int((generation << INDEX_BITS) | quint32(slot + 1));
+    }
+
+    QVector<Region*> m_chunks;   // 每块 CHUNK_SIZE 个区域（new[] 分配）
+    QVector<Slot> m_slots;       // 槽位状态，下标与区域存放位置一一对应
+    int m_freeHead = -1;         // 空闲链表头
+    int m_size = 0;              // 有效区域数量
+    int m_nextNumber = 1;        // 下一个显示编号（只增不减）
+
+    static constexpr int CHUNK_BITS = 6;
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_BITS;   // 每块 64 个区域
+    static constexpr int CHUNK_MASK = CHUNK_SIZE - 1;
+    static constexpr int INDEX_BITS = 24;
+    static constexpr quint32 INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr quint32 GENERATION_MASK = 0x7F;     // 7 位代数，保证 ID 为正数
+    static constexpr quint32 RETIRED = GENERATION_MASK + 1; // 退役槽位的代数，任何ID都无法匹配
+};
+
+#endif // REGIONARENA_H
@@ -0,0 +1,65 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef REGIONCHANGESET_H
+#define REGIONCHANGESET_H
+
+#include <QSet>
+
+/**
+ * @brief 区域变化集合 - 一次事务（或一次事件循环）内的所有区域变化，已去重合并
+ *
+ * 合并规则：
+ * - 同一区域多次更新只记录一次
+ * - 事务内新建的区域再更新/显隐，只记为新建
+ * - 事务内新建又删除的区域两边都不记录
+ * - 删除的区域不再出现在更新/显隐集合中
+ */
+struct RegionChangeSet {
+    QSet<int> created;             // 新建的区域ID
+    QSet<int> removed;             // 删除的区域ID
+    QSet<int> updated;             // 属性变化的区域ID（名称、地形、颜色等）
+    QSet<int> visibilityChanged;   // 显示/隐藏变化的区域ID
+
+    void addCreated(int regionId) {
+        created.insert(regionId);
+    }
+
+    void addRemoved(int regionId) {
+        updated.remove(regionId);
+        visibilityChanged.remove(regionId);
+        if (!created.remove(regionId)) {
+            removed.insert(regionId);
+        }
+    }
+
+    void addUpdated(int regionId) {
+        if (!created.contains(regionId)) {
+            updated.insert(regionId);
+        }
+    }
+
+    void addVisibilityChanged(int regionId) {
+        if (!created.contains(regionId)) {
+            visibilityChanged.insert(regionId);
+        }
+    }
+
+    /**
+     * @brief 区域列表本身（增删）是否变化
+     */
+    bool membershipChanged() const { return !created.isEmpty() || !removed.isEmpty(); }
+
+    bool isEmpty() const {
+        return created.isEmpty() && removed.isEmpty() && updated.isEmpty() && visibilityChanged.isEmpty();
+    }
+
+    void clear() {
+        created.clear();
+        removed.clear();
+        updated.clear();
+        visibilityChanged.clear();
+    }
+};
+
+#endif // REGIONCHANGESET_H
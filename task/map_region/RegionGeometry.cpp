@@ -0,0 +1,114 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "RegionGeometry.h"
+#include "Geodesy.h"
+#include "PolygonGeometry.h"
+
+RegionGeometry RegionGeometry::fromPoint(const QMapLibre::Coordinate &coord)
+{
+    RegionGeometry geometry;
+    geometry.bounds = GeoBounds::fromPoint(coord);
+    geometry.centroid = coord;
+    geometry.anchor = coord;
+    geometry.setOriginFromBounds();
+    return geometry;
+}
+
+RegionGeometry RegionGeometry::fromCircle(const QMapLibre::Coordinate &center, double radius,
+                                          const QMapLibre::Coordinates &vertices)
+{
+    RegionGeometry geometry;
+
+    // 近似顶点可能略小于真实圆，包围盒取两者并集
+    geometry.bounds = GeoBounds::fromCircle(center, radius);
+    for (const auto &coord : vertices) {
+        geometry.bounds.extend(coord);
+    }
+
+    geometry.centroid = center;
+    geometry.anchor = center;
+    geometry.area = M_PI * radius * radius;
+    geometry.perimeter = 2.0 * M_PI * radius;
+    geometry.setOriginFromBounds();
+    return geometry;
+}
+
+RegionGeometry RegionGeometry::fromPolygon(const QMapLibre::Coordinates &vertices)
+{
+    RegionGeometry geometry;
+    geometry.bounds = GeoBounds::fromCoordinates(vertices);
+    if (!geometry.bounds.isValid()) {
+        return geometry;
+    }
+    geometry.setOriginFromBounds();
+
+    int count = vertices.size();
+    if (count > 1 && vertices.first() == vertices.last()) {
+        --count;  // 去掉闭合点
+    }
+
+    double sphericalArea = 0.0;   // 球面多边形面积（未乘 R²/2）
+    double planarArea2 = 0.0;     // 局部平面上的有向面积 × 2
+    double cx = 0.0, cy = 0.0;    // 质心累加量
+    double sumX = 0.0, sumY = 0.0;
+
+    for (int i = 0; i < count; ++i) {
+        const auto &a = vertices[i];
+        const auto &b = vertices[(i + 1) % count];
+
+        double lat1 = qDegreesToRadians(a.first);
+        double lat2 = qDegreesToRadians(b.first);
+        sphericalArea += qDegreesToRadians(b.second - a.second) * (2.0 + qSin(lat1) + qSin(lat2));
+
+        QPointF p = geometry.toLocal(a);
+        QPointF q = geometry.toLocal(b);
+        double cross = p.x() * q.y() - q.x() * p.y();
+        planarArea2 += cross;
+        cx += (p.x() + q.x()) * cross;
+        cy += (p.y() + q.y()) * cross;
+        sumX += p.x();
+        sumY += p.y();
+    }
+
+    geometry.area = qAbs(sphericalArea) * Geodesy::EARTH_RADIUS * Geodesy::EARTH_RADIUS / 2.0;
+    geometry.perimeter = Geodesy::pathLength(GeoPoints(vertices.mid(0, count)), true);
+
+    // 退化多边形（面积近似为 0）退回顶点平均值
+    if (qAbs(planarArea2) > 1e-6) {
+        geometry.centroid = geometry.fromLocal(QPointF(cx / (3.0 * planarArea2), cy / (3.0 * planarArea2)));
+    } else if (count > 0) {
+        geometry.centroid = geometry.fromLocal(QPointF(sumX / count, sumY / count));
+    }
+
+    // 凹多边形的质心可能在外部，此时锚点改取不可达极点（同一投影，直接复用平面内核）
+    geometry.anchor = geometry.centroid;
+    PolygonGeometry polygon(vertices);
+    if (polygon.isValid() && !polygon.contains(geometry.centroid)) {
+        geometry.anchor = polygon.poleOfInaccessibility();
+    }
+
+    return geometry;
+}
+
+RegionGeometry RegionGeometry::fromSpec(const RegionSpec &spec)
+{
+    switch (spec.type) {
+        case RegionType::NoFlyZone:
+            return fromCircle(spec.coordinate, spec.radius);
+        case RegionType::TaskRegion:
+            return spec.shape == TaskRegionShape::Circle
+                ? fromCircle(spec.coordinate, spec.radius, spec.vertices)
+                : fromPolygon(spec.vertices);
+        default:
+            return fromPoint(spec.coordinate);
+    }
+}
+
+void RegionGeometry::setOriginFromBounds()
+{
+    origin = QMapLibre::Coordinate((bounds.minLat + bounds.maxLat) * 0.5,
+                                   (bounds.minLon + bounds.maxLon) * 0.5);
+    metersPerDegLat = Geodesy::METERS_PER_DEG_LAT;
+    metersPerDegLon = metersPerDegLat * qCos(qDegreesToRadians(origin.first));
+}
@@ -0,0 +1,78 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef REGIONGEOMETRY_H
+#define REGIONGEOMETRY_H
+
+#include "GeoBounds.h"
+#include "MapRegionTypes.h"
+#include <QPointF>
+
+/**
+ * @brief 区域派生几何 - 包围盒、质心、锚点、面积、周长和局部投影原点
+ *
+ * 只由区域的几何参数（位置、顶点、半径）决定，由 Region 在创建或几何变化后计算一次并缓存，
+ * 空间索引、标签位置、面积显示等直接读取，不再各自重复计算。
+ *
+ * 局部投影与 PolygonGeometry 相同：以包围盒中心为原点的等距圆柱投影（东/北，单位：米）。
+ */
+struct RegionGeometry {
+    GeoBounds bounds;                  // 经纬度包围盒
+    QMapLibre::Coordinate centroid;    // 质心（多边形按面积加权，圆为圆心；凹多边形可能在外部）
+    QMapLibre::Coordinate anchor;      // 锚点（保证在区域内部，用于标签和点击命中）
+    double area = 0.0;                 // 面积（平方米，点类型为 0）
+    double perimeter = 0.0;            // 周长（米，点类型为 0）
+    QMapLibre::Coordinate origin;      // 局部投影原点（包围盒中心）
+    double metersPerDegLat = 0.0;      // 原点处每度纬度对应的米数
+    double metersPerDegLon = 0.0;      // 原点处每度经度对应的米数
+
+    /**
+     * @brief 经纬度 -> 局部平面坐标（x 向东，y 向北，单位：米）
+     */
+    QPointF toLocal(const QMapLibre::Coordinate &coord) const {
+        return QPointF((coord.second - origin.second) * metersPerDegLon,
+                       (coord.first - origin.first) * metersPerDegLat);
+    }
+
+    /**
+     * @brief 局部平面坐标 -> 经纬度
+     */
+    QMapLibre::Coordinate fromLocal(const QPointF &local) const {
+        return QMapLibre::Coordinate(origin.first + local.y() / metersPerDegLat,
+                                     origin.second + local.x() / metersPerDegLon);
+    }
+
+    /**
+     * @brief 点类型（盘旋点、无人机）
+     */
+    static RegionGeometry fromPoint(const QMapLibre::Coordinate &coord);
+
+    /**
+     * @brief 圆形（禁飞区、圆形任务区域）
+     * @param center 圆心
+     * @param radius 半径（米）
+     * @param vertices 圆形近似顶点（可为空；非空时包围盒取两者并集）
+     */
+    static RegionGeometry fromCircle(const QMapLibre::Coordinate &center, double radius,
+                                     const QMapLibre::Coordinates &vertices = QMapLibre::Coordinates());
+
+    /**
+     * @brief 多边形（多边形/矩形任务区域，首尾可以闭合也可以不闭合）
+     *
+     * 锚点：质心在多边形内部时取质心，否则（C 形、L 形等凹多边形）取不可达极点。
+     */
+    static RegionGeometry fromPolygon(const QMapLibre::Coordinates &vertices);
+
+    /**
+     * @brief 按区域参数计算（与 Region::geometry() 规则相同，用于快照等不持有 Region 的场合）
+     */
+    static RegionGeometry fromSpec(const RegionSpec &spec);
+
+private:
+    /**
+     * @brief 由包围盒确定投影原点和比例
+     */
+    void setOriginFromBounds();
+};
+
+#endif // REGIONGEOMETRY_H
@@ -2,35 +2,32 @@
 // SPDX-License-Identifier: MIT
 
 #include "RegionManager.h"
-#include "RegionPropertyDialog.h"
+#include "PolygonValidator.h"
 #include <QDebug>
+#include <QtMath>
+#include <QTimer>
 
-RegionManager::RegionManager(MapPainter *painter, QObject *parent)
+RegionManager::RegionManager(RegionRenderer *renderer, QObject *parent)
     : QObject(parent)
-    , m_painter(painter)
-    , m_nextId(1)
+    , m_renderer(renderer)
 {
-    if (!m_painter) {
-        qWarning() << "RegionManager: painter is null!";
+    if (!m_renderer) {
+        qDebug() << "RegionManager: 未设置渲染器，区域不绘制到地图（无界面模式）";
     }
 }
 
 RegionManager::~RegionManager() {
-    // 清理所有区域
-    qDeleteAll(m_regions);
+    // 清理所有区域（对象池析构时统一释放内存）
     m_regions.clear();
+    m_spatialIndex.clear();
+    m_annotationToRegion.clear();
 }
 
 // ==================== 创建区域 ====================
 
 Region* RegionManager::createLoiterPoint(double lat, double lon, const QString &name) {
-    if (!m_painter) {
-        qWarning() << "RegionManager::createLoiterPoint: painter is null!";
-        return nullptr;
-    }
-
-    int regionId = generateNextId();
-    Region *region = new Region(regionId, RegionType::LoiterPoint);
+    Region *region = m_regions.create(RegionType::LoiterPoint);
+    int regionId = region->id();
     region->setCoordinate(QMapLibre::Coordinate(lat, lon));
 
     // 先在地图上绘制（让用户看到位置）
@@ -39,15 +36,13 @@ Region* RegionManager::createLoiterPoint(double lat, double lon, const QString &
     // 如果没有指定名称，生成默认名称并弹出对话框
     QString regionName;
     if (name.isEmpty()) {
-        QString defaultName = generateDefaultName(RegionType::LoiterPoint, regionId);
+        QString defaultName = generateDefaultName(RegionType::LoiterPoint, region->number());
         regionName = promptForName(defaultName);
 
         // 用户取消了命名，撤销创建（删除已绘制的标注）
         if (regionName.isEmpty()) {
-            if (region->annotationId() != 0) {
-                m_painter->removeAnnotation(region->annotationId());
-            }
-            delete region;
+            removeRegionAnnotation(region);
+            m_regions.destroy(regionId);
             qDebug() << "用户取消创建盘旋点";
             return nullptr;
         }
@@ -56,47 +51,43 @@ Region* RegionManager::createLoiterPoint(double lat, double lon, const QString &
     }
     region->setName(regionName);
 
-    // 存储
-    m_regions.insert(regionId, region);
+    // 加入空间索引
+    indexRegion(region);
 
     emit regionCreated(regionId);
+    m_pendingChanges.addCreated(regionId);
+    markSnapshotDirty(regionId);
+    scheduleChangeFlush();
     qDebug() << "创建盘旋点: ID =" << regionId << ", 名称 =" << region->name();
 
     return region;
 }
 
 Region* RegionManager::createUAV(double lat, double lon, const QString &color, const QString &name) {
-    if (!m_painter) {
-        qWarning() << "RegionManager::createUAV: painter is null!";
-        return nullptr;
-    }
-
-    int regionId = generateNextId();
-    Region *region = new Region(regionId, RegionType::UAV);
-    region->setName(name.isEmpty() ? QString("无人机 %1").arg(regionId) : name);
+    Region *region = m_regions.create(RegionType::UAV);
+    int regionId = region->id();
+    region->setName(name.isEmpty() ? QString("无人机 %1").arg(region->number()) : name);
     region->setCoordinate(QMapLibre::Coordinate(lat, lon));
     region->setColor(color);
 
     // 在地图上绘制
     drawRegion(region);
 
-    // 存储
-    m_regions.insert(regionId, region);
+    // 加入空间索引
+    indexRegion(region);
 
     emit regionCreated(regionId);
+    m_pendingChanges.addCreated(regionId);
+    markSnapshotDirty(regionId);
+    scheduleChangeFlush();
     qDebug() << "创建无人机: ID =" << regionId << ", 颜色 =" << color;
 
     return region;
 }
 
 Region* RegionManager::createNoFlyZone(double lat, double lon, double radius, const QString &name) {
-    if (!m_painter) {
-        qWarning() << "RegionManager::createNoFlyZone: painter is null!";
-        return nullptr;
-    }
-
-    int regionId = generateNextId();
-    Region *region = new Region(regionId, RegionType::NoFlyZone);
+    Region *region = m_regions.create(RegionType::NoFlyZone);
+    int regionId = region->id();
     region->setCoordinate(QMapLibre::Coordinate(lat, lon));
     region->setRadius(radius);
     region->setTerrainType(TerrainType::Plain);  // 默认平原
@@ -107,15 +98,13 @@ Region* RegionManager::createNoFlyZone(double lat, double lon, double radius, co
     // 如果没有指定名称，生成默认名称并弹出对话框
     QString regionName;
     if (name.isEmpty()) {
-        QString defaultName = generateDefaultName(RegionType::NoFlyZone, regionId);
+        QString defaultName = generateDefaultName(RegionType::NoFlyZone, region->number());
         regionName = promptForName(defaultName);
 
         // 用户取消了命名，撤销创建（删除已绘制的标注）
         if (regionName.isEmpty()) {
-            if (region->annotationId() != 0) {
-                m_painter->removeAnnotation(region->annotationId());
-            }
-            delete region;
+            removeRegionAnnotation(region);
+            m_regions.destroy(regionId);
             qDebug() << "用户取消创建禁飞区";
             return nullptr;
         }
@@ -124,42 +113,38 @@ Region* RegionManager::createNoFlyZone(double lat, double lon, double radius, co
     }
     region->setName(regionName);
 
-    // 存储
-    m_regions.insert(regionId, region);
+    // 加入空间索引
+    indexRegion(region);
 
     emit regionCreated(regionId);
+    m_pendingChanges.addCreated(regionId);
+    markSnapshotDirty(regionId);
+    scheduleChangeFlush();
     qDebug() << "创建禁飞区: ID =" << regionId << ", 半径 =" << radius << "米";
 
     return region;
 }
 
 Region* RegionManager::createTaskRegion(const QMapLibre::Coordinates &vertices, const QString &name) {
-    if (!m_painter) {
-        qWarning() << "RegionManager::createTaskRegion: painter is null!";
-        return nullptr;
-    }
-
     if (vertices.size() < 3) {
         qWarning() << "RegionManager::createTaskRegion: 多边形顶点数不足（至少需要3个）";
         return nullptr;
     }
+    PolygonValidator::Intersection intersection;
+    if (!PolygonValidator::isSimple(vertices, &intersection)) {
+        qWarning() << QString("RegionManager::createTaskRegion: 多边形自相交（第 %1 条边与第 %2 条边），已拒绝")
+                      .arg(intersection.edgeA).arg(intersection.edgeB);
+        return nullptr;
+    }
 
-    int regionId = generateNextId();
-    Region *region = new Region(regionId, RegionType::TaskRegion);
+    Region *region = m_regions.create(RegionType::TaskRegion);
+    int regionId = region->id();
     region->setVertices(vertices);
     region->setTerrainType(TerrainType::Plain);  // 默认平原
     region->setTaskRegionShape(TaskRegionShape::Polygon);  // 默认多边形
 
-    // 计算中心点
-    double sumLat = 0.0, sumLon = 0.0;
-    for (const auto &coord : vertices) {
-        sumLat += coord.first;
-        sumLon += coord.second;
-    }
-    region->setCoordinate(QMapLibre::Coordinate(
-        sumLat / vertices.size(),
-        sumLon / vertices.size()
-    ));
+    // 中心点取派生几何中的质心（同时完成几何缓存的计算）
+    region->setCoordinate(region->geometry().centroid);
 
     // 先在地图上绘制（让用户看到位置）
     drawRegion(region);
@@ -167,15 +152,13 @@ Region* RegionManager::createTaskRegion(const QMapLibre::Coordinates &vertices,
     // 如果没有指定名称，生成默认名称并弹出对话框
     QString regionName;
     if (name.isEmpty()) {
-        QString defaultName = generateDefaultName(RegionType::TaskRegion, regionId);
+        QString defaultName = generateDefaultName(RegionType::TaskRegion, region->number());
         regionName = promptForName(defaultName);
 
         // 用户取消了命名，撤销创建（删除已绘制的标注）
         if (regionName.isEmpty()) {
-            if (region->annotationId() != 0) {
-                m_painter->removeAnnotation(region->annotationId());
-            }
-            delete region;
+            removeRegionAnnotation(region);
+            m_regions.destroy(regionId);
             qDebug() << "用户取消创建任务区域";
             return nullptr;
         }
@@ -184,10 +167,13 @@ Region* RegionManager::createTaskRegion(const QMapLibre::Coordinates &vertices,
     }
     region->setName(regionName);
 
-    // 存储
-    m_regions.insert(regionId, region);
+    // 加入空间索引
+    indexRegion(region);
 
     emit regionCreated(regionId);
+    m_pendingChanges.addCreated(regionId);
+    markSnapshotDirty(regionId);
+    scheduleChangeFlush();
     qDebug() << "创建多边形: ID =" << regionId << ", 顶点数 =" << vertices.size();
 
     return region;
@@ -195,18 +181,13 @@ Region* RegionManager::createTaskRegion(const QMapLibre::Coordinates &vertices,
 
 Region* RegionManager::createCircularTaskRegion(const QMapLibre::Coordinate &center, double radius,
                                                 const QMapLibre::Coordinates &vertices, const QString &name) {
-    if (!m_painter) {
-        qWarning() << "RegionManager::createCircularTaskRegion: painter is null!";
-        return nullptr;
-    }
-
     if (vertices.size() < 3) {
         qWarning() << "RegionManager::createCircularTaskRegion: 顶点数不足（至少需要3个）";
         return nullptr;
     }
 
-    int regionId = generateNextId();
-    Region *region = new Region(regionId, RegionType::TaskRegion);
+    Region *region = m_regions.create(RegionType::TaskRegion);
+    int regionId = region->id();
     region->setVertices(vertices);
     region->setCoordinate(center);  // 使用传入的圆心
     region->setRadius(radius);      // 保存半径信息
@@ -219,15 +200,13 @@ Region* RegionManager::createCircularTaskRegion(const QMapLibre::Coordinate &cen
     // 如果没有指定名称，生成默认名称并弹出对话框
     QString regionName;
     if (name.isEmpty()) {
-        QString defaultName = generateDefaultName(RegionType::TaskRegion, regionId);
+        QString defaultName = generateDefaultName(RegionType::TaskRegion, region->number());
         regionName = promptForName(defaultName);
 
         // 用户取消了命名，撤销创建（删除已绘制的标注）
         if (regionName.isEmpty()) {
-            if (region->annotationId() != 0) {
-                m_painter->removeAnnotation(region->annotationId());
-            }
-            delete region;
+            removeRegionAnnotation(region);
+            m_regions.destroy(regionId);
             qDebug() << "用户取消创建圆形任务区域";
             return nullptr;
         }
@@ -236,42 +215,32 @@ Region* RegionManager::createCircularTaskRegion(const QMapLibre::Coordinate &cen
     }
     region->setName(regionName);
 
-    // 存储
-    m_regions.insert(regionId, region);
+    // 加入空间索引
+    indexRegion(region);
 
     emit regionCreated(regionId);
+    m_pendingChanges.addCreated(regionId);
+    markSnapshotDirty(regionId);
+    scheduleChangeFlush();
     qDebug() << "创建圆形任务区域: ID =" << regionId << ", 半径 =" << radius << "米, 顶点数 =" << vertices.size();
 
     return region;
 }
 
 Region* RegionManager::createRectangularTaskRegion(const QMapLibre::Coordinates &vertices, const QString &name) {
-    if (!m_painter) {
-        qWarning() << "RegionManager::createRectangularTaskRegion: painter is null!";
-        return nullptr;
-    }
-
     if (vertices.size() != 4) {
         qWarning() << "RegionManager::createRectangularTaskRegion: 矩形必须有4个顶点";
         return nullptr;
     }
 
-    int regionId = generateNextId();
-    Region *region = new Region(regionId, RegionType::TaskRegion);
+    Region *region = m_regions.create(RegionType::TaskRegion);
+    int regionId = region->id();
     region->setVertices(vertices);
     region->setTerrainType(TerrainType::Plain);  // 默认平原
     region->setTaskRegionShape(TaskRegionShape::Rectangle);  // 矩形
 
-    // 计算中心点
-    double sumLat = 0.0, sumLon = 0.0;
-    for (const auto &coord : vertices) {
-        sumLat += coord.first;
-        sumLon += coord.second;
-    }
-    region->setCoordinate(QMapLibre::Coordinate(
-        sumLat / vertices.size(),
-        sumLon / vertices.size()
-    ));
+    // 中心点取派生几何中的质心（同时完成几何缓存的计算）
+    region->setCoordinate(region->geometry().centroid);
 
     // 先在地图上绘制（让用户看到位置）
     drawRegion(region);
@@ -279,15 +248,13 @@ Region* RegionManager::createRectangularTaskRegion(const QMapLibre::Coordinates
     // 如果没有指定名称，生成默认名称并弹出对话框
     QString regionName;
     if (name.isEmpty()) {
-        QString defaultName = generateDefaultName(RegionType::TaskRegion, regionId);
+        QString defaultName = generateDefaultName(RegionType::TaskRegion, region->number());
         regionName = promptForName(defaultName);
 
         // 用户取消了命名，撤销创建（删除已绘制的标注）
         if (regionName.isEmpty()) {
-            if (region->annotationId() != 0) {
-                m_painter->removeAnnotation(region->annotationId());
-            }
-            delete region;
+            removeRegionAnnotation(region);
+            m_regions.destroy(regionId);
             qDebug() << "用户取消创建矩形任务区域";
             return nullptr;
         }
@@ -296,21 +263,275 @@ Region* RegionManager::createRectangularTaskRegion(const QMapLibre::Coordinates
     }
     region->setName(regionName);
 
-    // 存储
-    m_regions.insert(regionId, region);
+    // 加入空间索引
+    indexRegion(region);
 
     emit regionCreated(regionId);
+    m_pendingChanges.addCreated(regionId);
+    markSnapshotDirty(regionId);
+    scheduleChangeFlush();
     qDebug() << "创建矩形任务区域: ID =" << regionId << ", 顶点数 =" << vertices.size();
 
     return region;
 }
 
+QVector<int> RegionManager::createRegions(const QVector<RegionSpec> &specs) {
+    QVector<int> regionIds(specs.size(), 0);
+
+    ChangeScope scope(this);
+
+    // 先分配所有区域并填充属性，暂不绘制
+    QVector<Region*> created;
+    created.reserve(specs.size());
+    for (int i = 0; i < specs.size(); ++i) {
+        const RegionSpec &spec = specs[i];
+        QString error;
+        if (!validateSpec(spec, &error)) {
+            qWarning() << QString("RegionManager::createRegions: 第 %1 个区域无效（%2），已跳过").arg(i).arg(error);
+            continue;
+        }
+
+        Region *region = m_regions.create(spec.type);
+        region->setName(spec.name.isEmpty() ? generateDefaultName(spec.type, region->number()) : spec.name);
+        region->setTerrainType(spec.terrainType);
+        region->setVisible(spec.visible);
+
+        switch (spec.type) {
+            case RegionType::LoiterPoint:
+                region->setCoordinate(spec.coordinate);
+                break;
+
+            case RegionType::UAV:
+                region->setCoordinate(spec.coordinate);
+                region->setColor(spec.color);
+                break;
+
+            case RegionType::NoFlyZone:
+                region->setCoordinate(spec.coordinate);
+                region->setRadius(spec.radius);
+                break;
+
+            case RegionType::TaskRegion:
+                region->setVertices(spec.vertices);
+                region->setTaskRegionShape(spec.shape);
+                if (spec.shape == TaskRegionShape::Circle) {
+                    region->setCoordinate(spec.coordinate);
+                    region->setRadius(spec.radius);
+                } else {
+                    // 多边形/矩形以质心作为中心点
+                    region->setCoordinate(region->geometry().centroid);
+                }
+                break;
+        }
+
+        regionIds[i] = region->id();
+        created.append(region);
+    }
+
+    if (created.isEmpty()) {
+        return regionIds;
+    }
+
+    // 一次提交绘制，再统一建立空间索引
+    drawRegions(created);
+    for (Region *region : created) {
+        indexRegion(region);
+    }
+
+    for (const Region *region : created) {
+        emit regionCreated(region->id());
+        m_pendingChanges.addCreated(region->id());
+        markSnapshotDirty(region->id());
+    }
+    qDebug() << "批量创建区域: 成功" << created.size() << "个, 跳过" << (specs.size() - created.size()) << "个";
+
+    return regionIds;
+}
+
+RegionSpec RegionManager::specOf(const Region *region) {
+    RegionSpec spec;
+    spec.type = region->type();
+    spec.name = region->name();
+    spec.coordinate = region->coordinate();
+    spec.vertices = region->vertices();
+    spec.radius = region->radius();
+    spec.color = region->color();
+    spec.shape = region->taskRegionShape();
+    spec.terrainType = region->terrainType();
+    spec.visible = region->isVisible();
+    return spec;
+}
+
+bool RegionManager::validateSpec(const RegionSpec &spec, QString *error) {
+    auto fail = [error](const QString &reason) {
+        if (error) {
+            *error = reason;
+        }
+        return false;
+    };
+    auto validCoordinate = [](const QMapLibre::Coordinate &coord) {
+        return qIsFinite(coord.first) && qIsFinite(coord.second)
+            && qAbs(coord.first) <= 90.0 && qAbs(coord.second) <= 180.0;
+    };
+
+    switch (spec.type) {
+        case RegionType::LoiterPoint:
+        case RegionType::UAV:
+            if (!validCoordinate(spec.coordinate)) {
+                return fail("坐标无效");
+            }
+            return true;
+
+        case RegionType::NoFlyZone:
+            if (!validCoordinate(spec.coordinate)) {
+                return fail("圆心坐标无效");
+            }
+            if (!qIsFinite(spec.radius) || spec.radius <= 0.0) {
+                return fail("半径必须大于0");
+            }
+            return true;
+
+        case RegionType::TaskRegion:
+            if (spec.vertices.size() < 3) {
+                return fail("顶点数不足（至少需要3个）");
+            }
+            if (spec.shape == TaskRegionShape::Rectangle && spec.vertices.size() != 4) {
+                return fail("矩形必须有4个顶点");
+            }
+            for (const auto &coord : spec.vertices) {
+                if (!validCoordinate(coord)) {
+                    return fail("顶点坐标无效");
+                }
+            }
+            if (spec.shape != TaskRegionShape::Circle && !PolygonValidator::isSimple(spec.vertices)) {
+                return fail("多边形自相交");
+            }
+            if (spec.shape == TaskRegionShape::Circle
+                && (!validCoordinate(spec.coordinate) || !qIsFinite(spec.radius) || spec.radius <= 0.0)) {
+                return fail("圆形任务区域的圆心或半径无效");
+            }
+            return true;
+    }
+    return fail("未知区域类型");
+}
+
+QVector<RegionSpec> RegionManager::repairSelfIntersecting(const QVector<RegionSpec> &specs, QStringList *notes) {
+    QVector<RegionSpec> result;
+    result.reserve(specs.size());
+    for (const RegionSpec &spec : specs) {
+        if (spec.type != RegionType::TaskRegion || spec.shape == TaskRegionShape::Circle
+            || spec.vertices.size() < 3 || PolygonValidator::isSimple(spec.vertices)) {
+            result.append(spec);
+            continue;
+        }
+
+        int unrepaired = 0;
+        const QVector<QMapLibre::Coordinates> parts = PolygonValidator::repair(spec.vertices, &unrepaired);
+        for (int i = 0; i < parts.size(); ++i) {
+            RegionSpec part = spec;
+            part.shape = TaskRegionShape::Polygon;
+            part.vertices = parts[i];
+            if (parts.size() > 1 && !spec.name.isEmpty()) {
+                part.name = QString("%1-%2").arg(spec.name).arg(i + 1);
+            }
+            result.append(part);
+        }
+
+        QString name = spec.name.isEmpty() ? QString("（未命名）") : spec.name;
+        QString note;
+        if (parts.isEmpty()) {
+            note = QString("区域“%1”自相交且无法修复，已丢弃").arg(name);
+        } else if (unrepaired > 0) {
+            note = QString("区域“%1”自相交，已拆分为 %2 个区域，另有 %3 个部分无法修复已丢弃")
+                       .arg(name).arg(parts.size()).arg(unrepaired);
+        } else {
+            note = QString("区域“%1”自相交，已拆分为 %2 个区域").arg(name).arg(parts.size());
+        }
+        qWarning() << "RegionManager::repairSelfIntersecting:" << note;
+        if (notes) {
+            notes->append(note);
+        }
+    }
+    return result;
+}
+
+// ==================== 变化事务 ====================
+
+void RegionManager::beginChanges() {
+    ++m_changeDepth;
+}
+
+void RegionManager::endChanges() {
+    if (m_changeDepth == 0) {
+        qWarning() << "RegionManager::endChanges: 没有进行中的变化事务";
+        return;
+    }
+    if (--m_changeDepth == 0) {
+        flushChanges();
+    }
+}
+
+void RegionManager::scheduleChangeFlush() {
+    if (m_changeDepth > 0 || m_changeFlushPending) {
+        return;
+    }
+
+    m_changeFlushPending = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_changeFlushPending = false;
+        flushChanges();
+    });
+}
+
+void RegionManager::flushChanges() {
+    if (m_changeDepth > 0 || m_pendingChanges.isEmpty()) {
+        return;
+    }
+
+    // 先取出再发出，槽函数中产生的新变化进入下一批
+    RegionChangeSet changes = m_pendingChanges;
+    m_pendingChanges.clear();
+    emit regionsChanged(changes);
+}
+
+// ==================== 快照 ====================
+
+RegionSnapshot RegionManager::snapshot() {
+    // 第一次获取快照时整体发布；之后只重新发布变化过的区域，其余记录继续共享
+    if (m_snapshotVersion == 0) {
+        m_published.reserve(m_regions.size());
+        for (const Region *region : m_regions) {
+            m_published.insert(region->id(), specOf(region));
+        }
+        m_snapshotDirty.clear();
+        ++m_snapshotVersion;
+    } else if (!m_snapshotDirty.isEmpty()) {
+        for (int regionId : m_snapshotDirty) {
+            if (const Region *region = m_regions.get(regionId)) {
+                m_published.insert(regionId, specOf(region));
+            } else {
+                m_published.remove(regionId);
+            }
+        }
+        m_snapshotDirty.clear();
+        ++m_snapshotVersion;
+    }
+    return RegionSnapshot(m_published, m_snapshotVersion);
+}
+
+void RegionManager::markSnapshotDirty(int regionId) {
+    // 还没有人获取过快照时不必记录，第一次快照会整体发布
+    if (m_snapshotVersion > 0) {
+        m_snapshotDirty.insert(regionId);
+    }
+}
+
 // ==================== 删除区域 ====================
 
 bool RegionManager::removeRegion(int regionId) {
     qDebug() << "RegionManager::removeRegion 开始删除区域 ID:" << regionId;
 
-    Region *region = m_regions.value(regionId, nullptr);
+    Region *region = m_regions.get(regionId);
     if (!region) {
         qWarning() << "RegionManager::removeRegion: 区域不存在, ID =" << regionId;
         return false;
@@ -321,26 +542,27 @@ bool RegionManager::removeRegion(int regionId) {
     qDebug() << "  - 区域类型:" << Region::typeToString(region->type());
     qDebug() << "  - AnnotationID:" << annotationId;
 
-    // 从地图移除标注
-    if (m_painter) {
-        qDebug() << "  - 调用 MapPainter::removeAnnotation(" << annotationId << ")";
-        m_painter->removeAnnotation(annotationId);
-    } else {
-        qWarning() << "  - 无法删除标注: painter is null";
-    }
+    emit regionAboutToBeRemoved(regionId);
+
+    // 从地图移除标注（无渲染器时没有标注）
+    qDebug() << "  - 移除地图标注(" << annotationId << ")";
+    removeRegionAnnotation(region);
 
-    // 从映射表删除
-    m_regions.remove(regionId);
-    qDebug() << "  - 已从 m_regions 中移除";
+    // 从空间索引删除
+    m_spatialIndex.remove(regionId);
 
     // 发出信号（让 TaskManager 清理引用）
     emit regionRemoved(regionId);
+    m_pendingChanges.addRemoved(regionId);
+    markSnapshotDirty(regionId);
+    scheduleChangeFlush();
     qDebug() << "  - 已发送 regionRemoved 信号";
 
-    qDebug() << "RegionManager::removeRegion 完成删除区域 ID:" << regionId;
+    // 回收槽位（旧ID随即失效）
+    m_regions.destroy(regionId);
+    qDebug() << "  - 已从对象池中移除";
 
-    // 释放内存
-    delete region;
+    qDebug() << "RegionManager::removeRegion 完成删除区域 ID:" << regionId;
 
     return true;
 }
@@ -348,127 +570,177 @@ bool RegionManager::removeRegion(int regionId) {
 // ==================== 查询 ====================
 
 Region* RegionManager::getRegion(int regionId) {
-    return m_regions.value(regionId, nullptr);
+    return m_regions.get(regionId);
 }
 
 Region* RegionManager::findRegionByAnnotationId(QMapLibre::AnnotationID annotationId) {
-    for (Region *region : m_regions) {
-        if (region->annotationId() == annotationId) {
-            return region;
-        }
+    if (annotationId == 0) {
+        return nullptr;
     }
-    return nullptr;
+    return m_regions.get(m_annotationToRegion.value(annotationId, 0));
 }
 
 Region* RegionManager::findRegionNear(const QMapLibre::Coordinate &clickCoord, double threshold) {
-    if (!m_painter) {
+    if (!m_renderer) {
         return nullptr;
     }
 
-    // 使用 MapPainter 的查找功能
-    const RegionInfo *regionInfo = m_painter->findRegionNear(clickCoord, threshold);
-    if (!regionInfo) {
+    // 使用渲染器的查找功能
+    QMapLibre::AnnotationID annotationId = m_renderer->findRegionNear(clickCoord, threshold);
+    if (annotationId == 0) {
         return nullptr;
     }
 
     // 通过 annotationId 查找区域
-    return findRegionByAnnotationId(regionInfo->annotationId);
+    return findRegionByAnnotationId(annotationId);
 }
 
-const RegionInfo* RegionManager::findRegionInfoNear(const QMapLibre::Coordinate &clickCoord, double threshold) const {
-    if (!m_painter) {
-        return nullptr;
+bool RegionManager::findRegionInfoAtPixel(const QPointF &pixel, double tolerance, RegionInfo &info) const {
+    if (!m_renderer) {
+        return false;
+    }
+
+    // 委托给渲染器在屏幕空间查找，再取出区域信息
+    QMapLibre::AnnotationID annotationId = m_renderer->findRegionAtPixel(pixel, tolerance);
+    if (annotationId == 0) {
+        return false;
     }
 
-    // 直接委托给 MapPainter
-    return m_painter->findRegionNear(clickCoord, threshold);
+    info = m_renderer->regionInfo(annotationId);
+    return true;
+}
+
+QVector<Region*> RegionManager::queryRegions(const GeoBounds &area) const {
+    QVector<Region*> result;
+    visitRegions(area, [&result](Region *region) {
+        result.append(region);
+        return true;
+    });
+    return result;
 }
 
 // ==================== 可见性控制 ====================
 
 void RegionManager::showRegion(int regionId) {
-    Region *region = m_regions.value(regionId, nullptr);
-    if (!region || !m_painter) {
-        return;
-    }
-
-    // 如果已经在地图上，先移除
-    if (region->annotationId() != 0) {
-        m_painter->removeAnnotation(region->annotationId());
-    }
-
-    // 重新绘制
-    drawRegion(region);
+    setRegionsVisible(QVector<int>{regionId}, true);
 }
 
 void RegionManager::hideRegion(int regionId) {
-    Region *region = m_regions.value(regionId, nullptr);
-    if (!region || !m_painter) {
-        return;
+    setRegionsVisible(QVector<int>{regionId}, false);
+}
+
+void RegionManager::setRegionsVisible(const QVector<int> &regionIds, bool visible) {
+    // 已有标注的只切换显示标记，尚未绘制的（显示时）补画，整批各只提交一次；
+    // 没有渲染器时只切换区域自身的显示标记
+    ChangeScope scope(this);
+    QVector<Region*> changed;
+    QVector<Region*> undrawn;
+    QVector<QMapLibre::AnnotationID> annotationIds;
+    for (int regionId : regionIds) {
+        Region *region = m_regions.get(regionId);
+        if (!region) {
+            continue;
+        }
+        bool needsDraw = m_renderer && visible && region->annotationId() == 0;
+        if (region->isVisible() == visible && !needsDraw) {
+            continue;
+        }
+
+        region->setVisible(visible);
+        if (needsDraw) {
+            undrawn.append(region);
+        } else {
+            annotationIds.append(region->annotationId());
+        }
+        changed.append(region);
     }
 
-    // 从地图移除
-    if (region->annotationId() != 0) {
-        m_painter->removeAnnotation(region->annotationId());
-        region->setAnnotationId(0);  // 标记为未绘制
+    if (m_renderer) {
+        m_renderer->setAnnotationsVisible(annotationIds, visible);
+        drawRegions(undrawn);
     }
+
+    for (Region *region : changed) {
+        emit regionVisibilityChanged(region->id());
+        m_pendingChanges.addVisibilityChanged(region->id());
+        markSnapshotDirty(region->id());
+    }
+    scheduleChangeFlush();
 }
 
 void RegionManager::showAllRegions() {
+    QVector<int> regionIds;
+    regionIds.reserve(m_regions.size());
     for (Region *region : m_regions) {
-        showRegion(region->id());
+        regionIds.append(region->id());
     }
+    setRegionsVisible(regionIds, true);
 }
 
 void RegionManager::hideAllRegions() {
+    QVector<int> regionIds;
+    regionIds.reserve(m_regions.size());
     for (Region *region : m_regions) {
-        hideRegion(region->id());
+        regionIds.append(region->id());
     }
+    setRegionsVisible(regionIds, false);
 }
 
 // ==================== 修改属性 ====================
 
 bool RegionManager::updateRegionTerrainType(int regionId, Region::TerrainType type) {
-    Region *region = m_regions.value(regionId, nullptr);
+    Region *region = m_regions.get(regionId);
     if (!region) {
         return false;
     }
 
+    emit regionAboutToBeUpdated(regionId);
     region->setTerrainType(type);
     emit regionUpdated(regionId);
+    m_pendingChanges.addUpdated(regionId);
+    markSnapshotDirty(regionId);
+    scheduleChangeFlush();
 
     qDebug() << "更新区域地形: ID =" << regionId << ", 地形 =" << Region::terrainTypeToString(type);
     return true;
 }
 
 bool RegionManager::updateRegionColor(int regionId, const QString &color) {
-    Region *region = m_regions.value(regionId, nullptr);
+    Region *region = m_regions.get(regionId);
     if (!region || region->type() != RegionType::UAV) {
         return false;
     }
 
+    emit regionAboutToBeUpdated(regionId);
     region->setColor(color);
 
     // 重新绘制（更新颜色）
-    if (m_painter && region->annotationId() != 0) {
-        m_painter->removeAnnotation(region->annotationId());
+    if (m_renderer && region->annotationId() != 0) {
+        removeRegionAnnotation(region);
         drawRegion(region);
     }
 
     emit regionUpdated(regionId);
+    m_pendingChanges.addUpdated(regionId);
+    markSnapshotDirty(regionId);
+    scheduleChangeFlush();
 
     qDebug() << "更新无人机颜色: ID =" << regionId << ", 颜色 =" << color;
     return true;
 }
 
 bool RegionManager::updateRegionName(int regionId, const QString &name) {
-    Region *region = m_regions.value(regionId, nullptr);
+    Region *region = m_regions.get(regionId);
     if (!region) {
         return false;
     }
 
+    emit regionAboutToBeUpdated(regionId);
     region->setName(name);
     emit regionUpdated(regionId);
+    m_pendingChanges.addUpdated(regionId);
+    markSnapshotDirty(regionId);
+    scheduleChangeFlush();
 
     qDebug() << "更新区域名称: ID =" << regionId << ", 名称 =" << name;
     return true;
@@ -476,12 +748,28 @@ bool RegionManager::updateRegionName(int regionId, const QString &name) {
 
 // ==================== 私有方法 ====================
 
-int RegionManager::generateNextId() {
-    return m_nextId++;
+void RegionManager::setRegionAnnotation(Region *region, QMapLibre::AnnotationID annotationId) {
+    if (region->annotationId() != 0) {
+        m_annotationToRegion.remove(region->annotationId());
+    }
+    region->setAnnotationId(annotationId);
+    if (annotationId != 0) {
+        m_annotationToRegion.insert(annotationId, region->id());
+    }
+}
+
+void RegionManager::removeRegionAnnotation(Region *region) {
+    if (region->annotationId() == 0) {
+        return;
+    }
+    if (m_renderer) {
+        m_renderer->removeAnnotation(region->annotationId());
+    }
+    setRegionAnnotation(region, 0);
 }
 
 void RegionManager::drawRegion(Region *region) {
-    if (!m_painter || !region) {
+    if (!m_renderer || !region) {
         return;
     }
 
@@ -489,14 +777,14 @@ void RegionManager::drawRegion(Region *region) {
 
     switch (region->type()) {
         case RegionType::LoiterPoint:
-            annotationId = m_painter->drawLoiterPoint(
+            annotationId = m_renderer->drawLoiterPoint(
                 region->coordinate().first,
                 region->coordinate().second
             );
             break;
 
         case RegionType::UAV:
-            annotationId = m_painter->drawUAV(
+            annotationId = m_renderer->drawUAV(
                 region->coordinate().first,
                 region->coordinate().second,
                 region->color()
@@ -504,7 +792,7 @@ void RegionManager::drawRegion(Region *region) {
             break;
 
         case RegionType::NoFlyZone:
-            annotationId = m_painter->drawNoFlyZone(
+            annotationId = m_renderer->drawNoFlyZone(
                 region->coordinate().first,
                 region->coordinate().second,
                 region->radius()
@@ -512,39 +800,76 @@ void RegionManager::drawRegion(Region *region) {
             break;
 
         case RegionType::TaskRegion:
-            annotationId = m_painter->drawTaskRegionArea(region->vertices(), region->coordinate(), region->radius(), region->taskRegionShape());
+            annotationId = m_renderer->drawTaskRegionArea(region->vertices(), region->coordinate(), region->radius(), region->taskRegionShape());
             break;
     }
 
-    region->setAnnotationId(annotationId);
+    setRegionAnnotation(region, annotationId);
+
+    // 隐藏状态下重新绘制（如修改颜色）时保持隐藏
+    if (annotationId != 0 && !region->isVisible()) {
+        m_renderer->setAnnotationVisible(annotationId, false);
+    }
+}
+
+void RegionManager::drawRegions(const QVector<Region*> &regions) {
+    if (!m_renderer || regions.isEmpty()) {
+        return;
+    }
+
+    QVector<RegionDrawSpec> specs;
+    specs.reserve(regions.size());
+    for (const Region *region : regions) {
+        RegionDrawSpec spec;
+        spec.type = region->type();
+        spec.coordinate = region->coordinate();
+        spec.vertices = region->vertices();
+        spec.radius = region->radius();
+        spec.color = region->color();
+        spec.shape = region->taskRegionShape();
+        spec.visible = region->isVisible();
+        specs.append(spec);
+    }
+
+    QVector<QMapLibre::AnnotationID> ids = m_renderer->drawRegions(specs);
+    for (int i = 0; i < regions.size(); ++i) {
+        setRegionAnnotation(regions[i], ids.value(i, 0));
+    }
+}
+
+void RegionManager::indexRegion(Region *region) {
+    if (!region) {
+        return;
+    }
+    m_spatialIndex.insert(region->id(), region->geometry().bounds);
 }
 
-QString RegionManager::generateDefaultName(RegionType type, int id)
+QString RegionManager::generateDefaultName(RegionType type, int number)
 {
     switch (type) {
         case RegionType::LoiterPoint:
-            return QString("盘旋点%1").arg(id);
+            return QString("盘旋点%1").arg(number);
         case RegionType::UAV:
-            return QString("无人机%1").arg(id);
+            return QString("无人机%1").arg(number);
         case RegionType::NoFlyZone:
-            return QString("禁飞区%1").arg(id);
+            return QString("禁飞区%1").arg(number);
         case RegionType::TaskRegion:
-            return QString("任务区域%1").arg(id);
+            return QString("任务区域%1").arg(number);
         default:
-            return QString("区域%1").arg(id);
+            return QString("区域%1").arg(number);
     }
 }
 
-QString RegionManager::promptForName(const QString &defaultName)
+void RegionManager::setNamePrompt(NamePrompt prompt)
 {
-    // 尝试获取父窗口（TaskUI）作为对话框的父窗口
-    QWidget *parentWidget = qobject_cast<QWidget*>(parent());
+    m_namePrompt = std::move(prompt);
+}
 
-    RegionPropertyDialog dialog(defaultName, parentWidget);
-    if (dialog.exec() == QDialog::Accepted) {
-        QString name = dialog.getRegionName().trimmed();
-        return name.isEmpty() ? defaultName : name;
+QString RegionManager::promptForName(const QString &defaultName)
+{
+    // 没有设置命名回调（无界面模式）时直接使用默认名称
+    if (!m_namePrompt) {
+        return defaultName;
     }
-    // 用户取消，返回空字符串表示取消操作
-    return QString();
+    return m_namePrompt(defaultName);
 }
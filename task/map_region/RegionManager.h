@@ -5,9 +5,15 @@
 #define REGIONMANAGER_H
 
 #include "Region.h"
-#include "MapPainter.h"
+#include "RegionRenderer.h"
+#include "SpatialIndex.h"
+#include "RegionArena.h"
+#include "RegionChangeSet.h"
+#include "RegionSnapshot.h"
 #include <QObject>
-#include <QMap>
+#include <QHash>
+#include <QStringList>
+#include <functional>
 
 /**
  * @brief 区域管理器 - 管理所有地图标记区域（独立于任务）
@@ -16,7 +22,14 @@
  * - 创建和删除区域（Region）
  * - 在地图上绘制和移除区域
  * - 提供区域的查询接口
- * - 管理区域的可见性
+ * - 管理区域的可见性（隐藏时保留地图标注，只切换显示标记）
+ *
+ * 变化通知分两级：regionCreated/regionRemoved 等逐个信号立即发出，供需要同步清理引用的
+ * 对象使用；regionsChanged 把一次事务（beginChanges/endChanges 之间）或一次事件循环内的
+ * 变化去重合并后只发出一次，界面刷新应监听它。
+ *
+ * 不依赖 Widgets 和地图：绘制通过 RegionRenderer 接口（可为空，即无界面模式），
+ * 交互式创建时的命名对话框通过 setNamePrompt 注入。
  *
  * 注意：RegionManager 拥有所有 Region 的所有权
  */
@@ -24,9 +37,26 @@ class RegionManager : public QObject {
     Q_OBJECT
 
 public:
-    explicit RegionManager(MapPainter *painter, QObject *parent = nullptr);
+    /**
+     * @brief 构造函数
+     * @param renderer 区域渲染器（不拥有所有权；为 nullptr 时不绘制到地图）
+     * @param parent 父对象
+     */
+    explicit RegionManager(RegionRenderer *renderer, QObject *parent = nullptr);
     ~RegionManager();
 
+    /**
+     * @brief 命名回调：参数为默认名称，返回用户输入的名称，返回空字符串表示取消创建
+     */
+    using NamePrompt = std::function<QString(const QString &defaultName)>;
+
+    /**
+     * @brief 设置交互式创建区域（create* 未指定名称）时的命名回调
+     *
+     * 未设置时直接使用默认名称，不会弹出任何界面。
+     */
+    void setNamePrompt(NamePrompt prompt);
+
     // ==================== 创建区域 ====================
 
     /**
@@ -60,9 +90,9 @@ public:
 
     /**
      * @brief 创建任务区域（多边形）
-     * @param vertices 任务区域顶点
+     * @param vertices 任务区域顶点（必须是简单多边形，可先用 PolygonValidator::repair 拆分）
      * @param name 区域名称（可选）
-     * @return 创建的区域指针
+     * @return 创建的区域指针，顶点不足或多边形自相交时返回 nullptr
      */
     Region* createTaskRegion(const QMapLibre::Coordinates &vertices, const QString &name = QString());
 
@@ -85,6 +115,77 @@ public:
      */
     Region* createRectangularTaskRegion(const QMapLibre::Coordinates &vertices, const QString &name = QString());
 
+    /**
+     * @brief 批量创建区域（无交互：不弹出命名对话框，名称为空时使用默认名称）
+     *
+     * 先校验全部参数，再统一分配ID、一次提交给渲染器 绘制，
+     * 整批作为一个事务，只产生一次 regionsChanged 通知。
+     *
+     * @param specs 区域创建参数列表
+     * @return 与 specs 一一对应的区域ID，参数无效的位置为 0
+     */
+    QVector<int> createRegions(const QVector<RegionSpec> &specs);
+
+    /**
+     * @brief 校验区域创建参数
+     * @param spec 区域创建参数
+     * @param error 输出：无效原因（可为 nullptr）
+     * @return 有效返回 true
+     */
+    static bool validateSpec(const RegionSpec &spec, QString *error = nullptr);
+
+    /**
+     * @brief 修复自相交的多边形/矩形任务区域参数（导入旧文件用：早期版本允许保存自相交多边形）
+     *
+     * 自相交的区域按 PolygonValidator::repair 在交点处拆分为若干个多边形区域（名称加 -1、-2 后缀），
+     * 完全无法修复的丢弃；其他参数原样保留。
+     * @param specs 区域创建参数列表
+     * @param notes 输出：每个被拆分或丢弃的区域追加一条说明（可为 nullptr）
+     * @return 修复后的参数列表（数量可能与 specs 不同）
+     */
+    static QVector<RegionSpec> repairSelfIntersecting(const QVector<RegionSpec> &specs, QStringList *notes = nullptr);
+
+    /**
+     * @brief 由现有区域生成创建参数（用于撤销删除、复制等按原样重建区域）
+     */
+    static RegionSpec specOf(const Region *region);
+
+    // ==================== 变化事务 ====================
+
+    /**
+     * @brief 开始一个变化事务（可嵌套），事务内的变化在最外层 endChanges 时合并发出
+     */
+    void beginChanges();
+
+    /**
+     * @brief 结束变化事务，最外层结束时立即发出合并后的 regionsChanged
+     */
+    void endChanges();
+
+    /**
+     * @brief 变化事务作用域（构造时 beginChanges，析构时 endChanges）
+     */
+    class ChangeScope {
+    public:
+        explicit ChangeScope(RegionManager *manager) : m_manager(manager) { m_manager->beginChanges(); }
+        ~ChangeScope() { m_manager->endChanges(); }
+        ChangeScope(const ChangeScope &) = delete;
+        ChangeScope &operator=(const ChangeScope &) = delete;
+
+    private:
+        RegionManager *m_manager;
+    };
+
+    // ==================== 快照 ====================
+
+    /**
+     * @brief 获取所有区域的只读快照（隐式共享，可交给工作线程读取）
+     *
+     * 只需重新发布上次快照之后变化过的区域，之后复制共享的发布表，开销与区域总数无关。
+     * @return 区域快照
+     */
+    RegionSnapshot snapshot();
+
     // ==================== 删除区域 ====================
 
     /**
@@ -105,12 +206,12 @@ public:
 
     /**
      * @brief 获取所有区域
-     * @return 区域映射表（regionId -> Region*）
+     * @return 区域对象池（可直接 for (Region *region : ...) 遍历）
      */
-    const QMap<int, Region*>& getAllRegions() const { return m_regions; }
+    const RegionArena& getAllRegions() const { return m_regions; }
 
     /**
-     * @brief 通过地图标注ID查找区域
+     * @brief 通过地图标注ID查找区域（哈希反查，O(1)）
      * @param annotationId 地图标注ID
      * @return 区域指针，不存在返回 nullptr
      */
@@ -125,12 +226,32 @@ public:
     Region* findRegionNear(const QMapLibre::Coordinate &clickCoord, double threshold = 100.0);
 
     /**
-     * @brief 查找点击位置附近的区域（返回 RegionInfo）
-     * @param clickCoord 点击坐标
-     * @param threshold 距离阈值（米）
-     * @return 区域信息指针，不存在返回 nullptr
+     * @brief 查找屏幕位置处的区域（像素空间命中测试，返回 RegionInfo）
+     * @param pixel 屏幕位置（地图控件坐标，像素）
+     * @param tolerance 容差（像素）
+     * @param info 输出：区域信息
+     * @return 找到返回 true
+     */
+    bool findRegionInfoAtPixel(const QPointF &pixel, double tolerance, RegionInfo &info) const;
+
+    /**
+     * @brief 查询包围盒与指定范围相交的区域（空间索引粗筛，调用方需再做精确判断）
+     * @param area 查询范围
+     * @return 候选区域列表
+     */
+    QVector<Region*> queryRegions(const GeoBounds &area) const;
+
+    /**
+     * @brief 遍历包围盒与指定范围相交的区域
+     * @param visitor 形如 bool(Region *region)，返回 false 时停止遍历
      */
-    const RegionInfo* findRegionInfoNear(const QMapLibre::Coordinate &clickCoord, double threshold = 100.0) const;
+    template<typename Visitor>
+    void visitRegions(const GeoBounds &area, Visitor &&visitor) const {
+        m_spatialIndex.visit(area, [&](int regionId, const GeoBounds &) {
+            Region *region = m_regions.get(regionId);
+            return region ? visitor(region) : true;
+        });
+    }
 
     // ==================== 可见性控制 ====================
 
@@ -146,6 +267,15 @@ public:
      */
     void hideRegion(int regionId);
 
+    /**
+     * @brief 批量显示/隐藏区域
+     *
+     * 只切换区域和地图标注的显示标记，不删除、不重新生成几何；整批只提交一次给渲染器。
+     * @param regionIds 区域ID列表
+     * @param visible 是否显示
+     */
+    void setRegionsVisible(const QVector<int> &regionIds, bool visible);
+
     /**
      * @brief 显示所有区域
      */
@@ -189,49 +319,119 @@ signals:
      */
     void regionCreated(int regionId);
 
+    /**
+     * @brief 区域即将删除信号（区域仍可查询）
+     * @param regionId 区域ID
+     */
+    void regionAboutToBeRemoved(int regionId);
+
     /**
      * @brief 区域删除信号
      * @param regionId 区域ID
      */
     void regionRemoved(int regionId);
 
+    /**
+     * @brief 区域属性即将修改信号（可读取修改前的值）
+     * @param regionId 区域ID
+     */
+    void regionAboutToBeUpdated(int regionId);
+
     /**
      * @brief 区域更新信号
      * @param regionId 区域ID
      */
     void regionUpdated(int regionId);
 
-private:
     /**
-     * @brief 生成下一个区域ID
+     * @brief 区域显示/隐藏信号
+     * @param regionId 区域ID
      */
-    int generateNextId();
+    void regionVisibilityChanged(int regionId);
 
+    /**
+     * @brief 合并后的区域变化信号（事务结束时或下一次事件循环中发出，每批只发一次）
+     * @param changes 去重后的变化集合
+     */
+    void regionsChanged(const RegionChangeSet &changes);
+
+private:
     /**
      * @brief 在地图上绘制区域
      * @param region 区域指针
      */
     void drawRegion(Region *region);
 
+    /**
+     * @brief 设置区域的地图标注ID，同时维护标注ID -> 区域ID 反查表
+     * @param region 区域指针
+     * @param annotationId 新的标注ID（0 表示未绘制）
+     */
+    void setRegionAnnotation(Region *region, QMapLibre::AnnotationID annotationId);
+
+    /**
+     * @brief 从地图移除区域的标注并清除反查表中的记录
+     * @param region 区域指针
+     */
+    void removeRegionAnnotation(Region *region);
+
+    /**
+     * @brief 批量在地图上绘制区域（一次提交给渲染器）
+     * @param regions 区域指针列表
+     */
+    void drawRegions(const QVector<Region*> &regions);
+
+    /**
+     * @brief 将区域加入空间索引（几何变化后重新调用即可更新）
+     * @param region 区域指针
+     */
+    void indexRegion(Region *region);
+
     /**
      * @brief 生成默认区域名称
      * @param type 区域类型
-     * @param id 区域ID
+     * @param number 区域显示编号（Region::number，不是区域ID）
      * @return 默认名称
      */
-    QString generateDefaultName(RegionType type, int id);
+    QString generateDefaultName(RegionType type, int number);
 
     /**
-     * @brief 弹出命名对话框让用户输入区域名称
+     * @brief 通过命名回调让用户输入区域名称
      * @param defaultName 默认名称
-     * @return 用户输入的名称（如果取消则返回默认名称）
+     * @return 用户输入的名称；取消时返回空字符串；未设置回调时返回默认名称
      */
     QString promptForName(const QString &defaultName);
 
+    /**
+     * @brief 安排在下一次事件循环中发出合并的变化（事务进行中时等事务结束）
+     */
+    void scheduleChangeFlush();
+
+    /**
+     * @brief 发出并清空待发送的变化
+     */
+    void flushChanges();
+
+    /**
+     * @brief 标记区域需要在下一次快照时重新发布
+     * @param regionId 区域ID
+     */
+    void markSnapshotDirty(int regionId);
+
 private:
-    MapPainter *m_painter;             // 地图绘制器（不拥有所有权）
-    QMap<int, Region*> m_regions;     // regionId -> Region*（拥有所有权）
-    int m_nextId;                     // 下一个区域ID
+    RegionRenderer *m_renderer;        // 区域渲染器（不拥有所有权，可为空）
+    NamePrompt m_namePrompt;           // 命名回调（可为空）
+    RegionArena m_regions;            // 区域对象池（拥有所有权，regionId 为代数句柄）
+    SpatialIndex m_spatialIndex;      // regionId -> 包围盒（空间索引）
+    QHash<QMapLibre::AnnotationID, int> m_annotationToRegion; // 标注ID -> regionId（点击反查）
+
+    RegionChangeSet m_pendingChanges;  // 尚未发出的合并变化
+    int m_changeDepth = 0;             // 变化事务嵌套深度
+    bool m_changeFlushPending = false; // 是否已安排下一次事件循环发出变化
+
+    RegionSnapshot::Map m_published;   // 已发布的区域参数（与快照隐式共享）
+    QSet<int> m_snapshotDirty;         // 上次快照之后变化过的区域ID
+    quint64 m_snapshotVersion = 0;     // 快照版本号
 };
 
 #endif // REGIONMANAGER_H
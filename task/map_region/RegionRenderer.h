@@ -0,0 +1,79 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef REGIONRENDERER_H
+#define REGIONRENDERER_H
+
+#include "MapRegionTypes.h"
+#include <QPointF>
+#include <QVector>
+
+/**
+ * @brief 区域渲染接口 - RegionManager 通过它在地图上绘制、隐藏和拾取区域
+ *
+ * 地图上的实现是 MapPainter（需要 QMapLibre::Map）。RegionManager 也可以不设置渲染器
+ * （传 nullptr），此时区域的创建、修改、索引和快照照常工作，只是没有地图标注，
+ * 用于无界面的工具、批处理和性能测试。
+ *
+ * 标注 ID 由渲染器分配，0 表示未绘制。
+ */
+class RegionRenderer {
+public:
+    virtual ~RegionRenderer() = default;
+
+    static constexpr double HIT_TOLERANCE_PX = 8.0;   // 默认拾取容差（像素）
+
+    // ==================== 绘制 ====================
+
+    virtual QMapLibre::AnnotationID drawLoiterPoint(double latitude, double longitude) = 0;
+    virtual QMapLibre::AnnotationID drawUAV(double latitude, double longitude, const QString &color = "black") = 0;
+    virtual QMapLibre::AnnotationID drawNoFlyZone(double latitude, double longitude, double radiusInMeters) = 0;
+    virtual QMapLibre::AnnotationID drawTaskRegionArea(const QMapLibre::Coordinates &coordinates,
+                                                       const QMapLibre::Coordinate &center = QMapLibre::Coordinate(),
+                                                       double radius = 0.0,
+                                                       TaskRegionShape shape = TaskRegionShape::Polygon) = 0;
+
+    /**
+     * @brief 批量绘制区域（等同于逐个调用 draw*，不要求实现合并成一次地图调用）
+     * @return 与 specs 一一对应的标注 ID，绘制失败的位置为 0
+     */
+    virtual QVector<QMapLibre::AnnotationID> drawRegions(const QVector<RegionDrawSpec> &specs) = 0;
+
+    virtual void removeAnnotation(QMapLibre::AnnotationID id) = 0;
+
+    // ==================== 显示/隐藏 ====================
+
+    /**
+     * @brief 批量显示/隐藏标注（只切换显示标记，不删除、不重新生成几何）
+     */
+    virtual void setAnnotationsVisible(const QVector<QMapLibre::AnnotationID> &ids, bool visible) = 0;
+
+    void setAnnotationVisible(QMapLibre::AnnotationID id, bool visible) {
+        setAnnotationsVisible(QVector<QMapLibre::AnnotationID>{id}, visible);
+    }
+
+    virtual bool isAnnotationVisible(QMapLibre::AnnotationID id) const = 0;
+
+    // ==================== 拾取 ====================
+
+    /**
+     * @brief 根据地理坐标查找最近的区域
+     * @param threshold 阈值距离（米）
+     * @return 标注 ID，未找到则返回 0
+     */
+    virtual QMapLibre::AnnotationID findRegionNear(const QMapLibre::Coordinate &clickCoord, double threshold = 100.0) const = 0;
+
+    /**
+     * @brief 根据屏幕位置查找区域
+     * @param tolerance 容差（像素）
+     * @return 标注 ID，未找到则返回 0
+     */
+    virtual QMapLibre::AnnotationID findRegionAtPixel(const QPointF &pixel, double tolerance = HIT_TOLERANCE_PX) const = 0;
+
+    /**
+     * @brief 获取标注对应的区域信息（标注不存在时 annotationId 为 0）
+     */
+    virtual RegionInfo regionInfo(QMapLibre::AnnotationID id) const = 0;
+};
+
+#endif // REGIONRENDERER_H
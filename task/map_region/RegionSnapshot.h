@@ -0,0 +1,71 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef REGIONSNAPSHOT_H
+#define REGIONSNAPSHOT_H
+
+#include "MapRegionTypes.h"
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+
+/**
+ * @brief 区域快照 - 某一时刻所有区域的只读副本
+ *
+ * 基于 Qt 隐式共享：获取快照只是复制一个共享指针（O(1)），快照之间以及快照与
+ * RegionManager 内部的发布表共享同一份数据；RegionManager 之后修改区域时才在自己
+ * 一侧分离（只复制 ID -> 区域参数 表，顶点等几何数据仍然共享），快照内容不受影响。
+ *
+ * 快照是值类型，可以复制后交给工作线程读取，无需加锁；不持有 Region 指针。
+ */
+class RegionSnapshot {
+public:
+    using Map = QHash<int, RegionSpec>;
+    using const_iterator = Map::const_iterator;
+
+    RegionSnapshot() = default;
+
+    /**
+     * @brief 快照版本号（区域每发布一批变化加一，可用于判断快照是否过期）
+     */
+    quint64 version() const { return m_version; }
+
+    int size() const { return m_regions.size(); }
+    bool isEmpty() const { return m_regions.isEmpty(); }
+    bool contains(int regionId) const { return m_regions.contains(regionId); }
+
+    /**
+     * @brief 查找区域参数
+     * @param regionId 区域ID
+     * @return 区域参数指针，不存在返回 nullptr（指针在快照存活期间有效）
+     */
+    const RegionSpec* find(int regionId) const {
+        auto it = m_regions.constFind(regionId);
+        return it != m_regions.constEnd() ? &it.value() : nullptr;
+    }
+
+    /**
+     * @brief 获取区域参数（不存在时返回默认值）
+     */
+    RegionSpec value(int regionId) const { return m_regions.value(regionId); }
+
+    QList<int> regionIds() const { return m_regions.keys(); }
+
+    const_iterator begin() const { return m_regions.constBegin(); }
+    const_iterator end() const { return m_regions.constEnd(); }
+
+private:
+    friend class RegionManager;
+
+    RegionSnapshot(const Map &regions, quint64 version)
+        : m_regions(regions)
+        , m_version(version)
+    {}
+
+    Map m_regions;          // regionId -> 区域参数
+    quint64 m_version = 0;  // 快照版本号
+};
+
+Q_DECLARE_METATYPE(RegionSnapshot)
+
+#endif // REGIONSNAPSHOT_H
@@ -0,0 +1,187 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "ScreenHitIndex.h"
+#include <QtMath>
+#include <limits>
+
+void ScreenHitIndex::clear()
+{
+    m_shapes.clear();
+    m_vertices.clear();
+    m_cells.clear();
+    m_largeShapes.clear();
+    m_visitStamp.clear();
+    m_queryCounter = 0;
+}
+
+void ScreenHitIndex::addPoint(quint32 id, const QPointF &center, double radius)
+{
+    Shape shape{id, ShapeKind::Point, QRectF(center.x() - radius, center.y() - radius, 2 * radius, 2 * radius),
+                center, radius, 0, 0};
+    addShape(shape);
+}
+
+void ScreenHitIndex::addCircle(quint32 id, const QPointF &center, double radius)
+{
+    Shape shape{id, ShapeKind::Circle, QRectF(center.x() - radius, center.y() - radius, 2 * radius, 2 * radius),
+                center, radius, 0, 0};
+    addShape(shape);
+}
+
+void ScreenHitIndex::addPolygon(quint32 id, const QVector<QPointF> &ring)
+{
+    int n = ring.size();
+    if (n > 1 && ring.first() == ring.last()) {
+        --n;  // 去掉闭合点
+    }
+    if (n < 3) {
+        return;
+    }
+
+    double minX = ring[0].x(), maxX = ring[0].x();
+    double minY = ring[0].y(), maxY = ring[0].y();
+    for (int i = 1; i < n; ++i) {
+        minX = qMin(minX, ring[i].x());
+        maxX = qMax(maxX, ring[i].x());
+        minY = qMin(minY, ring[i].y());
+        maxY = qMax(maxY, ring[i].y());
+    }
+
+    Shape shape{id, ShapeKind::Polygon, QRectF(minX, minY, maxX - minX, maxY - minY),
+                QPointF(), 0.0, int(m_vertices.size()), n};
+    m_vertices.append(ring.mid(0, n));
+    addShape(shape);
+}
+
+void ScreenHitIndex::addShape(const Shape &shape)
+{
+    const int index = m_shapes.size();
+    m_shapes.append(shape);
+
+    const int x0 = int(std::floor(shape.bounds.left() / CELL_SIZE));
+    const int x1 = int(std::floor(shape.bounds.right() / CELL_SIZE));
+    const int y0 = int(std::floor(shape.bounds.top() / CELL_SIZE));
+    const int y1 = int(std::floor(shape.bounds.bottom() / CELL_SIZE));
+
+    // 覆盖整个屏幕的大区域逐格登记反而更慢，单独放一个列表
+    if (qint64(x1 - x0 + 1) * qint64(y1 - y0 + 1) > MAX_CELLS_PER_SHAPE) {
+        m_largeShapes.append(index);
+        return;
+    }
+    for (int cx = x0; cx <= x1; ++cx) {
+        for (int cy = y0; cy <= y1; ++cy) {
+            m_cells[cellKey(cx, cy)].append(index);
+        }
+    }
+}
+
+quint32 ScreenHitIndex::pick(const QPointF &pixel, double tolerance) const
+{
+    if (m_shapes.isEmpty()) {
+        return 0;
+    }
+
+    // 每次查询使用新的序号去重，无需清空访问标记
+    if (m_visitStamp.size() != m_shapes.size()) {
+        m_visitStamp.fill(0, m_shapes.size());
+    }
+    const quint32 stamp = ++m_queryCounter;
+
+    quint32 nearestPoint = 0;
+    quint32 nearestArea = 0;
+    double minPointDistance = tolerance;
+    double minAreaDistance = tolerance;
+    double nearestAreaSize = std::numeric_limits<double>::max();
+
+    auto test = [&](int index) {
+        if (m_visitStamp[index] == stamp) {
+            return;
+        }
+        m_visitStamp[index] = stamp;
+
+        const Shape &shape = m_shapes[index];
+        // 包围盒外扩容差后仍不包含点击位置，直接跳过
+        if (pixel.x() < shape.bounds.left() - tolerance || pixel.x() > shape.bounds.right() + tolerance ||
+            pixel.y() < shape.bounds.top() - tolerance || pixel.y() > shape.bounds.bottom() + tolerance) {
+            return;
+        }
+
+        double distance = distanceTo(shape, pixel);
+        if (shape.kind == ShapeKind::Point) {
+            if (distance <= minPointDistance) {
+                minPointDistance = distance;
+                nearestPoint = shape.id;
+            }
+        } else {
+            // 距离相同（例如点击位置同时在嵌套的两个区域内）时取较小的区域，保证内层区域可以被选中
+            double area = shape.bounds.width() * shape.bounds.height();
+            if (distance < minAreaDistance || (distance == minAreaDistance && area < nearestAreaSize)) {
+                minAreaDistance = distance;
+                nearestAreaSize = area;
+                nearestArea = shape.id;
+            }
+        }
+    };
+
+    const int x0 = int(std::floor((pixel.x() - tolerance) / CELL_SIZE));
+    const int x1 = int(std::floor((pixel.x() + tolerance) / CELL_SIZE));
+    const int y0 = int(std::floor((pixel.y() - tolerance) / CELL_SIZE));
+    const int y1 = int(std::floor((pixel.y() + tolerance) / CELL_SIZE));
+    for (int cx = x0; cx <= x1; ++cx) {
+        for (int cy = y0; cy <= y1; ++cy) {
+            auto cell = m_cells.constFind(cellKey(cx, cy));
+            if (cell == m_cells.constEnd()) {
+                continue;
+            }
+            for (int index : cell.value()) {
+                test(index);
+            }
+        }
+    }
+    for (int index : m_largeShapes) {
+        test(index);
+    }
+
+    // 优先返回点状元素
+    return nearestPoint != 0 ? nearestPoint : nearestArea;
+}
+
+double ScreenHitIndex::distanceTo(const Shape &shape, const QPointF &pixel) const
+{
+    switch (shape.kind) {
+    case ShapeKind::Point:
+    case ShapeKind::Circle: {
+        double dx = pixel.x() - shape.center.x();
+        double dy = pixel.y() - shape.center.y();
+        return qMax(0.0, std::sqrt(dx * dx + dy * dy) - shape.radius);
+    }
+    case ShapeKind::Polygon:
+        break;
+    }
+
+    // 射线法判断是否在多边形内，同时求到各边的最短距离
+    const QPointF *v = m_vertices.constData() + shape.firstVertex;
+    const int n = shape.vertexCount;
+    bool inside = false;
+    double minDistSq = std::numeric_limits<double>::max();
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        const QPointF &a = v[j];
+        const QPointF &b = v[i];
+        if ((b.y() > pixel.y()) != (a.y() > pixel.y()) &&
+            pixel.x() < (a.x() - b.x()) * (pixel.y() - b.y()) / (a.y() - b.y()) + b.x()) {
+            inside = !inside;
+        }
+
+        double ex = b.x() - a.x();
+        double ey = b.y() - a.y();
+        double wx = pixel.x() - a.x();
+        double wy = pixel.y() - a.y();
+        double lenSq = ex * ex + ey * ey;
+        double t = lenSq > 0.0 ? qBound(0.0, (wx * ex + wy * ey) / lenSq, 1.0) : 0.0;
+        double dx = wx - t * ex;
+        double dy = wy - t * ey;
+        minDistSq = qMin(minDistSq, dx * dx + dy * dy);
+    }
+    return inside ? 0.0 : std::sqrt(minDistSq);
+}
@@ -0,0 +1,93 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef SCREENHITINDEX_H
+#define SCREENHITINDEX_H
+
+#include <QHash>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+/**
+ * @brief 屏幕空间命中测试索引
+ *
+ * 元素几何在相机变化后投影到屏幕像素坐标一次，按固定大小的网格分桶；
+ * 之后的点击/悬停查询只检查点击位置附近网格中的元素，并直接用像素距离比较，
+ * 因此拾取容差在任何缩放级别和纬度下都一致，重复查询不需要三角函数运算。
+ */
+class ScreenHitIndex {
+public:
+    // ==================== 构建 ====================
+
+    void clear();
+
+    /**
+     * @brief 添加点状元素（图标）
+     * @param id 元素ID
+     * @param center 图标可见部分的中心（像素）
+     * @param radius 图标半径（像素），落在图标上的点击距离为 0
+     */
+    void addPoint(quint32 id, const QPointF &center, double radius);
+
+    /**
+     * @brief 添加圆形区域
+     */
+    void addCircle(quint32 id, const QPointF &center, double radius);
+
+    /**
+     * @brief 添加多边形区域
+     * @param ring 顶点（像素，不要求闭合）
+     */
+    void addPolygon(quint32 id, const QVector<QPointF> &ring);
+
+    int size() const { return m_shapes.size(); }
+
+    // ==================== 查询 ====================
+
+    /**
+     * @brief 查找点击位置处的元素
+     *
+     * 容差内的点状元素优先（取最近的），否则返回距离最近的区域（点在区域内距离为 0）。
+     * @param pixel 点击位置（像素）
+     * @param tolerance 容差（像素）
+     * @return 元素ID，未找到返回 0
+     */
+    quint32 pick(const QPointF &pixel, double tolerance) const;
+
+private:
+    enum class ShapeKind { Point, Circle, Polygon };
+
+    struct Shape {
+        quint32 id;
+        ShapeKind kind;
+        QRectF bounds;          // 像素包围盒
+        QPointF center;         // 点/圆心
+        double radius;          // 点/圆半径
+        int firstVertex;        // 多边形顶点在 m_vertices 中的起始下标
+        int vertexCount;        // 多边形顶点数
+    };
+
+    void addShape(const Shape &shape);
+
+    /**
+     * @brief 点到形状的像素距离（在形状内为 0）
+     */
+    double distanceTo(const Shape &shape, const QPointF &pixel) const;
+
+    static quint64 cellKey(int cx, int cy) {
+        return (quint64(quint32(cx)) << 32) | quint64(quint32(cy));
+    }
+
+    QVector<Shape> m_shapes;
+    QVector<QPointF> m_vertices;              // 所有多边形的顶点连续存放
+    QHash<quint64, QVector<int>> m_cells;     // 网格 -> 形状下标
+    QVector<int> m_largeShapes;               // 覆盖网格过多的形状下标（每次查询都检查）
+    mutable QVector<quint32> m_visitStamp;    // 查询去重（形状下标 -> 最近一次访问序号）
+    mutable quint32 m_queryCounter = 0;
+
+    static constexpr double CELL_SIZE = 64.0;         // 网格边长（像素）
+    static constexpr int MAX_CELLS_PER_SHAPE = 256;   // 超过该数量的形状不逐格登记
+};
+
+#endif // SCREENHITINDEX_H
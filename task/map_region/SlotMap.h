@@ -0,0 +1,189 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+#include <QVector>
+#include <QtGlobal>
+#include <utility>
+
+/**
+ * @brief 稠密槽位表 - 稳定句柄 -> 连续数组
+ *
+ * 值连续存放在 m_values 中，句柄通过槽位表间接映射到数组下标：
+ * - 插入 / 删除 / 查找：O(1)，删除时与末尾元素交换，不移动整个数组
+ * - 遍历：直接线性扫描连续内存
+ * - 句柄 = (代数 << 24) | (槽位下标 + 1)，永不为 0；槽位复用时代数加一，旧句柄自动失效
+ * - 槽位用到最后一代（255）后退役、不再复用，旧句柄不会因代数回绕重新生效
+ *
+ * 注意：删除会移动末尾元素，不要长期持有值的指针或引用，只保存句柄。
+ */
+template<typename T>
+class SlotMap {
+public:
+    using Handle = quint32;
+
+    /**
+     * @brief 插入值，返回稳定句柄
+     */
+    Handle insert(T value) {
+        quint32 slotIndex;
+        if (m_freeHead != INVALID_INDEX) {
+            slotIndex = m_freeHead;
+            m_freeHead = m_slots[slotIndex].index;
+        } else {
+            slotIndex = quint32(m_slots.size());
+            Q_ASSERT(slotIndex < INDEX_MASK);
+            m_slots.append(Slot{0, 0});
+        }
+
+        Slot &slot = m_slots[slotIndex];
+        slot.index = quint32(m_values.size());
+        m_values.append(std::move(value));
+        m_valueSlots.append(slotIndex);
+
+        return makeHandle(slotIndex, slot.generation);
+    }
+
+    /**
+     * @brief 删除句柄对应的值
+     * @return 句柄有效返回 true
+     */
+    bool remove(Handle handle) {
+        quint32 slotIndex;
+        if (!resolve(handle, &slotIndex)) {
+            return false;
+        }
+
+        Slot &slot = m_slots[slotIndex];
+        const quint32 denseIndex = slot.index;
+        const quint32 lastIndex = quint32(m_values.size() - 1);
+
+        // 与末尾元素交换后弹出
+        if (denseIndex != lastIndex) {
+            m_values[denseIndex] = std::move(m_values[lastIndex]);
+            m_valueSlots[denseIndex] = m_valueSlots[lastIndex];
+            m_slots[m_valueSlots[denseIndex]].index = denseIndex;
+        }
+        m_values.removeLast();
+        m_valueSlots.removeLast();
+
+        // 代数加一使旧句柄失效，槽位放回空闲链表（代数用尽则退役）
+        if (advanceGeneration(slot)) {
+            slot.index = m_freeHead;
+            m_freeHead = slotIndex;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 清空所有值（已发出的句柄全部失效）
+     */
+    void clear() {
+        m_values.clear();
+        m_valueSlots.clear();
+        m_freeHead = INVALID_INDEX;
+        for (int i = m_slots.size() - 1; i >= 0; --i) {
+            Slot &slot = m_slots[i];
+            if (slot.generation == RETIRED || !advanceGeneration(slot)) {
+                continue;
+            }
+            slot.index = m_freeHead;
+            m_freeHead = quint32(i);
+        }
+    }
+
+    void reserve(int size) {
+        m_values.reserve(size);
+        m_valueSlots.reserve(size);
+        m_slots.reserve(size);
+    }
+
+    bool contains(Handle handle) const { return resolve(handle, nullptr); }
+    int size() const { return m_values.size(); }
+    bool isEmpty() const { return m_values.isEmpty(); }
+
+    /**
+     * @brief 获取句柄对应的值，句柄无效返回 nullptr
+     */
+    T* get(Handle handle) {
+        quint32 slotIndex;
+        return resolve(handle, &slotIndex) ? &m_values[m_slots[slotIndex].index] : nullptr;
+    }
+
+    const T* get(Handle handle) const {
+        quint32 slotIndex;
+        return resolve(handle, &slotIndex) ? &m_values[m_slots[slotIndex].index] : nullptr;
+    }
+
+    // ==================== 稠密遍历 ====================
+
+    T& valueAt(int denseIndex) { return m_values[denseIndex]; }
+    const T& valueAt(int denseIndex) const { return m_values[denseIndex]; }
+
+    Handle handleAt(int denseIndex) const {
+        quint32 slotIndex = m_valueSlots[denseIndex];
+        return makeHandle(slotIndex, m_slots[slotIndex].generation);
+    }
+
+    typename QVector<T>::iterator begin() { return m_values.begin(); }
+    typename QVector<T>::iterator end() { return m_values.end(); }
+    typename QVector<T>::const_iterator begin() const { return m_values.cbegin(); }
+    typename QVector<T>::const_iterator end() const { return m_values.cend(); }
+
+private:
+    struct Slot {
+        quint32 index;       // 占用时：值数组下标；空闲时：下一个空闲槽位
+        quint32 generation;  // 代数
+    };
+
+    static constexpr int INDEX_BITS = 24;
+    static constexpr quint32 INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr quint32 GENERATION_MASK = 0xFF;
+    static constexpr quint32 RETIRED = GENERATION_MASK + 1;   // 退役槽位的代数，任何句柄都无法匹配
+    static constexpr quint32 INVALID_INDEX = 0xFFFFFFFF;
+
+    /**
+     * @brief 槽位释放后代数加一；最后一代用完时退役，返回 false（不再放回空闲链表）
+     */
+    static bool advanceGeneration(Slot &slot) {
+        if (slot.generation >= GENERATION_MASK) {
+            slot.generation = RETIRED;
+            slot.index = INVALID_INDEX;
+            return false;
+        }
+        ++slot.generation;
+        return true;
+    }
+
+    static Handle makeHandle(quint32 slotIndex, quint32 generation) {
+        return (generation << INDEX_BITS) | (slotIndex + 1);
+    }
+
+    bool resolve(Handle handle, quint32 *slotIndex) const {
+        quint32 low = handle & INDEX_MASK;
+        if (low == 0 || low > quint32(m_slots.size())) {
+            return false;
+        }
+        const Slot &slot = m_slots[low - 1];
+        if (slot.generation != (handle >> INDEX_BITS)) {
+            return false;
+        }
+        // 空闲槽位的代数与下一次分配的句柄相同，再确认槽位确实被占用
+        if (slot.index >= quint32(m_values.size()) || m_valueSlots[slot.index] != low - 1) {
+            return false;
+        }
+        if (slotIndex) {
+            *slotIndex = low - 1;
+        }
+        return true;
+    }
+
+    QVector<Slot> m_slots;          // 槽位表（句柄 -> 值下标）
+    QVector<T> m_values;            // 连续存放的值
+    QVector<quint32> m_valueSlots;  // 值下标 -> 槽位（删除时回填）
+    quint32 m_freeHead = INVALID_INDEX;
+};
+
+#endif // SLOTMAP_H
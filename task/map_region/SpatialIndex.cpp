@@ -0,0 +1,107 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "SpatialIndex.h"
+
+SpatialIndex::SpatialIndex()
+    : m_levels(LEVEL_COUNT)
+{
+    double cellSize = BASE_CELL_DEGREES;
+    for (Level &level : m_levels) {
+        level.cellSize = cellSize;
+        cellSize *= 2.0;
+    }
+}
+
+void SpatialIndex::insert(int id, const GeoBounds &bounds)
+{
+    if (!bounds.isValid()) {
+        remove(id);
+        return;
+    }
+
+    remove(id);
+
+    int levelIndex = levelFor(bounds);
+    Level &level = m_levels[levelIndex];
+
+    double centerLon = (bounds.minLon + bounds.maxLon) * 0.5;
+    double centerLat = (bounds.minLat + bounds.maxLat) * 0.5;
+    quint64 key = cellKey(qint64(std::floor(centerLon / level.cellSize)),
+                          qint64(std::floor(centerLat / level.cellSize)));
+
+    level.cells[key].append(Item{id, bounds});
+    level.count++;
+
+    m_entries.insert(id, Entry{levelIndex, key, bounds});
+}
+
+bool SpatialIndex::remove(int id)
+{
+    auto entryIt = m_entries.find(id);
+    if (entryIt == m_entries.end()) {
+        return false;
+    }
+
+    Level &level = m_levels[entryIt->level];
+    auto cellIt = level.cells.find(entryIt->cellKey);
+    if (cellIt != level.cells.end()) {
+        QVector<Item> &items = cellIt.value();
+        for (int i = 0; i < items.size(); ++i) {
+            if (items[i].id == id) {
+                // 与末尾交换后删除，避免移动整个数组
+                items[i] = items.last();
+                items.removeLast();
+                break;
+            }
+        }
+        if (items.isEmpty()) {
+            level.cells.erase(cellIt);
+        }
+    }
+    level.count--;
+
+    m_entries.erase(entryIt);
+    return true;
+}
+
+void SpatialIndex::clear()
+{
+    m_entries.clear();
+    for (Level &level : m_levels) {
+        level.cells.clear();
+        level.count = 0;
+    }
+}
+
+GeoBounds SpatialIndex::bounds(int id) const
+{
+    auto it = m_entries.constFind(id);
+    return it != m_entries.constEnd() ? it->bounds : GeoBounds();
+}
+
+QVector<int> SpatialIndex::query(const GeoBounds &area) const
+{
+    QVector<int> result;
+    visit(area, [&result](int id, const GeoBounds &) {
+        result.append(id);
+        return true;
+    });
+    return result;
+}
+
+int SpatialIndex::levelFor(const GeoBounds &bounds) const
+{
+    double extent = qMax(bounds.maxLat - bounds.minLat, bounds.maxLon - bounds.minLon);
+    for (int i = 0; i < m_levels.size(); ++i) {
+        if (extent <= m_levels[i].cellSize) {
+            return i;
+        }
+    }
+    return m_levels.size() - 1;
+}
+
+quint64 SpatialIndex::cellKey(qint64 ix, qint64 iy)
+{
+    return (quint64(quint32(qint32(ix))) << 32) | quint64(quint32(qint32(iy)));
+}
@@ -0,0 +1,142 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include "GeoBounds.h"
+#include <QHash>
+#include <QVector>
+#include <QtMath>
+
+/**
+ * @brief 分层松散网格空间索引 - 按包围盒索引区域
+ *
+ * 每个条目按包围盒尺寸放入某一层（第 0 层网格边长 1/1024 度，逐层翻倍），
+ * 并只挂在包围盒中心所在的单元格里；由于包围盒不超过单元格边长，
+ * 查询时把查询范围向外扩半个单元格即可保证不漏选。
+ *
+ * - 插入 / 更新 / 删除：O(1)（只涉及一个单元格）
+ * - 查询：每层只访问查询范围覆盖的少量单元格，与条目总数无关
+ */
+class SpatialIndex {
+public:
+    SpatialIndex();
+
+    /**
+     * @brief 插入条目（ID 已存在时等同于更新包围盒）
+     * @param id 条目ID（区域ID 或标注ID）
+     * @param bounds 包围盒
+     */
+    void insert(int id, const GeoBounds &bounds);
+
+    /**
+     * @brief 删除条目
+     * @return 条目存在返回 true
+     */
+    bool remove(int id);
+
+    /**
+     * @brief 清空索引
+     */
+    void clear();
+
+    bool contains(int id) const { return m_entries.contains(id); }
+    int size() const { return m_entries.size(); }
+
+    /**
+     * @brief 获取条目的包围盒（不存在返回空包围盒）
+     */
+    GeoBounds bounds(int id) const;
+
+    /**
+     * @brief 查询包围盒与指定范围相交的所有条目
+     */
+    QVector<int> query(const GeoBounds &area) const;
+
+    /**
+     * @brief 遍历包围盒与指定范围相交的条目
+     * @param visitor 形如 bool(int id, const GeoBounds &bounds)，返回 false 时停止遍历
+     */
+    template<typename Visitor>
+    void visit(const GeoBounds &area, Visitor &&visitor) const;
+
+private:
+    struct Item {
+        int id;
+        GeoBounds bounds;
+    };
+
+    struct Entry {
+        int level;
+        quint64 cellKey;
+        GeoBounds bounds;
+    };
+
+    struct Level {
+        double cellSize = 0.0;               // 单元格边长（度）
+        QHash<quint64, QVector<Item>> cells; // 单元格 -> 条目列表
+        int count = 0;                       // 本层条目数
+    };
+
+    int levelFor(const GeoBounds &bounds) const;
+    static quint64 cellKey(qint64 ix, qint64 iy);
+
+    static constexpr int LEVEL_COUNT = 20;
+    static constexpr double BASE_CELL_DEGREES = 1.0 / 1024.0;  // 约 100 米
+
+    QHash<int, Entry> m_entries;  // 条目ID -> 所在层与单元格
+    QVector<Level> m_levels;
+};
+
+template<typename Visitor>
+void SpatialIndex::visit(const GeoBounds &area, Visitor &&visitor) const
+{
+    if (!area.isValid() || m_entries.isEmpty()) {
+        return;
+    }
+
+    for (const Level &level : m_levels) {
+        if (level.count == 0) {
+            continue;
+        }
+
+        // 松散网格：条目最多越出所在单元格半个边长
+        const double half = level.cellSize * 0.5;
+        const qint64 ix0 = qint64(std::floor((area.minLon - half) / level.cellSize));
+        const qint64 ix1 = qint64(std::floor((area.maxLon + half) / level.cellSize));
+        const qint64 iy0 = qint64(std::floor((area.minLat - half) / level.cellSize));
+        const qint64 iy1 = qint64(std::floor((area.maxLat + half) / level.cellSize));
+        const double cellsInRange = double(ix1 - ix0 + 1) * double(iy1 - iy0 + 1);
+
+        auto visitCell = [&](const QVector<Item> &items) {
+            for (const Item &item : items) {
+                if (item.bounds.intersects(area) && !visitor(item.id, item.bounds)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        if (cellsInRange > double(level.cells.size())) {
+            // 查询范围远大于已占用单元格数（如整屏视口），直接遍历非空单元格
+            for (auto it = level.cells.constBegin(); it != level.cells.constEnd(); ++it) {
+                if (!visitCell(it.value())) {
+                    return;
+                }
+            }
+            continue;
+        }
+
+        for (qint64 ix = ix0; ix <= ix1; ++ix) {
+            for (qint64 iy = iy0; iy <= iy1; ++iy) {
+                auto it = level.cells.constFind(cellKey(ix, iy));
+                if (it != level.cells.constEnd() && !visitCell(it.value())) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+#endif // SPATIALINDEX_H
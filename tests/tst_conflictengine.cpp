@@ -0,0 +1,174 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "ConflictEngine.h"
+#include "RegionManager.h"
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QtMath>
+#include <algorithm>
+
+/**
+ * @brief ConflictEngine：并行与串行结果完全一致，且与逐对检查（不经过空间索引）一致
+ */
+class TestConflictEngine : public QObject {
+    Q_OBJECT
+
+private slots:
+    void parallelMatchesSerial();
+    void emptyInputs();
+
+private:
+    static QVector<RegionSpec> randomSpecs(QRandomGenerator &rng, int zoneCount, int subjectCount);
+    static QVector<RegionConflict> allPairs(const RegionSnapshot &snapshot);
+    static bool sameConflicts(const QVector<RegionConflict> &a, const QVector<RegionConflict> &b);
+};
+
+QVector<RegionSpec> TestConflictEngine::randomSpecs(QRandomGenerator &rng, int zoneCount, int subjectCount)
+{
+    // 约 10 km × 10 km 的范围内随机分布，禁飞区半径 200 m ~ 1.5 km
+    auto randomCoordinate = [&rng]() {
+        return QMapLibre::Coordinate(30.0 + rng.generateDouble() * 0.1, 120.0 + rng.generateDouble() * 0.1);
+    };
+    auto ring = [&rng](const QMapLibre::Coordinate &center, int count, double radiusDeg) {
+        // 按角度排序的星形顶点，保证是简单多边形
+        QMapLibre::Coordinates vertices;
+        for (int i = 0; i < count; ++i) {
+            double angle = 2.0 * M_PI * i / count;
+            double r = radiusDeg * (0.5 + 0.5 * rng.generateDouble());
+            vertices.append(QMapLibre::Coordinate(center.first + r * qSin(angle), center.second + r * qCos(angle)));
+        }
+        return vertices;
+    };
+
+    QVector<RegionSpec> specs;
+    for (int i = 0; i < zoneCount; ++i) {
+        RegionSpec spec;
+        spec.type = RegionType::NoFlyZone;
+        spec.coordinate = randomCoordinate();
+        spec.radius = 200.0 + rng.generateDouble() * 1300.0;
+        specs.append(spec);
+    }
+
+    for (int i = 0; i < subjectCount; ++i) {
+        RegionSpec spec;
+        const QMapLibre::Coordinate center = randomCoordinate();
+        switch (i % 5) {
+        case 0:
+            spec.type = RegionType::UAV;
+            spec.coordinate = center;
+            break;
+        case 1:
+            spec.type = RegionType::LoiterPoint;
+            spec.coordinate = center;
+            break;
+        case 2:
+            spec.type = RegionType::TaskRegion;
+            spec.shape = TaskRegionShape::Polygon;
+            spec.vertices = ring(center, 3 + int(rng.bounded(20)), 0.002 + rng.generateDouble() * 0.01);
+            break;
+        case 3: {
+            const double h = 0.001 + rng.generateDouble() * 0.005;
+            spec.type = RegionType::TaskRegion;
+            spec.shape = TaskRegionShape::Rectangle;
+            spec.vertices = {QMapLibre::Coordinate(center.first - h, center.second - h),
+                             QMapLibre::Coordinate(center.first - h, center.second + h),
+                             QMapLibre::Coordinate(center.first + h, center.second + h),
+                             QMapLibre::Coordinate(center.first + h, center.second - h)};
+            break;
+        }
+        default:
+            spec.type = RegionType::TaskRegion;
+            spec.shape = TaskRegionShape::Circle;
+            spec.coordinate = center;
+            spec.radius = 100.0 + rng.generateDouble() * 800.0;
+            spec.vertices = ring(center, 32, 0.005);
+            break;
+        }
+        specs.append(spec);
+    }
+    return specs;
+}
+
+QVector<RegionConflict> TestConflictEngine::allPairs(const RegionSnapshot &snapshot)
+{
+    QVector<RegionConflict> conflicts;
+    for (auto region = snapshot.begin(); region != snapshot.end(); ++region) {
+        for (auto zone = snapshot.begin(); zone != snapshot.end(); ++zone) {
+            RegionConflict conflict;
+            if (ConflictEngine::checkPair(region.key(), region.value(), zone.key(), zone.value(), conflict)) {
+                conflicts.append(conflict);
+            }
+        }
+    }
+    std::sort(conflicts.begin(), conflicts.end(), [](const RegionConflict &a, const RegionConflict &b) {
+        return a.regionId != b.regionId ? a.regionId < b.regionId : a.noFlyZoneId < b.noFlyZoneId;
+    });
+    return conflicts;
+}
+
+bool TestConflictEngine::sameConflicts(const QVector<RegionConflict> &a, const QVector<RegionConflict> &b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (int i = 0; i < a.size(); ++i) {
+        if (a[i].regionId != b[i].regionId || a[i].noFlyZoneId != b[i].noFlyZoneId
+            || a[i].regionType != b[i].regionType
+            || a[i].distance != b[i].distance || a[i].penetration != b[i].penetration) {
+            qWarning() << "冲突不一致:" << i << a[i].regionId << a[i].noFlyZoneId << b[i].regionId << b[i].noFlyZoneId;
+            return false;
+        }
+    }
+    return true;
+}
+
+void TestConflictEngine::parallelMatchesSerial()
+{
+    QRandomGenerator rng(46);
+    RegionManager regions(nullptr);
+
+    // 检查对象数远超 PARALLEL_THRESHOLD，确保真正分块并行
+    const int subjectCount = ConflictEngine::PARALLEL_THRESHOLD * 8;
+    QVector<int> ids = regions.createRegions(randomSpecs(rng, 80, subjectCount));
+    QVERIFY(!ids.contains(0));
+
+    const RegionSnapshot snapshot = regions.snapshot();
+    const ConflictReport serial = ConflictEngine::run(snapshot, false);
+    const ConflictReport parallel = ConflictEngine::run(snapshot, true);
+
+    QCOMPARE(serial.checkedRegions, subjectCount);
+    QCOMPARE(serial.noFlyZones, 80);
+    QCOMPARE(parallel.checkedRegions, serial.checkedRegions);
+    QCOMPARE(parallel.noFlyZones, serial.noFlyZones);
+    QCOMPARE(parallel.snapshotVersion, serial.snapshotVersion);
+    QVERIFY(!serial.conflicts.isEmpty());
+    QVERIFY(sameConflicts(parallel.conflicts, serial.conflicts));
+
+    // 空间索引不漏选：与全部配对逐一检查的结果一致
+    QVERIFY(sameConflicts(serial.conflicts, allPairs(snapshot)));
+
+    // 按区域查询与整体结果一致
+    for (int regionId : serial.conflictingRegionIds()) {
+        for (const RegionConflict &conflict : serial.conflictsOf(regionId)) {
+            QCOMPARE(conflict.regionId, regionId);
+        }
+    }
+}
+
+void TestConflictEngine::emptyInputs()
+{
+    QRandomGenerator rng(47);
+    RegionManager regions(nullptr);
+    regions.createRegions(randomSpecs(rng, 0, 50));
+    QVERIFY(ConflictEngine::run(regions.snapshot(), true).isEmpty());
+
+    RegionManager zonesOnly(nullptr);
+    zonesOnly.createRegions(randomSpecs(rng, 50, 0));
+    const ConflictReport report = ConflictEngine::run(zonesOnly.snapshot(), true);
+    QVERIFY(report.isEmpty());
+    QCOMPARE(report.noFlyZones, 50);
+}
+
+QTEST_GUILESS_MAIN(TestConflictEngine)
+#include "tst_conflictengine.moc"
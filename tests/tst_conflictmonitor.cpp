@@ -0,0 +1,269 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "TaskManager.h"
+#include "ConflictMonitor.h"
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QtMath>
+
+/**
+ * @brief ConflictMonitor：每批区域变化后增量维护的冲突与对当前快照完整运行 ConflictEngine 的结果一致
+ *
+ * 变化包括新建/删除禁飞区和检查对象、只改名称的更新、同一事务内新建又删除，
+ * 以及撤销/重做重建区域（换新ID）。只改属性、冲突不变的批次不发出 conflictsChanged。
+ */
+class TestConflictMonitor : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void incrementalMatchesFullRun();
+    void undoRedoMatchesFullRun();
+    void propertyUpdateIsSilent();
+
+private:
+    RegionSpec randomSpec();
+    void randomBatch(int createCount, int removeCount);
+
+    /**
+     * @brief 监视器当前状态与完整检查结果是否一致（不一致时输出第一处差异）
+     */
+    bool matchesFullRun() const;
+
+    QRandomGenerator m_rng{47};
+    RegionManager *m_regions = nullptr;
+    TaskManager *m_tasks = nullptr;
+    QVector<int> m_regionIds;   // 当前存在的区域
+};
+
+void TestConflictMonitor::init()
+{
+    m_rng.seed(47);
+    m_regions = new RegionManager(nullptr);
+    m_tasks = new TaskManager(m_regions);
+    m_regionIds.clear();
+}
+
+void TestConflictMonitor::cleanup()
+{
+    delete m_tasks;
+    delete m_regions;
+    m_tasks = nullptr;
+    m_regions = nullptr;
+}
+
+RegionSpec TestConflictMonitor::randomSpec()
+{
+    // 约 5 km × 5 km 的范围，禁飞区约占四分之一，保证冲突足够多
+    RegionSpec spec;
+    const QMapLibre::Coordinate center(30.0 + m_rng.generateDouble() * 0.05, 120.0 + m_rng.generateDouble() * 0.05);
+    switch (m_rng.bounded(4)) {
+    case 0:
+        spec.type = RegionType::NoFlyZone;
+        spec.coordinate = center;
+        spec.radius = 100.0 + m_rng.generateDouble() * 600.0;
+        break;
+    case 1:
+        spec.type = m_rng.bounded(2) ? RegionType::UAV : RegionType::LoiterPoint;
+        spec.coordinate = center;
+        break;
+    case 2: {
+        spec.type = RegionType::TaskRegion;
+        const int count = 3 + int(m_rng.bounded(10));
+        for (int i = 0; i < count; ++i) {
+            const double angle = 2.0 * M_PI * i / count;
+            const double r = 0.001 + m_rng.generateDouble() * 0.003;
+            spec.vertices.append(QMapLibre::Coordinate(center.first + r * qSin(angle), center.second + r * qCos(angle)));
+        }
+        break;
+    }
+    default:
+        spec.type = RegionType::TaskRegion;
+        spec.shape = TaskRegionShape::Circle;
+        spec.coordinate = center;
+        spec.radius = 50.0 + m_rng.generateDouble() * 300.0;
+        for (int i = 0; i < 16; ++i) {
+            const double angle = 2.0 * M_PI * i / 16;
+            spec.vertices.append(QMapLibre::Coordinate(center.first + 0.002 * qSin(angle), center.second + 0.002 * qCos(angle)));
+        }
+        break;
+    }
+    return spec;
+}
+
+void TestConflictMonitor::randomBatch(int createCount, int removeCount)
+{
+    TaskManager::ChangeScope scope(m_tasks);
+
+    QVector<RegionSpec> specs;
+    for (int i = 0; i < createCount; ++i) {
+        specs.append(randomSpec());
+    }
+    for (int regionId : m_regions->createRegions(specs)) {
+        if (regionId != 0) {
+            m_regionIds.append(regionId);
+        }
+    }
+
+    for (int i = 0; i < removeCount && !m_regionIds.isEmpty(); ++i) {
+        const int pick = m_rng.bounded(int(m_regionIds.size()));
+        m_regions->removeRegion(m_regionIds[pick]);
+        m_regionIds[pick] = m_regionIds.last();
+        m_regionIds.removeLast();
+    }
+
+    // 只改名称的更新不应改变冲突
+    if (!m_regionIds.isEmpty()) {
+        const int regionId = m_regionIds[m_rng.bounded(int(m_regionIds.size()))];
+        m_regions->updateRegionName(regionId, QString("改名%1").arg(regionId));
+    }
+}
+
+bool TestConflictMonitor::matchesFullRun() const
+{
+    const ConflictMonitor *monitor = m_tasks->conflictMonitor();
+    const ConflictReport report = ConflictEngine::run(m_regions->snapshot(), false);
+    const QVector<RegionConflict> actual = monitor->conflicts();
+
+    if (actual.size() != report.conflicts.size()) {
+        qWarning() << "冲突数不一致:" << actual.size() << report.conflicts.size();
+        return false;
+    }
+    QSet<int> involved;
+    for (int i = 0; i < actual.size(); ++i) {
+        const RegionConflict &a = actual[i];
+        const RegionConflict &b = report.conflicts[i];
+        if (a.regionId != b.regionId || a.noFlyZoneId != b.noFlyZoneId
+            || a.distance != b.distance || a.penetration != b.penetration) {
+            qWarning() << "冲突不一致:" << a.regionId << a.noFlyZoneId << b.regionId << b.noFlyZoneId;
+            return false;
+        }
+        involved.insert(b.regionId);
+        involved.insert(b.noFlyZoneId);
+    }
+
+    for (Region *region : m_regions->getAllRegions()) {
+        if (monitor->isInConflict(region->id()) != involved.contains(region->id())) {
+            qWarning() << "isInConflict 不一致:" << region->id();
+            return false;
+        }
+    }
+    for (int regionId : involved) {
+        for (const RegionConflict &conflict : monitor->conflictsOf(regionId)) {
+            if (conflict.regionId != regionId && conflict.noFlyZoneId != regionId) {
+                qWarning() << "conflictsOf 返回了无关的冲突:" << regionId;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void TestConflictMonitor::incrementalMatchesFullRun()
+{
+    QVERIFY(m_tasks->conflictMonitor()->isEmpty());
+
+    randomBatch(300, 0);
+    QVERIFY(!m_tasks->conflictMonitor()->isEmpty());
+    QVERIFY(matchesFullRun());
+
+    for (int round = 0; round < 60; ++round) {
+        randomBatch(int(m_rng.bounded(15)), int(m_rng.bounded(15)));
+        QVERIFY(matchesFullRun());
+    }
+
+    // 同一事务内新建又删除：不应留下任何冲突记录
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        RegionSpec zone;
+        zone.type = RegionType::NoFlyZone;
+        zone.coordinate = QMapLibre::Coordinate(30.025, 120.025);
+        zone.radius = 5000.0;
+        const int zoneId = m_regions->createRegions({zone}).first();
+        QVERIFY(zoneId != 0);
+        QVERIFY(m_regions->removeRegion(zoneId));
+    }
+    QVERIFY(matchesFullRun());
+
+    // 删除全部区域
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        for (int regionId : m_regionIds) {
+            m_regions->removeRegion(regionId);
+        }
+        m_regionIds.clear();
+    }
+    QVERIFY(m_tasks->conflictMonitor()->isEmpty());
+    QVERIFY(matchesFullRun());
+}
+
+void TestConflictMonitor::undoRedoMatchesFullRun()
+{
+    const int rounds = 20;
+    randomBatch(200, 0);
+    for (int round = 0; round < rounds; ++round) {
+        randomBatch(int(m_rng.bounded(10)), 1 + int(m_rng.bounded(10)));
+    }
+    QVERIFY(matchesFullRun());
+
+    // 撤销重建的区域分配新ID，监视器须按新ID重新检查
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 0; i < rounds; ++i) {
+            QVERIFY(m_tasks->undo());
+            QVERIFY(matchesFullRun());
+        }
+        for (int i = 0; i < rounds; ++i) {
+            QVERIFY(m_tasks->redo());
+            QVERIFY(matchesFullRun());
+        }
+    }
+
+    m_tasks->conflictMonitor()->reset();
+    QVERIFY(matchesFullRun());
+}
+
+void TestConflictMonitor::propertyUpdateIsSilent()
+{
+    RegionSpec zone;
+    zone.type = RegionType::NoFlyZone;
+    zone.coordinate = QMapLibre::Coordinate(30.0, 120.0);
+    zone.radius = 1000.0;
+    RegionSpec uav;
+    uav.type = RegionType::UAV;
+    uav.coordinate = QMapLibre::Coordinate(30.001, 120.0);
+
+    QVector<int> ids;
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        ids = m_regions->createRegions({zone, uav});
+    }
+    const ConflictMonitor *monitor = m_tasks->conflictMonitor();
+    QCOMPARE(int(monitor->conflicts().size()), 1);
+
+    QSignalSpy spy(monitor, &ConflictMonitor::conflictsChanged);
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        QVERIFY(m_regions->updateRegionName(ids[0], "改名禁飞区"));
+        QVERIFY(m_regions->updateRegionTerrainType(ids[0], Region::TerrainType::Mountain));
+        QVERIFY(m_regions->updateRegionName(ids[1], "改名无人机"));
+        QVERIFY(m_regions->updateRegionColor(ids[1], "#00ff00"));
+    }
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(matchesFullRun());
+
+    // 新增冲突照常发出
+    uav.coordinate = QMapLibre::Coordinate(30.0, 120.001);
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        QVERIFY(m_regions->createRegions({uav}).first() != 0);
+    }
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(matchesFullRun());
+}
+
+QTEST_GUILESS_MAIN(TestConflictMonitor)
+#include "tst_conflictmonitor.moc"
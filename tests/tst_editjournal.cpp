@@ -0,0 +1,205 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "TaskManager.h"
+#include "EditJournal.h"
+#include <QtTest>
+#include <QStringList>
+
+/**
+ * @brief EditJournal：撤销/重做往返后区域、属性和任务关联与原状态一致
+ *
+ * 重建的区域会分配新ID，状态按名称、类型、属性和引用它的任务比较，不比较区域ID；
+ * 多条记录连续撤销/重做时，后面的记录必须通过逻辑ID映射找到重建后的区域。
+ * 不设置渲染器，每一步编辑放在一个事务里，结束时立即成为一条撤销记录。
+ */
+class TestEditJournal : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void createUndoRedo();
+    void removeRestoresTaskReferences();
+    void remapAcrossEntries();
+
+private:
+    /**
+     * @brief 当前所有区域的状态（与区域ID无关，排序后可直接比较）
+     */
+    QStringList state() const;
+
+    RegionSpec uavSpec(const QString &name, double lat, double lon) const;
+
+    RegionManager *m_regions = nullptr;
+    TaskManager *m_tasks = nullptr;
+};
+
+void TestEditJournal::init()
+{
+    m_regions = new RegionManager(nullptr);
+    m_tasks = new TaskManager(m_regions);
+}
+
+void TestEditJournal::cleanup()
+{
+    delete m_tasks;
+    delete m_regions;
+    m_tasks = nullptr;
+    m_regions = nullptr;
+}
+
+QStringList TestEditJournal::state() const
+{
+    QStringList lines;
+    for (Region *region : m_regions->getAllRegions()) {
+        QStringList taskIds;
+        for (Task *task : m_tasks->getTasksReferencingRegion(region->id())) {
+            taskIds.append(QString::number(task->id()));
+        }
+        lines.append(QString("%1|%2|%3|%4|%5")
+                         .arg(region->name())
+                         .arg(int(region->type()))
+                         .arg(int(region->terrainType()))
+                         .arg(region->color())
+                         .arg(taskIds.join(",")));
+    }
+    lines.sort();
+    return lines;
+}
+
+RegionSpec TestEditJournal::uavSpec(const QString &name, double lat, double lon) const
+{
+    RegionSpec spec;
+    spec.type = RegionType::UAV;
+    spec.name = name;
+    spec.coordinate = QMapLibre::Coordinate(lat, lon);
+    spec.color = "red";
+    return spec;
+}
+
+void TestEditJournal::createUndoRedo()
+{
+    const QStringList empty = state();
+    const int taskId = m_tasks->createTask("任务1", QString())->id();
+    QVERIFY(!m_tasks->canUndo());
+
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        m_tasks->addRegionsToTask(taskId, {uavSpec("A", 30.0, 120.0), uavSpec("B", 30.1, 120.1)});
+    }
+    const QStringList created = state();
+    QCOMPARE(int(created.size()), 2);
+
+    for (int round = 0; round < 3; ++round) {
+        QVERIFY(m_tasks->undo());
+        QCOMPARE(state(), empty);
+        QVERIFY(!m_tasks->canUndo());
+
+        QVERIFY(m_tasks->redo());
+        QCOMPARE(state(), created);
+        QVERIFY(!m_tasks->canRedo());
+    }
+}
+
+void TestEditJournal::removeRestoresTaskReferences()
+{
+    const int task1 = m_tasks->createTask("任务1", QString())->id();
+    const int task2 = m_tasks->createTask("任务2", QString())->id();
+
+    int regionId = 0;
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        regionId = m_tasks->addRegionsToTask(task1, {uavSpec("U", 30.0, 120.0)}).first();
+        m_tasks->addRegionToTask(task2, regionId);
+    }
+    const QStringList before = state();
+
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        QVERIFY(m_regions->removeRegion(regionId));
+    }
+    const QStringList after = state();
+    QVERIFY(after.isEmpty());
+
+    for (int round = 0; round < 3; ++round) {
+        QVERIFY(m_tasks->undo());
+        QCOMPARE(state(), before);
+
+        // 重建的区域分配了新ID，旧ID不再有效
+        QVERIFY(m_regions->getRegion(regionId) == nullptr);
+        QCOMPARE(int(m_tasks->getTaskRegions(task1).size()), 1);
+        QCOMPARE(int(m_tasks->getTaskRegions(task2).size()), 1);
+        regionId = m_tasks->getTaskRegions(task1).first()->id();
+        QCOMPARE(m_tasks->getTaskRegions(task2).first()->id(), regionId);
+
+        QVERIFY(m_tasks->redo());
+        QCOMPARE(state(), after);
+    }
+}
+
+void TestEditJournal::remapAcrossEntries()
+{
+    const int taskId = m_tasks->createTask("任务1", QString())->id();
+    QVector<QStringList> states{state()};
+
+    int regionId = 0;
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        regionId = m_tasks->addRegionsToTask(taskId, {uavSpec("R", 30.0, 120.0)}).first();
+        m_tasks->addRegionsToTask(taskId, {uavSpec("S", 30.2, 120.2)});
+    }
+    states.append(state());
+
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        QVERIFY(m_regions->updateRegionName(regionId, "R2"));
+        QVERIFY(m_regions->updateRegionTerrainType(regionId, TerrainType::Mountain));
+        QVERIFY(m_regions->updateRegionColor(regionId, "blue"));
+    }
+    states.append(state());
+
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        m_tasks->removeRegionFromTask(taskId, regionId);
+    }
+    states.append(state());
+
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        QVERIFY(m_regions->removeRegion(regionId));
+    }
+    states.append(state());
+
+    // 每次撤销删除、重做新建都会换一个区域ID，其余记录须按逻辑ID找到当前区域
+    const int last = states.size() - 1;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = last - 1; i >= 0; --i) {
+            QVERIFY(m_tasks->undo());
+            QCOMPARE(state(), states[i]);
+        }
+        QVERIFY(!m_tasks->canUndo());
+
+        for (int i = 1; i <= last; ++i) {
+            QVERIFY(m_tasks->redo());
+            QCOMPARE(state(), states[i]);
+        }
+        QVERIFY(!m_tasks->canRedo());
+    }
+
+    // 部分撤销后做新的编辑，可重做的记录被丢弃
+    QVERIFY(m_tasks->undo());
+    QVERIFY(m_tasks->undo());
+    QCOMPARE(state(), states[last - 2]);
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        m_tasks->addRegionsToTask(taskId, {uavSpec("T", 30.3, 120.3)});
+    }
+    QVERIFY(!m_tasks->canRedo());
+    QVERIFY(m_tasks->undo());
+    QCOMPARE(state(), states[last - 2]);
+}
+
+QTEST_GUILESS_MAIN(TestEditJournal)
+#include "tst_editjournal.moc"
@@ -0,0 +1,187 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "Geodesy.h"
+#include <QtTest>
+#include <QRandomGenerator>
+
+/**
+ * @brief Geodesy：批量接口与逐点调用单点接口的结果一致，近似距离满足类说明中的误差上界
+ */
+class TestGeodesy : public QObject {
+    Q_OBJECT
+
+private slots:
+    void distancesMatchScalar();
+    void indexedDistancesMatchContiguous();
+    void fastDistancesMatchScalar();
+    void fastDistanceErrorBound_data();
+    void fastDistanceErrorBound();
+    void pathLengthMatchesScalarSum();
+    void localRoundTrip();
+
+private:
+    /**
+     * @brief 距 from 约 distance 米、方位随机的点（纬度不超过 ±70°）
+     */
+    static QMapLibre::Coordinate randomNear(QRandomGenerator &rng, const QMapLibre::Coordinate &from, double distance);
+    static QMapLibre::Coordinate randomCoordinate(QRandomGenerator &rng);
+
+    /**
+     * @brief 批量与单点结果只差舍入误差（短距离时弧度换算的抵消误差约 1e-9 米）
+     */
+    static bool close(double a, double b) { return qAbs(a - b) <= 1e-6 + 1e-12 * qAbs(b); }
+};
+
+QMapLibre::Coordinate TestGeodesy::randomCoordinate(QRandomGenerator &rng)
+{
+    return QMapLibre::Coordinate(-70.0 + rng.generateDouble() * 140.0, -180.0 + rng.generateDouble() * 360.0);
+}
+
+QMapLibre::Coordinate TestGeodesy::randomNear(QRandomGenerator &rng, const QMapLibre::Coordinate &from, double distance)
+{
+    const double bearing = 2.0 * M_PI * rng.generateDouble();
+    double east = distance * qSin(bearing);
+    double north = distance * qCos(bearing);
+    // 保证两端纬度都不超过 ±70°
+    if (qAbs(from.first + north / Geodesy::METERS_PER_DEG_LAT) > 70.0) {
+        north = -north;
+    }
+    return Geodesy::fromLocal(from, east, north);
+}
+
+void TestGeodesy::distancesMatchScalar()
+{
+    QRandomGenerator rng(49);
+    for (int round = 0; round < 50; ++round) {
+        const QMapLibre::Coordinate from = randomCoordinate(rng);
+        QMapLibre::Coordinates coords;
+        for (int i = 0; i < 200; ++i) {
+            // 从几米到跨半球
+            coords.append(i % 2 ? randomCoordinate(rng) : randomNear(rng, from, std::pow(10.0, 6.0 * rng.generateDouble())));
+        }
+        coords.append(from);
+
+        const GeoPoints points(coords);
+        QCOMPARE(points.size(), int(coords.size()));
+        const QVector<double> batch = Geodesy::distances(from, points);
+        QCOMPARE(int(batch.size()), int(coords.size()));
+        for (int i = 0; i < coords.size(); ++i) {
+            QVERIFY2(close(batch[i], Geodesy::distance(from, coords[i])), "批量球面距离与 distance 不一致");
+        }
+        QCOMPARE(batch.last(), 0.0);
+    }
+
+    QVERIFY(Geodesy::distances(QMapLibre::Coordinate(30.0, 120.0), GeoPoints()).isEmpty());
+}
+
+void TestGeodesy::indexedDistancesMatchContiguous()
+{
+    QRandomGenerator rng(50);
+    const QMapLibre::Coordinate from(30.0, 120.0);
+    QMapLibre::Coordinates coords;
+    for (int i = 0; i < 500; ++i) {
+        coords.append(randomNear(rng, from, 1e5 * rng.generateDouble()));
+    }
+    const GeoPoints points(coords);
+    const QVector<double> all = Geodesy::distances(from, points);
+
+    // 任意顺序、允许重复的下标
+    QVector<int> indices;
+    for (int i = 0; i < 300; ++i) {
+        indices.append(int(rng.bounded(int(coords.size()))));
+    }
+    QVector<double> subset(indices.size());
+    Geodesy::distances(from, points, indices.constData(), indices.size(), subset.data());
+    for (int i = 0; i < indices.size(); ++i) {
+        QCOMPARE(subset[i], all[indices[i]]);
+    }
+}
+
+void TestGeodesy::fastDistancesMatchScalar()
+{
+    QRandomGenerator rng(51);
+    for (int round = 0; round < 50; ++round) {
+        const QMapLibre::Coordinate from = randomCoordinate(rng);
+        QMapLibre::Coordinates coords;
+        for (int i = 0; i < 200; ++i) {
+            coords.append(randomNear(rng, from, std::pow(10.0, 6.0 * rng.generateDouble())));
+        }
+
+        const QVector<double> batch = Geodesy::fastDistances(from, GeoPoints(coords));
+        for (int i = 0; i < coords.size(); ++i) {
+            QVERIFY2(close(batch[i], Geodesy::fastDistance(from, coords[i])), "批量近似距离与 fastDistance 不一致");
+        }
+    }
+}
+
+void TestGeodesy::fastDistanceErrorBound_data()
+{
+    QTest::addColumn<double>("maxDistance");
+    QTest::addColumn<double>("maxRelativeError");
+
+    QTest::newRow("1 km") << 1e3 << 1e-8;
+    QTest::newRow("10 km") << 1e4 << 1e-6;
+    QTest::newRow("100 km") << 1e5 << 1e-4;
+    QTest::newRow("1000 km") << 1e6 << 1e-2;
+}
+
+void TestGeodesy::fastDistanceErrorBound()
+{
+    QFETCH(double, maxDistance);
+    QFETCH(double, maxRelativeError);
+
+    QRandomGenerator rng(52);
+    for (int round = 0; round < 100; ++round) {
+        const QMapLibre::Coordinate from = randomCoordinate(rng);
+        QMapLibre::Coordinates coords;
+        for (int i = 0; i < 100; ++i) {
+            coords.append(randomNear(rng, from, maxDistance * (0.01 + 0.99 * rng.generateDouble())));
+        }
+
+        const QVector<double> fast = Geodesy::fastDistances(from, GeoPoints(coords));
+        const QVector<double> exact = Geodesy::distances(from, GeoPoints(coords));
+        for (int i = 0; i < coords.size(); ++i) {
+            QVERIFY2(qAbs(fast[i] - exact[i]) <= maxRelativeError * exact[i], "近似距离超出类说明中的误差上界");
+        }
+    }
+}
+
+void TestGeodesy::pathLengthMatchesScalarSum()
+{
+    QRandomGenerator rng(53);
+    QMapLibre::Coordinates coords{QMapLibre::Coordinate(30.0, 120.0)};
+    for (int i = 0; i < 100; ++i) {
+        coords.append(randomNear(rng, coords.last(), 1e4 * rng.generateDouble()));
+    }
+
+    double open = 0.0;
+    for (int i = 0; i + 1 < coords.size(); ++i) {
+        open += Geodesy::distance(coords[i], coords[i + 1]);
+    }
+    const double closing = Geodesy::distance(coords.last(), coords.first());
+
+    const GeoPoints points(coords);
+    QVERIFY(close(Geodesy::pathLength(points, false), open));
+    QVERIFY(close(Geodesy::pathLength(points, true), open + closing));
+    QCOMPARE(Geodesy::pathLength(GeoPoints(coords.mid(0, 1)), true), 0.0);
+}
+
+void TestGeodesy::localRoundTrip()
+{
+    QRandomGenerator rng(54);
+    for (int i = 0; i < 1000; ++i) {
+        const QMapLibre::Coordinate origin = randomCoordinate(rng);
+        const QMapLibre::Coordinate coord = randomNear(rng, origin, 1e4 * rng.generateDouble());
+
+        double east = 0.0;
+        double north = 0.0;
+        Geodesy::toLocal(origin, coord, east, north);
+        const QMapLibre::Coordinate back = Geodesy::fromLocal(origin, east, north);
+        QVERIFY(qAbs(back.first - coord.first) < 1e-9);
+        QVERIFY(qAbs(back.second - coord.second) < 1e-9);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestGeodesy)
+#include "tst_geodesy.moc"
@@ -0,0 +1,174 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "PolygonSimplifier.h"
+#include "GeoBounds.h"
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QtMath>
+
+/**
+ * @brief PolygonSimplifier：简化结果是原始顶点的有序子集，
+ *        每个被去掉的顶点到保留下来的相邻两点连线的距离不超过容差
+ */
+class TestPolygonSimplifier : public QObject {
+    Q_OBJECT
+
+private slots:
+    void removedVerticesWithinTolerance();
+    void keepsSmallAndDegenerateInput();
+    void levelsCoarsenWithLowerZoom();
+
+private:
+    /**
+     * @brief 以 (lat, lon) 为中心、半径随机起伏的多边形（n 个顶点，半径单位：米）
+     */
+    static QMapLibre::Coordinates randomRing(QRandomGenerator &rng, double lat, double lon, int n, double radius);
+
+    /**
+     * @brief 检查 simplified 是否为 original 的有序子集，且被去掉的顶点都在容差内
+     */
+    static bool withinTolerance(const QMapLibre::Coordinates &original,
+                                const QMapLibre::Coordinates &simplified, double tolerance);
+};
+
+QMapLibre::Coordinates TestPolygonSimplifier::randomRing(QRandomGenerator &rng, double lat, double lon, int n, double radius)
+{
+    const double metersPerDegLat = GeoBounds::EARTH_RADIUS * M_PI / 180.0;
+    const double metersPerDegLon = metersPerDegLat * qCos(qDegreesToRadians(lat));
+    QMapLibre::Coordinates ring;
+    for (int i = 0; i < n; ++i) {
+        const double angle = 2.0 * M_PI * i / n;
+        const double r = radius * (1.0 + 0.05 * qSin(angle * 7.0) + 0.01 * rng.generateDouble());
+        ring.append(QMapLibre::Coordinate(lat + r * qSin(angle) / metersPerDegLat,
+                                          lon + r * qCos(angle) / metersPerDegLon));
+    }
+    return ring;
+}
+
+bool TestPolygonSimplifier::withinTolerance(const QMapLibre::Coordinates &original,
+                                            const QMapLibre::Coordinates &simplified, double tolerance)
+{
+    // 与被测实现相同：以第一个顶点为原点的等距圆柱投影（米）
+    const double metersPerDegLat = GeoBounds::EARTH_RADIUS * M_PI / 180.0;
+    const double metersPerDegLon = metersPerDegLat * qCos(qDegreesToRadians(original.first().first));
+    auto project = [&](const QMapLibre::Coordinate &c) {
+        return QPointF((c.second - original.first().second) * metersPerDegLon,
+                       (c.first - original.first().first) * metersPerDegLat);
+    };
+
+    // 保留的顶点在原始顶点中的下标（必须严格递增）
+    QVector<int> kept;
+    int next = 0;
+    for (const QMapLibre::Coordinate &vertex : simplified) {
+        while (next < original.size() && original[next] != vertex) {
+            ++next;
+        }
+        if (next == original.size()) {
+            qWarning() << "简化结果不是原始顶点的有序子集";
+            return false;
+        }
+        kept.append(next++);
+    }
+    if (kept.first() != 0) {
+        qWarning() << "第一个顶点没有保留";
+        return false;
+    }
+
+    // 环首尾相接：最后一个保留点之后回到第一个顶点
+    kept.append(original.size());
+    for (int k = 0; k + 1 < kept.size(); ++k) {
+        const QPointF a = project(original[kept[k]]);
+        const QPointF b = project(original[kept[k + 1] % original.size()]);
+        for (int i = kept[k] + 1; i < kept[k + 1]; ++i) {
+            const QPointF p = project(original[i]);
+            const double ex = b.x() - a.x(), ey = b.y() - a.y();
+            const double lenSq = ex * ex + ey * ey;
+            const double t = lenSq > 0.0 ? qBound(0.0, ((p.x() - a.x()) * ex + (p.y() - a.y()) * ey) / lenSq, 1.0) : 0.0;
+            const double distance = std::hypot(p.x() - a.x() - t * ex, p.y() - a.y() - t * ey);
+            if (distance > tolerance * (1.0 + 1e-9)) {
+                qWarning() << "去掉的顶点超出容差:" << i << distance << tolerance;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void TestPolygonSimplifier::removedVerticesWithinTolerance()
+{
+    QRandomGenerator rng(31);
+    for (int round = 0; round < 200; ++round) {
+        const double lat = -60.0 + 120.0 * rng.generateDouble();
+        const int n = 20 + int(rng.bounded(2000));
+        const QMapLibre::Coordinates ring = randomRing(rng, lat, 120.0, n, 500.0 + 20000.0 * rng.generateDouble());
+
+        for (double tolerance : {0.5, 5.0, 50.0, 500.0}) {
+            const QMapLibre::Coordinates simplified = PolygonSimplifier::simplify(ring, tolerance);
+            QVERIFY(simplified.size() >= 3);
+            QVERIFY(simplified.size() <= ring.size());
+            QVERIFY(withinTolerance(ring, simplified, tolerance));
+        }
+
+        // 首尾闭合的写法结果相同（不含闭合点）
+        QMapLibre::Coordinates closed = ring;
+        closed.append(ring.first());
+        QCOMPARE(PolygonSimplifier::simplify(closed, 5.0), PolygonSimplifier::simplify(ring, 5.0));
+    }
+
+    // 容差远大于多边形时仍保留至少 3 个顶点
+    QRandomGenerator rngLarge(32);
+    const QMapLibre::Coordinates ring = randomRing(rngLarge, 30.0, 120.0, 500, 100.0);
+    QVERIFY(PolygonSimplifier::simplify(ring, 1e6).size() >= 3);
+}
+
+void TestPolygonSimplifier::keepsSmallAndDegenerateInput()
+{
+    const QMapLibre::Coordinates triangle{{30.0, 120.0}, {30.001, 120.0}, {30.0, 120.001}};
+    QCOMPARE(PolygonSimplifier::simplify(triangle, 1e6), triangle);
+
+    QRandomGenerator rng(33);
+    const QMapLibre::Coordinates ring = randomRing(rng, 30.0, 120.0, 100, 1000.0);
+    QCOMPARE(PolygonSimplifier::simplify(ring, 0.0), ring);
+    QCOMPARE(PolygonSimplifier::simplify(ring, -1.0), ring);
+
+    // 不超过 16 个顶点的多边形各级都是原始顶点
+    const QMapLibre::Coordinates small = randomRing(rng, 30.0, 120.0, 16, 1000.0);
+    for (const QMapLibre::Coordinates &level : PolygonSimplifier::buildLevels(small)) {
+        QCOMPARE(level, small);
+    }
+}
+
+void TestPolygonSimplifier::levelsCoarsenWithLowerZoom()
+{
+    QRandomGenerator rng(34);
+    const QMapLibre::Coordinates ring = randomRing(rng, 30.0, 120.0, 5000, 20000.0);
+    const QVector<QMapLibre::Coordinates> levels = PolygonSimplifier::buildLevels(ring);
+    QCOMPARE(int(levels.size()), int(PolygonSimplifier::LEVEL_COUNT));
+    QCOMPARE(levels.last(), ring);
+    QVERIFY(levels.first().size() < ring.size());
+
+    // 每一级在更精细一级上简化，容差为该级适用范围的最大缩放级别下 1 像素对应的米数
+    const double metersPerPixelZ0 = 2.0 * M_PI * GeoBounds::EARTH_RADIUS / 512.0 * qCos(qDegreesToRadians(30.0));
+    for (int level = 0; level + 1 < levels.size(); ++level) {
+        double maxZoom = 0.0;
+        while (PolygonSimplifier::levelForZoom(maxZoom) <= level) {
+            maxZoom += 0.25;
+        }
+        QVERIFY(levels[level].size() <= levels[level + 1].size());
+        QVERIFY(withinTolerance(levels[level + 1], levels[level], metersPerPixelZ0 / qPow(2.0, maxZoom)));
+    }
+
+    // 缩放级别越大，选用的级别越精细
+    int previous = 0;
+    for (double zoom = 0.0; zoom <= 22.0; zoom += 0.25) {
+        const int level = PolygonSimplifier::levelForZoom(zoom);
+        QVERIFY(level >= previous);
+        QVERIFY(level < PolygonSimplifier::LEVEL_COUNT);
+        previous = level;
+    }
+    QCOMPARE(PolygonSimplifier::levelForZoom(22.0), PolygonSimplifier::LEVEL_COUNT - 1);
+}
+
+QTEST_GUILESS_MAIN(TestPolygonSimplifier)
+#include "tst_polygonsimplifier.moc"
@@ -0,0 +1,224 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "PolygonValidator.h"
+#include "RegionManager.h"
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QStringList>
+
+/**
+ * @brief PolygonValidator 与逐对精确判断（整数坐标，O(n²)）对比
+ *
+ * 顶点取在整数网格上（每格 1e-4 度，约 10 m），精确判断全部用整数运算，没有舍入误差；
+ * 小网格上大量出现共线、重合顶点、顶点落在边上等退化情况，正好覆盖容差处理。
+ */
+class TestPolygonValidator : public QObject {
+    Q_OBJECT
+
+private slots:
+    void matchesBruteForce_data();
+    void matchesBruteForce();
+    void repairProducesSimpleParts();
+    void importRepairSplitsBowtie();
+
+private:
+    struct GridPoint {
+        qint64 x;
+        qint64 y;
+        bool operator==(const GridPoint &other) const { return x == other.x && y == other.y; }
+    };
+
+    static int orientation(const GridPoint &a, const GridPoint &b, const GridPoint &c);
+    static bool onSegment(const GridPoint &p, const GridPoint &a, const GridPoint &b);
+    static bool segmentsIntersect(const GridPoint &a, const GridPoint &b, const GridPoint &c, const GridPoint &d);
+
+    /**
+     * @brief 逐对精确判断（规则与 PolygonValidator 相同：相邻边只允许在公共顶点相接，折返无效）
+     */
+    static bool bruteForceSimple(const QVector<GridPoint> &points, bool closed);
+
+    static QVector<GridPoint> randomPoints(QRandomGenerator &rng, int count, int grid);
+    static QMapLibre::Coordinates toCoordinates(const QVector<GridPoint> &points);
+};
+
+int TestPolygonValidator::orientation(const GridPoint &a, const GridPoint &b, const GridPoint &c)
+{
+    const qint64 cross = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    return (cross > 0) - (cross < 0);
+}
+
+bool TestPolygonValidator::onSegment(const GridPoint &p, const GridPoint &a, const GridPoint &b)
+{
+    return qMin(a.x, b.x) <= p.x && p.x <= qMax(a.x, b.x) && qMin(a.y, b.y) <= p.y && p.y <= qMax(a.y, b.y);
+}
+
+bool TestPolygonValidator::segmentsIntersect(const GridPoint &a, const GridPoint &b,
+                                             const GridPoint &c, const GridPoint &d)
+{
+    const int o1 = orientation(a, b, c);
+    const int o2 = orientation(a, b, d);
+    const int o3 = orientation(c, d, a);
+    const int o4 = orientation(c, d, b);
+    if (o1 != o2 && o3 != o4) {
+        return true;
+    }
+    return (o1 == 0 && onSegment(c, a, b)) || (o2 == 0 && onSegment(d, a, b))
+        || (o3 == 0 && onSegment(a, c, d)) || (o4 == 0 && onSegment(b, c, d));
+}
+
+bool TestPolygonValidator::bruteForceSimple(const QVector<GridPoint> &points, bool closed)
+{
+    // 去掉连续重复点和闭合点
+    QVector<GridPoint> q;
+    for (const GridPoint &p : points) {
+        if (q.isEmpty() || !(q.last() == p)) {
+            q.append(p);
+        }
+    }
+    while (closed && q.size() > 1 && q.first() == q.last()) {
+        q.removeLast();
+    }
+
+    const int n = q.size();
+    if (n < (closed ? 3 : 2)) {
+        return !closed;
+    }
+
+    const int edgeCount = closed ? n : n - 1;
+    for (int a = 0; a < edgeCount; ++a) {
+        for (int b = a + 1; b < edgeCount; ++b) {
+            const bool consecutive = (a + 1) % n == b;
+            const bool wrapped = closed && (b + 1) % n == a;
+            if (consecutive || wrapped) {
+                // 相邻边：只检查公共顶点处是否折返（后一条边沿前一条边退回）
+                const int shared = consecutive ? b : a;
+                const GridPoint &prev = q[consecutive ? a : b];
+                const GridPoint &vertex = q[shared];
+                const GridPoint &next = q[(shared + 1) % n];
+                const qint64 dot = (prev.x - vertex.x) * (next.x - vertex.x) + (prev.y - vertex.y) * (next.y - vertex.y);
+                if (orientation(prev, vertex, next) == 0 && dot > 0) {
+                    return false;
+                }
+                continue;
+            }
+            if (segmentsIntersect(q[a], q[(a + 1) % n], q[b], q[(b + 1) % n])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+QVector<TestPolygonValidator::GridPoint> TestPolygonValidator::randomPoints(QRandomGenerator &rng, int count, int grid)
+{
+    QVector<GridPoint> points;
+    for (int i = 0; i < count; ++i) {
+        points.append(GridPoint{qint64(rng.bounded(grid)), qint64(rng.bounded(grid))});
+    }
+    return points;
+}
+
+QMapLibre::Coordinates TestPolygonValidator::toCoordinates(const QVector<GridPoint> &points)
+{
+    QMapLibre::Coordinates coords;
+    for (const GridPoint &p : points) {
+        coords.append(QMapLibre::Coordinate(30.0 + p.y * 1e-4, 120.0 + p.x * 1e-4));
+    }
+    return coords;
+}
+
+void TestPolygonValidator::matchesBruteForce_data()
+{
+    QTest::addColumn<int>("grid");
+    QTest::addColumn<quint32>("seed");
+
+    QTest::newRow("粗网格") << 1000 << 50u;
+    QTest::newRow("细网格（大量退化）") << 8 << 51u;
+    QTest::newRow("中网格") << 40 << 52u;
+}
+
+void TestPolygonValidator::matchesBruteForce()
+{
+    QFETCH(int, grid);
+    QFETCH(quint32, seed);
+
+    QRandomGenerator rng(seed);
+    int invalid = 0;
+    for (int i = 0; i < 20000; ++i) {
+        const bool closed = i % 3 != 0;
+        const QVector<GridPoint> points = randomPoints(rng, 3 + int(rng.bounded(9)), grid);
+        const QMapLibre::Coordinates coords = toCoordinates(points);
+
+        const bool expected = bruteForceSimple(points, closed);
+        PolygonValidator::Intersection hit;
+        const bool actual = closed ? PolygonValidator::isSimple(coords, &hit)
+                                   : PolygonValidator::isSimplePolyline(coords, &hit);
+        if (actual != expected) {
+            QStringList text;
+            for (const GridPoint &p : points) {
+                text.append(QString("(%1,%2)").arg(p.x).arg(p.y));
+            }
+            qWarning() << "闭合:" << closed << "精确:" << expected << "扫描线:" << actual << text.join(" ");
+        }
+        QCOMPARE(actual, expected);
+        if (!actual) {
+            ++invalid;
+        }
+    }
+    // 两类结果都要有足够的样本
+    QVERIFY(invalid > 1000);
+    QVERIFY(invalid < 19000);
+}
+
+void TestPolygonValidator::repairProducesSimpleParts()
+{
+    QRandomGenerator rng(53);
+    int repaired = 0;
+    for (int i = 0; i < 5000; ++i) {
+        const int grid = i % 2 ? 1000 : 20;
+        const QMapLibre::Coordinates coords = toCoordinates(randomPoints(rng, 4 + int(rng.bounded(10)), grid));
+
+        int unrepaired = -1;
+        const QVector<QMapLibre::Coordinates> parts = PolygonValidator::repair(coords, &unrepaired);
+        QVERIFY(unrepaired >= 0);
+        for (const QMapLibre::Coordinates &part : parts) {
+            QVERIFY(PolygonValidator::isSimple(part));
+        }
+        if (PolygonValidator::isSimple(coords)) {
+            QCOMPARE(int(parts.size()), 1);
+            QCOMPARE(unrepaired, 0);
+        } else {
+            ++repaired;
+        }
+    }
+    QVERIFY(repaired > 1000);
+}
+
+void TestPolygonValidator::importRepairSplitsBowtie()
+{
+    // 8 字形：两个三角形在中心相交
+    RegionSpec bowtie;
+    bowtie.type = RegionType::TaskRegion;
+    bowtie.name = "蝴蝶";
+    bowtie.vertices = toCoordinates({{0, 0}, {100, 100}, {100, 0}, {0, 100}});
+
+    RegionSpec uav;
+    uav.type = RegionType::UAV;
+    uav.name = "无人机";
+    uav.coordinate = QMapLibre::Coordinate(30.0, 120.0);
+
+    QStringList notes;
+    const QVector<RegionSpec> specs = RegionManager::repairSelfIntersecting({bowtie, uav}, &notes);
+    QCOMPARE(int(specs.size()), 3);
+    QCOMPARE(int(notes.size()), 1);
+    QCOMPARE(specs[0].name, QString("蝴蝶-1"));
+    QCOMPARE(specs[1].name, QString("蝴蝶-2"));
+    QVERIFY(specs[2].type == RegionType::UAV);
+    for (const RegionSpec &spec : specs) {
+        QVERIFY(RegionManager::validateSpec(spec));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestPolygonValidator)
+#include "tst_polygonvalidator.moc"
@@ -0,0 +1,146 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "RegionArena.h"
+#include <QtTest>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QSet>
+
+/**
+ * @brief RegionArena：旧ID失效、代数用尽后槽位退役、显示编号与ID分离、指针稳定
+ */
+class TestRegionArena : public QObject {
+    Q_OBJECT
+
+private slots:
+    void staleIdRejected();
+    void generationWrapDoesNotReviveIds();
+    void numbersAreIndependentOfIds();
+    void pointersStayValid();
+    void clearInvalidatesIds();
+};
+
+void TestRegionArena::staleIdRejected()
+{
+    RegionArena arena;
+    Region *a = arena.create(RegionType::UAV);
+    Region *b = arena.create(RegionType::NoFlyZone);
+    const int idA = a->id();
+    const int idB = b->id();
+    QCOMPARE(idA, 1);
+    QCOMPARE(idB, 2);
+    QVERIFY(arena.get(idA)->type() == RegionType::UAV);
+
+    QVERIFY(arena.destroy(idA));
+    QVERIFY(!arena.contains(idA));
+    QVERIFY(!arena.destroy(idA));
+
+    // 复用 idA 的槽位，旧ID不指向新区域
+    Region *c = arena.create(RegionType::LoiterPoint);
+    QVERIFY(c->id() != idA);
+    QVERIFY(c->id() > 0);
+    QVERIFY(arena.get(idA) == nullptr);
+    QCOMPARE(arena.get(c->id()), c);
+    QCOMPARE(arena.get(idB), b);
+    QCOMPARE(arena.size(), 2);
+
+    QVERIFY(!arena.contains(0));
+    QVERIFY(!arena.contains(-1));
+    QVERIFY(!arena.contains(1000));
+}
+
+void TestRegionArena::generationWrapDoesNotReviveIds()
+{
+    RegionArena arena;
+    const int first = arena.create(RegionType::UAV)->id();
+    QSet<int> issued{first};
+
+    // 同一个槽位反复删除、创建，直到代数用尽、槽位退役
+    int id = first;
+    for (int i = 0; i < 500; ++i) {
+        QVERIFY(arena.destroy(id));
+        id = arena.create(RegionType::UAV)->id();
+        QVERIFY(id > 0);
+        QVERIFY2(!issued.contains(id), "区域ID在代数回绕后被重复发出");
+        issued.insert(id);
+        QVERIFY(!arena.contains(first));
+    }
+    QCOMPARE(arena.size(), 1);
+}
+
+void TestRegionArena::numbersAreIndependentOfIds()
+{
+    RegionArena arena;
+    QSet<int> numbers;
+    int lastNumber = 0;
+    for (int i = 0; i < 300; ++i) {
+        Region *region = arena.create(RegionType::LoiterPoint);
+        // 显示编号按创建顺序递增，删除后不复用，也不受槽位代数影响
+        QCOMPARE(region->number(), lastNumber + 1);
+        lastNumber = region->number();
+        QVERIFY(!numbers.contains(region->number()));
+        numbers.insert(region->number());
+        if (i % 3 != 0) {
+            QVERIFY(arena.destroy(region->id()));
+        }
+    }
+    QCOMPARE(arena.size(), 100);
+}
+
+void TestRegionArena::pointersStayValid()
+{
+    QRandomGenerator rng(35);
+    RegionArena arena;
+    QHash<int, Region*> pointers;   // ID -> 创建时返回的指针
+
+    for (int i = 0; i < 5000; ++i) {
+        if (pointers.isEmpty() || rng.bounded(4) != 0) {
+            Region *region = arena.create(RegionType::TaskRegion);
+            region->setName(QString::number(region->id()));
+            pointers.insert(region->id(), region);
+        } else {
+            const int id = pointers.keys().at(rng.bounded(int(pointers.size())));
+            QVERIFY(arena.destroy(id));
+            pointers.remove(id);
+        }
+    }
+
+    // 分块存储：跨块增长后早先返回的指针仍指向原区域
+    QCOMPARE(arena.size(), int(pointers.size()));
+    for (auto it = pointers.constBegin(); it != pointers.constEnd(); ++it) {
+        QCOMPARE(arena.get(it.key()), it.value());
+        QCOMPARE(it.value()->name(), QString::number(it.key()));
+    }
+
+    // 遍历恰好访问每个有效区域一次
+    int visited = 0;
+    for (Region *region : arena) {
+        QVERIFY(pointers.contains(region->id()));
+        ++visited;
+    }
+    QCOMPARE(visited, int(pointers.size()));
+}
+
+void TestRegionArena::clearInvalidatesIds()
+{
+    RegionArena arena;
+    QVector<int> ids;
+    for (int i = 0; i < 100; ++i) {
+        ids.append(arena.create(RegionType::UAV)->id());
+    }
+
+    arena.clear();
+    QVERIFY(arena.isEmpty());
+    QVERIFY(arena.begin() == arena.end());
+    for (int id : ids) {
+        QVERIFY(!arena.contains(id));
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        QVERIFY(!ids.contains(arena.create(RegionType::UAV)->id()));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestRegionArena)
+#include "tst_regionarena.moc"
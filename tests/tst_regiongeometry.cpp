@@ -0,0 +1,179 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "RegionGeometry.h"
+#include "PolygonGeometry.h"
+#include <QtTest>
+#include <QRandomGenerator>
+
+/**
+ * @brief RegionGeometry：面积、周长、质心与已知值一致，锚点总在区域内部
+ *
+ * 锚点重点覆盖质心落在外部的凹多边形，以及比不可达极点默认精度还窄的细长走廊。
+ */
+class TestRegionGeometry : public QObject {
+    Q_OBJECT
+
+private slots:
+    void rectangleMatchesKnownValues();
+    void pointAndCircleAnchorAtCenter();
+    void concaveAnchorInside();
+    void thinCorridorAnchorInside();
+    void randomPolygonAnchorsInside();
+
+private:
+    /**
+     * @brief 以 (30°, 120°) 为原点的东/北偏移（米）-> 经纬度
+     */
+    static QMapLibre::Coordinates fromMeters(const QVector<QPointF> &points);
+
+    static bool anchorInside(const QMapLibre::Coordinates &vertices);
+};
+
+QMapLibre::Coordinates TestRegionGeometry::fromMeters(const QVector<QPointF> &points)
+{
+    const double metersPerDegLat = GeoBounds::EARTH_RADIUS * M_PI / 180.0;
+    const double metersPerDegLon = metersPerDegLat * qCos(qDegreesToRadians(30.0));
+    QMapLibre::Coordinates coords;
+    for (const QPointF &p : points) {
+        coords.append(QMapLibre::Coordinate(30.0 + p.y() / metersPerDegLat, 120.0 + p.x() / metersPerDegLon));
+    }
+    return coords;
+}
+
+bool TestRegionGeometry::anchorInside(const QMapLibre::Coordinates &vertices)
+{
+    const RegionGeometry geometry = RegionGeometry::fromPolygon(vertices);
+    const PolygonGeometry polygon(vertices);
+    if (!polygon.contains(geometry.anchor)) {
+        qWarning() << "锚点在多边形外:" << geometry.anchor.first << geometry.anchor.second;
+        return false;
+    }
+    // 质心在内部时锚点就是质心
+    return !polygon.contains(geometry.centroid) || geometry.anchor == geometry.centroid;
+}
+
+void TestRegionGeometry::rectangleMatchesKnownValues()
+{
+    // 2 km × 1 km 的矩形
+    const QMapLibre::Coordinates vertices = fromMeters({{-1000, -500}, {1000, -500}, {1000, 500}, {-1000, 500}});
+    const RegionGeometry geometry = RegionGeometry::fromPolygon(vertices);
+
+    QVERIFY(qAbs(geometry.area - 2e6) < 2e6 * 1e-3);
+    QVERIFY(qAbs(geometry.perimeter - 6e3) < 6e3 * 1e-3);
+    QVERIFY(qAbs(geometry.centroid.first - 30.0) < 1e-9);
+    QVERIFY(qAbs(geometry.centroid.second - 120.0) < 1e-9);
+    QCOMPARE(geometry.anchor, geometry.centroid);
+    for (const QMapLibre::Coordinate &vertex : vertices) {
+        QVERIFY(geometry.bounds.contains(vertex));
+    }
+
+    // 首尾闭合的写法结果相同
+    QMapLibre::Coordinates closed = vertices;
+    closed.append(vertices.first());
+    QVERIFY(qAbs(RegionGeometry::fromPolygon(closed).area - geometry.area) < 1e-6);
+}
+
+void TestRegionGeometry::pointAndCircleAnchorAtCenter()
+{
+    const QMapLibre::Coordinate center(30.0, 120.0);
+    QCOMPARE(RegionGeometry::fromPoint(center).anchor, center);
+
+    const RegionGeometry circle = RegionGeometry::fromCircle(center, 500.0);
+    QCOMPARE(circle.anchor, center);
+    QVERIFY(qAbs(circle.area - M_PI * 500.0 * 500.0) < 1e-6);
+}
+
+void TestRegionGeometry::concaveAnchorInside()
+{
+    // C 形：质心落在缺口里
+    const QMapLibre::Coordinates shapeC = fromMeters({{0, 0}, {1000, 0}, {1000, 200}, {200, 200},
+                                                      {200, 800}, {1000, 800}, {1000, 1000}, {0, 1000}});
+    const RegionGeometry geometry = RegionGeometry::fromPolygon(shapeC);
+    const PolygonGeometry polygon(shapeC);
+    QVERIFY(!polygon.contains(geometry.centroid));
+    QVERIFY(polygon.contains(geometry.anchor));
+
+    // 指定精度时结果同样在内部
+    const QMapLibre::Coordinate pole = polygon.poleOfInaccessibility(1.0);
+    QVERIFY(polygon.contains(pole));
+}
+
+void TestRegionGeometry::thinCorridorAnchorInside()
+{
+    // L 形走廊：两臂长 2~10 km、宽 5~90 m，多个旋转角度。包围盒边长为公里级，
+    // 默认精度（较短边的 1%）可能大于走廊宽度，初始方格的格心全部落在走廊外
+    int checked = 0;
+    for (double width = 5.0; width <= 90.0; width += 5.0) {
+        for (double arm1 = 2000.0; arm1 <= 10000.0; arm1 += 2000.0) {
+            for (double arm2 = 2000.0; arm2 <= 10000.0; arm2 += 4000.0) {
+                for (int step = 0; step < 12; ++step) {
+                    const double a = step * M_PI / 12.0;
+                    QVector<QPointF> points;
+                    for (const QPointF &p : QVector<QPointF>{{0, 0}, {arm1, 0}, {arm1, width}, {width, width},
+                                                             {width, arm2}, {0, arm2}}) {
+                        points.append(QPointF(p.x() * qCos(a) - p.y() * qSin(a), p.x() * qSin(a) + p.y() * qCos(a)));
+                    }
+                    const QMapLibre::Coordinates shapeL = fromMeters(points);
+                    QVERIFY(anchorInside(shapeL));
+                    const PolygonGeometry polygon(shapeL);
+                    QVERIFY(polygon.contains(polygon.poleOfInaccessibility()));
+                    ++checked;
+                }
+            }
+        }
+    }
+    QCOMPARE(checked, 18 * 5 * 3 * 12);
+
+    // 100 km × 1 m 的细长矩形：较长边与较短边之比 1e5，初始网格按上限划分
+    const QMapLibre::Coordinates sliver = fromMeters({{0, 0}, {100000, 0}, {100000, 1}, {0, 1}});
+    const PolygonGeometry polygonSliver(sliver);
+    QVERIFY(polygonSliver.contains(polygonSliver.poleOfInaccessibility()));
+
+    // 面积为 0 的退化多边形返回包围盒中心，不会死循环
+    const PolygonGeometry degenerate(fromMeters({{0, 0}, {1000, 0}, {2000, 0}}));
+    QVERIFY(degenerate.bounds().contains(degenerate.poleOfInaccessibility()));
+}
+
+void TestRegionGeometry::randomPolygonAnchorsInside()
+{
+    // 一半是按角度排序的星形多边形，一半是扇环（C 形、月牙形），顶点半径随机起伏；
+    // 扇环张角越大、越细，质心越容易落在外部
+    QRandomGenerator rng(42);
+    int centroidOutside = 0;
+    for (int i = 0; i < 3000; ++i) {
+        QVector<QPointF> points;
+        const int count = 3 + int(rng.bounded(30));
+        if (i % 2 == 0) {
+            for (int k = 0; k < count; ++k) {
+                const double angle = 2.0 * M_PI * (k + 0.8 * rng.generateDouble()) / count;
+                const double r = 1000.0 * (1.0 - 0.9 * rng.generateDouble());
+                points.append(QPointF(r * qCos(angle), r * qSin(angle)));
+            }
+        } else {
+            const double sweep = qDegreesToRadians(200.0 + 140.0 * rng.generateDouble());
+            const double thickness = 0.02 + 0.3 * rng.generateDouble();
+            for (int k = 0; k <= count; ++k) {
+                const double angle = sweep * k / count;
+                const double r = 1000.0 * (1.0 - 0.05 * rng.generateDouble());
+                points.append(QPointF(r * qCos(angle), r * qSin(angle)));
+            }
+            for (int k = count; k >= 0; --k) {
+                const double angle = sweep * k / count;
+                const double r = 1000.0 * (1.0 - thickness) * (1.0 - 0.05 * rng.generateDouble());
+                points.append(QPointF(r * qCos(angle), r * qSin(angle)));
+            }
+        }
+
+        const QMapLibre::Coordinates vertices = fromMeters(points);
+        QVERIFY(anchorInside(vertices));
+        if (!PolygonGeometry(vertices).contains(RegionGeometry::fromPolygon(vertices).centroid)) {
+            ++centroidOutside;
+        }
+    }
+    // 足够多的样本质心落在外部
+    QVERIFY(centroidOutside > 500);
+}
+
+QTEST_GUILESS_MAIN(TestRegionGeometry)
+#include "tst_regiongeometry.moc"
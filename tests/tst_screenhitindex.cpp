@@ -0,0 +1,230 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "ScreenHitIndex.h"
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QtMath>
+#include <limits>
+
+/**
+ * @brief ScreenHitIndex：网格分桶后的 pick() 与逐个检查全部形状的结果一致
+ *
+ * 形状包括图标、圆、多边形，以及覆盖网格过多、单独存放的大区域；
+ * 坐标覆盖屏幕外（负值）的部分，同一索引上重复查询以覆盖访问标记的复用。
+ */
+class TestScreenHitIndex : public QObject {
+    Q_OBJECT
+
+private slots:
+    void pickMatchesBruteForce();
+    void pointsTakePriority();
+    void nestedAreasPickInner();
+    void clearResets();
+
+private:
+    struct Shape {
+        quint32 id;
+        int kind;                   // 0: 图标 1: 圆 2: 多边形
+        QPointF center;
+        double radius;
+        QVector<QPointF> ring;
+    };
+
+    /**
+     * @brief 点到形状的像素距离（在形状内为 0）
+     */
+    static double distanceTo(const Shape &shape, const QPointF &pixel);
+
+    /**
+     * @brief 逐个检查全部形状：容差内的图标优先，否则取最近的区域，距离相同取包围盒较小的
+     */
+    static quint32 bruteForcePick(const QVector<Shape> &shapes, const QPointF &pixel, double tolerance);
+
+    static void addTo(ScreenHitIndex &index, const Shape &shape);
+    static QRectF boundsOf(const Shape &shape);
+};
+
+double TestScreenHitIndex::distanceTo(const Shape &shape, const QPointF &pixel)
+{
+    if (shape.kind != 2) {
+        return qMax(0.0, std::hypot(pixel.x() - shape.center.x(), pixel.y() - shape.center.y()) - shape.radius);
+    }
+
+    const int n = shape.ring.size();
+    bool inside = false;
+    double minDistSq = std::numeric_limits<double>::max();
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        const QPointF &a = shape.ring[j];
+        const QPointF &b = shape.ring[i];
+        if ((b.y() > pixel.y()) != (a.y() > pixel.y()) &&
+            pixel.x() < (a.x() - b.x()) * (pixel.y() - b.y()) / (a.y() - b.y()) + b.x()) {
+            inside = !inside;
+        }
+        double ex = b.x() - a.x();
+        double ey = b.y() - a.y();
+        double wx = pixel.x() - a.x();
+        double wy = pixel.y() - a.y();
+        double lenSq = ex * ex + ey * ey;
+        double t = lenSq > 0.0 ? qBound(0.0, (wx * ex + wy * ey) / lenSq, 1.0) : 0.0;
+        double dx = wx - t * ex;
+        double dy = wy - t * ey;
+        minDistSq = qMin(minDistSq, dx * dx + dy * dy);
+    }
+    return inside ? 0.0 : std::sqrt(minDistSq);
+}
+
+QRectF TestScreenHitIndex::boundsOf(const Shape &shape)
+{
+    if (shape.kind != 2) {
+        return QRectF(shape.center.x() - shape.radius, shape.center.y() - shape.radius,
+                      2 * shape.radius, 2 * shape.radius);
+    }
+    double minX = shape.ring[0].x(), maxX = minX, minY = shape.ring[0].y(), maxY = minY;
+    for (const QPointF &p : shape.ring) {
+        minX = qMin(minX, p.x());
+        maxX = qMax(maxX, p.x());
+        minY = qMin(minY, p.y());
+        maxY = qMax(maxY, p.y());
+    }
+    return QRectF(minX, minY, maxX - minX, maxY - minY);
+}
+
+quint32 TestScreenHitIndex::bruteForcePick(const QVector<Shape> &shapes, const QPointF &pixel, double tolerance)
+{
+    quint32 nearestPoint = 0;
+    quint32 nearestArea = 0;
+    double minPointDistance = tolerance;
+    double minAreaDistance = tolerance;
+    double nearestAreaSize = std::numeric_limits<double>::max();
+    for (const Shape &shape : shapes) {
+        const double distance = distanceTo(shape, pixel);
+        if (shape.kind == 0) {
+            if (distance <= minPointDistance) {
+                minPointDistance = distance;
+                nearestPoint = shape.id;
+            }
+        } else {
+            const QRectF bounds = boundsOf(shape);
+            const double area = bounds.width() * bounds.height();
+            if (distance < minAreaDistance || (distance == minAreaDistance && area < nearestAreaSize)) {
+                minAreaDistance = distance;
+                nearestAreaSize = area;
+                nearestArea = shape.id;
+            }
+        }
+    }
+    return nearestPoint != 0 ? nearestPoint : nearestArea;
+}
+
+void TestScreenHitIndex::addTo(ScreenHitIndex &index, const Shape &shape)
+{
+    switch (shape.kind) {
+    case 0:
+        index.addPoint(shape.id, shape.center, shape.radius);
+        break;
+    case 1:
+        index.addCircle(shape.id, shape.center, shape.radius);
+        break;
+    default:
+        index.addPolygon(shape.id, shape.ring);
+        break;
+    }
+}
+
+void TestScreenHitIndex::pickMatchesBruteForce()
+{
+    QRandomGenerator rng(33);
+    for (int round = 0; round < 20; ++round) {
+        // 屏幕约 1920 × 1080，形状可以部分或全部在屏幕外
+        QVector<Shape> shapes;
+        const int count = 50 + int(rng.bounded(400));
+        for (int i = 0; i < count; ++i) {
+            Shape shape;
+            shape.id = quint32(i + 1);
+            shape.kind = int(rng.bounded(3));
+            shape.center = QPointF(-200.0 + rng.generateDouble() * 2320.0, -200.0 + rng.generateDouble() * 1480.0);
+            // 约 5% 的区域大到覆盖几百个网格
+            const bool large = shape.kind != 0 && rng.bounded(20) == 0;
+            shape.radius = shape.kind == 0 ? 8.0 + rng.generateDouble() * 8.0
+                                           : (large ? 800.0 : 5.0) + rng.generateDouble() * 150.0;
+            if (shape.kind == 2) {
+                const int n = 3 + int(rng.bounded(20));
+                for (int k = 0; k < n; ++k) {
+                    const double angle = 2.0 * M_PI * (k + 0.8 * rng.generateDouble()) / n;
+                    const double r = shape.radius * (0.3 + 0.7 * rng.generateDouble());
+                    shape.ring.append(shape.center + QPointF(r * qCos(angle), r * qSin(angle)));
+                }
+            }
+            shapes.append(shape);
+        }
+
+        ScreenHitIndex index;
+        for (const Shape &shape : shapes) {
+            addTo(index, shape);
+        }
+        QCOMPARE(index.size(), int(shapes.size()));
+
+        for (int query = 0; query < 2000; ++query) {
+            const QPointF pixel(-300.0 + rng.generateDouble() * 2520.0, -300.0 + rng.generateDouble() * 1680.0);
+            const double tolerance = query % 4 == 0 ? 0.0 : rng.generateDouble() * 40.0;
+            const quint32 picked = index.pick(pixel, tolerance);
+            const quint32 expected = bruteForcePick(shapes, pixel, tolerance);
+            if (picked != expected) {
+                // 点击位置同时落在几个重叠的图标上（距离都为 0）时哪个都可以，
+                // 取决于网格的遍历顺序；除此之外结果必须相同
+                QVERIFY(picked != 0 && expected != 0);
+                const Shape &a = shapes[int(picked) - 1];
+                const Shape &b = shapes[int(expected) - 1];
+                QVERIFY(a.kind == 0 && b.kind == 0);
+                QCOMPARE(distanceTo(a, pixel), distanceTo(b, pixel));
+            }
+        }
+    }
+}
+
+void TestScreenHitIndex::pointsTakePriority()
+{
+    ScreenHitIndex index;
+    index.addCircle(1, QPointF(100, 100), 50);
+    index.addPoint(2, QPointF(120, 100), 10);
+
+    // 在圆内、也在图标容差内：选图标
+    QCOMPARE(index.pick(QPointF(100, 100), 15), quint32(2));
+    // 超出图标容差：选圆
+    QCOMPARE(index.pick(QPointF(80, 100), 5), quint32(1));
+    // 都超出容差
+    QCOMPARE(index.pick(QPointF(300, 300), 5), quint32(0));
+}
+
+void TestScreenHitIndex::nestedAreasPickInner()
+{
+    // 两个嵌套的多边形，点击位置同时在两者内部时选较小的
+    ScreenHitIndex index;
+    index.addPolygon(1, {QPointF(0, 0), QPointF(400, 0), QPointF(400, 400), QPointF(0, 400)});
+    index.addPolygon(2, {QPointF(100, 100), QPointF(200, 100), QPointF(200, 200), QPointF(100, 200), QPointF(100, 100)});
+    QCOMPARE(index.pick(QPointF(150, 150), 10), quint32(2));
+    QCOMPARE(index.pick(QPointF(300, 300), 10), quint32(1));
+
+    // 不足 3 个顶点的多边形不登记
+    index.addPolygon(3, {QPointF(0, 0), QPointF(10, 10)});
+    QCOMPARE(index.size(), 2);
+}
+
+void TestScreenHitIndex::clearResets()
+{
+    ScreenHitIndex index;
+    index.addPoint(1, QPointF(10, 10), 5);
+    QCOMPARE(index.pick(QPointF(10, 10), 5), quint32(1));
+
+    index.clear();
+    QCOMPARE(index.size(), 0);
+    QCOMPARE(index.pick(QPointF(10, 10), 5), quint32(0));
+
+    // 清空后重新构建，下标和访问标记从头开始
+    index.addCircle(7, QPointF(10, 10), 5);
+    QCOMPARE(index.pick(QPointF(10, 10), 5), quint32(7));
+}
+
+QTEST_GUILESS_MAIN(TestScreenHitIndex)
+#include "tst_screenhitindex.moc"
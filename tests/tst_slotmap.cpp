@@ -0,0 +1,127 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "SlotMap.h"
+#include <QtTest>
+#include <QHash>
+#include <QRandomGenerator>
+
+/**
+ * @brief SlotMap：句柄稳定、删除后旧句柄失效、代数用尽后槽位退役
+ */
+class TestSlotMap : public QObject {
+    Q_OBJECT
+
+private slots:
+    void staleHandleRejected();
+    void generationWrapDoesNotReviveHandles();
+    void clearInvalidatesHandles();
+    void randomOperationsMatchModel();
+};
+
+void TestSlotMap::staleHandleRejected()
+{
+    SlotMap<int> map;
+    SlotMap<int>::Handle a = map.insert(1);
+    SlotMap<int>::Handle b = map.insert(2);
+    QVERIFY(a != 0 && b != 0 && a != b);
+
+    QVERIFY(map.remove(a));
+    QVERIFY(!map.contains(a));
+    QVERIFY(map.get(a) == nullptr);
+    QVERIFY(!map.remove(a));
+
+    // 复用 a 的槽位，旧句柄仍然无效
+    SlotMap<int>::Handle c = map.insert(3);
+    QVERIFY(c != a);
+    QVERIFY(map.get(a) == nullptr);
+    QCOMPARE(*map.get(c), 3);
+    QCOMPARE(*map.get(b), 2);
+    QCOMPARE(map.size(), 2);
+
+    QVERIFY(!map.contains(0));
+    QVERIFY(!map.contains(0x00FFFFFF));
+}
+
+void TestSlotMap::generationWrapDoesNotReviveHandles()
+{
+    SlotMap<int> map;
+    const SlotMap<int>::Handle first = map.insert(0);
+    QSet<SlotMap<int>::Handle> issued{first};
+
+    // 同一个槽位反复删除、插入，直到代数用尽、槽位退役
+    SlotMap<int>::Handle handle = first;
+    for (int i = 1; i < 1000; ++i) {
+        QVERIFY(map.remove(handle));
+        handle = map.insert(i);
+        QVERIFY2(!issued.contains(handle), "句柄在代数回绕后被重复发出");
+        issued.insert(handle);
+        QVERIFY(!map.contains(first));
+    }
+    QCOMPARE(map.size(), 1);
+    QCOMPARE(*map.get(handle), 999);
+}
+
+void TestSlotMap::clearInvalidatesHandles()
+{
+    SlotMap<QString> map;
+    QVector<SlotMap<QString>::Handle> handles;
+    for (int i = 0; i < 10; ++i) {
+        handles.append(map.insert(QString::number(i)));
+    }
+
+    map.clear();
+    QVERIFY(map.isEmpty());
+    for (SlotMap<QString>::Handle handle : handles) {
+        QVERIFY(!map.contains(handle));
+    }
+
+    // 清空后复用槽位，新句柄与旧句柄不同
+    for (int i = 0; i < 10; ++i) {
+        QVERIFY(!handles.contains(map.insert(QString::number(i))));
+    }
+    QCOMPARE(map.size(), 10);
+}
+
+void TestSlotMap::randomOperationsMatchModel()
+{
+    QRandomGenerator rng(28);
+    SlotMap<int> map;
+    QHash<SlotMap<int>::Handle, int> model;    // 有效句柄 -> 值
+    QVector<SlotMap<int>::Handle> live;        // 有效句柄（随机挑选删除对象）
+    QVector<SlotMap<int>::Handle> removed;     // 已删除的句柄
+
+    for (int i = 0; i < 20000; ++i) {
+        if (live.isEmpty() || rng.bounded(3) != 0) {
+            SlotMap<int>::Handle handle = map.insert(i);
+            QVERIFY(!model.contains(handle));
+            model.insert(handle, i);
+            live.append(handle);
+        } else {
+            const int pick = rng.bounded(int(live.size()));
+            const SlotMap<int>::Handle handle = live[pick];
+            live[pick] = live.last();
+            live.removeLast();
+            QVERIFY(map.remove(handle));
+            model.remove(handle);
+            removed.append(handle);
+        }
+    }
+
+    QCOMPARE(map.size(), int(model.size()));
+    for (auto it = model.constBegin(); it != model.constEnd(); ++it) {
+        QVERIFY(map.get(it.key()) != nullptr);
+        QCOMPARE(*map.get(it.key()), it.value());
+    }
+    for (SlotMap<int>::Handle handle : removed) {
+        QVERIFY(!map.contains(handle));
+    }
+
+    // 稠密遍历与句柄一一对应
+    for (int i = 0; i < map.size(); ++i) {
+        QCOMPARE(model.value(map.handleAt(i)), map.valueAt(i));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestSlotMap)
+#include "tst_slotmap.moc"
@@ -0,0 +1,273 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "TaskManager.h"
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QtMath>
+
+/**
+ * @brief 快照隔离：获取快照后继续编辑区域和任务，旧快照内容保持获取时的状态，
+ *        新快照与管理器当前状态一致
+ */
+class TestSnapshot : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void oldSnapshotsUnaffectedByEdits();
+    void unchangedStateKeepsVersion();
+
+private:
+    /**
+     * @brief 获取快照时的期望内容（逐字段深复制，不与管理器共享）
+     */
+    struct State {
+        QHash<int, RegionSpec> regions;
+        QHash<int, QString> taskNames;
+        QHash<int, bool> taskVisible;
+        QHash<int, QSet<int>> taskRegions;
+    };
+
+    State capture() const;
+    static bool sameSpec(const RegionSpec &a, const RegionSpec &b);
+
+    /**
+     * @brief 快照内容与期望是否一致（不一致时输出第一处差异）
+     */
+    static bool matches(const TaskSnapshot &snapshot, const State &state);
+
+    RegionSpec randomSpec();
+    void randomEdits();
+
+    QRandomGenerator m_rng{41};
+    RegionManager *m_regions = nullptr;
+    TaskManager *m_tasks = nullptr;
+};
+
+void TestSnapshot::init()
+{
+    m_rng.seed(41);
+    m_regions = new RegionManager(nullptr);
+    m_tasks = new TaskManager(m_regions);
+}
+
+void TestSnapshot::cleanup()
+{
+    delete m_tasks;
+    delete m_regions;
+    m_tasks = nullptr;
+    m_regions = nullptr;
+}
+
+TestSnapshot::State TestSnapshot::capture() const
+{
+    State state;
+    for (const Region *region : m_regions->getAllRegions()) {
+        RegionSpec spec = RegionManager::specOf(region);
+        // 深复制，避免与区域共享顶点数据
+        spec.vertices = QMapLibre::Coordinates(spec.vertices.cbegin(), spec.vertices.cend());
+        state.regions.insert(region->id(), spec);
+    }
+    for (const Task *task : m_tasks->getAllTasks()) {
+        state.taskNames.insert(task->id(), task->name());
+        state.taskVisible.insert(task->id(), task->isVisible());
+        state.taskRegions.insert(task->id(), task->regionIds());
+    }
+    return state;
+}
+
+bool TestSnapshot::sameSpec(const RegionSpec &a, const RegionSpec &b)
+{
+    return a.type == b.type && a.name == b.name && a.coordinate == b.coordinate
+        && a.vertices == b.vertices && a.radius == b.radius && a.color == b.color
+        && a.shape == b.shape && a.terrainType == b.terrainType && a.visible == b.visible;
+}
+
+bool TestSnapshot::matches(const TaskSnapshot &snapshot, const State &state)
+{
+    const RegionSnapshot &regions = snapshot.regions();
+    if (regions.size() != state.regions.size()) {
+        qWarning() << "区域数不一致:" << regions.size() << state.regions.size();
+        return false;
+    }
+    for (auto it = state.regions.cbegin(); it != state.regions.cend(); ++it) {
+        const RegionSpec *spec = regions.find(it.key());
+        if (!spec || !sameSpec(*spec, it.value())) {
+            qWarning() << "区域不一致:" << it.key();
+            return false;
+        }
+    }
+
+    if (snapshot.tasks().size() != state.taskNames.size()) {
+        qWarning() << "任务数不一致:" << snapshot.tasks().size() << state.taskNames.size();
+        return false;
+    }
+    QHash<int, QSet<int>> referencing;
+    for (auto it = state.taskNames.cbegin(); it != state.taskNames.cend(); ++it) {
+        const Task *task = snapshot.task(it.key());
+        if (!task || task->name() != it.value() || task->isVisible() != state.taskVisible.value(it.key())
+            || task->regionIds() != state.taskRegions.value(it.key())) {
+            qWarning() << "任务不一致:" << it.key();
+            return false;
+        }
+        for (int regionId : task->regionIds()) {
+            referencing[regionId].insert(it.key());
+        }
+    }
+    for (auto it = referencing.cbegin(); it != referencing.cend(); ++it) {
+        QVector<int> expected(it.value().cbegin(), it.value().cend());
+        std::sort(expected.begin(), expected.end());
+        if (snapshot.tasksReferencing(it.key()) != expected) {
+            qWarning() << "引用区域的任务不一致:" << it.key();
+            return false;
+        }
+    }
+    return true;
+}
+
+RegionSpec TestSnapshot::randomSpec()
+{
+    RegionSpec spec;
+    const QMapLibre::Coordinate center(30.0 + m_rng.generateDouble() * 0.1, 120.0 + m_rng.generateDouble() * 0.1);
+    switch (m_rng.bounded(3)) {
+    case 0:
+        spec.type = RegionType::NoFlyZone;
+        spec.coordinate = center;
+        spec.radius = 100.0 + m_rng.generateDouble() * 500.0;
+        break;
+    case 1:
+        spec.type = RegionType::UAV;
+        spec.coordinate = center;
+        break;
+    default:
+        spec.type = RegionType::TaskRegion;
+        for (int i = 0; i < 5; ++i) {
+            const double angle = 2.0 * M_PI * i / 5;
+            spec.vertices.append(QMapLibre::Coordinate(center.first + 0.002 * qSin(angle),
+                                                       center.second + 0.002 * qCos(angle)));
+        }
+        break;
+    }
+    return spec;
+}
+
+void TestSnapshot::randomEdits()
+{
+    TaskManager::ChangeScope scope(m_tasks);
+
+    if (m_tasks->getAllTasks().size() < 5 || m_rng.bounded(4) == 0) {
+        m_tasks->createTask(QString("任务%1").arg(m_tasks->getAllTasks().size()), QString());
+    }
+    const QVector<Task*> &tasks = m_tasks->getAllTasks();
+    const int taskId = tasks[m_rng.bounded(int(tasks.size()))]->id();
+
+    QVector<RegionSpec> specs;
+    for (int i = int(m_rng.bounded(6)); i > 0; --i) {
+        specs.append(randomSpec());
+    }
+    m_tasks->addRegionsToTask(taskId, specs);
+
+    QVector<int> regionIds;
+    for (const Region *region : m_regions->getAllRegions()) {
+        regionIds.append(region->id());
+    }
+    for (int i = 0; i < 4 && !regionIds.isEmpty(); ++i) {
+        const int regionId = regionIds[m_rng.bounded(int(regionIds.size()))];
+        switch (m_rng.bounded(6)) {
+        case 0:
+            m_regions->updateRegionName(regionId, QString("改名%1").arg(m_rng.bounded(1000)));
+            break;
+        case 1:
+            m_regions->updateRegionColor(regionId, m_rng.bounded(2) ? "red" : "blue");
+            break;
+        case 2:
+            m_regions->updateRegionTerrainType(regionId, toTerrainType(int(m_rng.bounded(4))));
+            break;
+        case 3:
+            m_tasks->addRegionToTask(tasks[m_rng.bounded(int(tasks.size()))]->id(), regionId);
+            break;
+        case 4:
+            m_tasks->removeRegionFromTask(taskId, regionId);
+            break;
+        default:
+            if (m_regions->removeRegion(regionId)) {
+                regionIds.removeOne(regionId);
+            }
+            break;
+        }
+    }
+
+    m_tasks->setTaskVisible(tasks[m_rng.bounded(int(tasks.size()))]->id(), m_rng.bounded(2) == 0);
+    if (tasks.size() > 5 && m_rng.bounded(5) == 0) {
+        m_tasks->removeTask(tasks[m_rng.bounded(int(tasks.size()))]->id());
+    }
+}
+
+void TestSnapshot::oldSnapshotsUnaffectedByEdits()
+{
+    QVector<TaskSnapshot> snapshots;
+    QVector<State> states;
+    for (int round = 0; round < 40; ++round) {
+        randomEdits();
+
+        const State state = capture();
+        const TaskSnapshot snapshot = m_tasks->snapshot();
+        QVERIFY(matches(snapshot, state));
+        // 版本号不回退（本轮编辑没有改到任务或区域时不变）
+        if (!snapshots.isEmpty()) {
+            QVERIFY(snapshot.version() >= snapshots.last().version());
+            QVERIFY(snapshot.regions().version() >= snapshots.last().regions().version());
+        }
+        snapshots.append(snapshot);
+        states.append(state);
+
+        // 之前获取的所有快照都保持获取时的内容
+        for (int i = 0; i < snapshots.size(); ++i) {
+            QVERIFY(matches(snapshots[i], states[i]));
+        }
+    }
+
+    // 区域和任务全部删除后，旧快照仍然完整
+    {
+        TaskManager::ChangeScope scope(m_tasks);
+        while (!m_tasks->getAllTasks().isEmpty()) {
+            m_tasks->removeTask(m_tasks->getAllTasks().first()->id());
+        }
+        QVector<int> regionIds;
+        for (const Region *region : m_regions->getAllRegions()) {
+            regionIds.append(region->id());
+        }
+        for (int regionId : regionIds) {
+            m_regions->removeRegion(regionId);
+        }
+    }
+    QVERIFY(m_tasks->snapshot().regions().isEmpty());
+    QVERIFY(m_tasks->snapshot().tasks().isEmpty());
+    for (int i = 0; i < snapshots.size(); ++i) {
+        QVERIFY(matches(snapshots[i], states[i]));
+    }
+}
+
+void TestSnapshot::unchangedStateKeepsVersion()
+{
+    randomEdits();
+    const TaskSnapshot first = m_tasks->snapshot();
+    const TaskSnapshot second = m_tasks->snapshot();
+    QCOMPARE(second.version(), first.version());
+    QCOMPARE(second.regions().version(), first.regions().version());
+    QVERIFY(matches(second, capture()));
+
+    // 只改任务可见性也会发布新版本，旧快照保持原来的可见性
+    const int taskId = m_tasks->getAllTasks().first()->id();
+    m_tasks->setTaskVisible(taskId, !m_tasks->getTask(taskId)->isVisible());
+    const TaskSnapshot third = m_tasks->snapshot();
+    QVERIFY(third.version() > second.version());
+    QVERIFY(matches(third, capture()));
+    QCOMPARE(second.task(taskId)->isVisible(), !m_tasks->getTask(taskId)->isVisible());
+}
+
+QTEST_GUILESS_MAIN(TestSnapshot)
+#include "tst_snapshot.moc"
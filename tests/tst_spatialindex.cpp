@@ -0,0 +1,118 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "SpatialIndex.h"
+#include <QtTest>
+#include <QRandomGenerator>
+#include <algorithm>
+
+/**
+ * @brief SpatialIndex 与线性扫描对比：插入、更新、删除后任意范围的查询结果应完全一致
+ */
+class TestSpatialIndex : public QObject {
+    Q_OBJECT
+
+private slots:
+    void queryMatchesLinearScan();
+    void visitStopsEarly();
+    void invalidArea();
+
+private:
+    static GeoBounds randomBounds(QRandomGenerator &rng, double maxSpan);
+    static QVector<int> linearQuery(const QHash<int, GeoBounds> &entries, const GeoBounds &area);
+};
+
+GeoBounds TestSpatialIndex::randomBounds(QRandomGenerator &rng, double maxSpan)
+{
+    // 尺寸跨越多个数量级，使条目分布在不同的层
+    const double span = maxSpan * std::pow(rng.generateDouble(), 4.0);
+    GeoBounds bounds;
+    bounds.minLat = 30.0 + rng.generateDouble() * 2.0;
+    bounds.minLon = 120.0 + rng.generateDouble() * 2.0;
+    bounds.maxLat = bounds.minLat + span * rng.generateDouble();
+    bounds.maxLon = bounds.minLon + span * rng.generateDouble();
+    return bounds;
+}
+
+QVector<int> TestSpatialIndex::linearQuery(const QHash<int, GeoBounds> &entries, const GeoBounds &area)
+{
+    QVector<int> ids;
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        if (it.value().intersects(area)) {
+            ids.append(it.key());
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+void TestSpatialIndex::queryMatchesLinearScan()
+{
+    QRandomGenerator rng(26);
+    SpatialIndex index;
+    QHash<int, GeoBounds> entries;
+
+    for (int id = 1; id <= 3000; ++id) {
+        GeoBounds bounds = randomBounds(rng, 1.0);
+        index.insert(id, bounds);
+        entries.insert(id, bounds);
+    }
+
+    // 更新（同一ID再次插入）和删除
+    for (int i = 0; i < 1000; ++i) {
+        int id = 1 + int(rng.bounded(3000));
+        if (i % 2 == 0) {
+            GeoBounds bounds = randomBounds(rng, 1.0);
+            index.insert(id, bounds);
+            entries.insert(id, bounds);
+        } else {
+            QCOMPARE(index.remove(id), entries.remove(id) > 0);
+        }
+    }
+    QCOMPARE(index.size(), int(entries.size()));
+
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        QVERIFY(index.contains(it.key()));
+        QCOMPARE(index.bounds(it.key()).minLat, it.value().minLat);
+        QCOMPARE(index.bounds(it.key()).maxLon, it.value().maxLon);
+    }
+
+    // 从单点到覆盖全部条目的查询范围（后者走遍历非空单元格的分支）
+    for (int i = 0; i < 2000; ++i) {
+        GeoBounds area = i % 100 == 0 ? randomBounds(rng, 0.0).expanded(1e6) : randomBounds(rng, 0.5);
+        QVector<int> found = index.query(area);
+        std::sort(found.begin(), found.end());
+        QCOMPARE(found, linearQuery(entries, area));
+    }
+
+    index.clear();
+    QCOMPARE(index.size(), 0);
+    QVERIFY(index.query(randomBounds(rng, 0.0).expanded(1e6)).isEmpty());
+}
+
+void TestSpatialIndex::visitStopsEarly()
+{
+    SpatialIndex index;
+    for (int id = 1; id <= 10; ++id) {
+        index.insert(id, GeoBounds::fromCircle(QMapLibre::Coordinate(30.0, 120.0), 100.0 * id));
+    }
+
+    int visited = 0;
+    index.visit(GeoBounds::fromPoint(QMapLibre::Coordinate(30.0, 120.0)), [&](int, const GeoBounds &) {
+        ++visited;
+        return visited < 3;
+    });
+    QCOMPARE(visited, 3);
+}
+
+void TestSpatialIndex::invalidArea()
+{
+    SpatialIndex index;
+    index.insert(1, GeoBounds::fromPoint(QMapLibre::Coordinate(30.0, 120.0)));
+    QVERIFY(index.query(GeoBounds()).isEmpty());
+    QVERIFY(!index.remove(2));
+    QVERIFY(!index.bounds(2).isValid());
+}
+
+QTEST_GUILESS_MAIN(TestSpatialIndex)
+#include "tst_spatialindex.moc"
@@ -0,0 +1,279 @@
+// Copyright (C) 2023 MapLibre contributors
+// SPDX-License-Identifier: MIT
+
+#include "TaskManager.h"
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QSet>
+
+/**
+ * @brief TaskManager 的任务ID索引和 区域 -> 任务 反向索引与按任务逐个重新统计的结果一致
+ *
+ * 变化包括新建/删除任务、添加/移除/清空关联、删除被引用的区域，以及撤销/重做。
+ * 可见引用计数和区域的显示状态同样与按可见任务重新统计的结果对比。
+ */
+class TestTaskIndex : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void indexMatchesRecount();
+    void visibleRefsMatchRecount();
+
+private:
+    void randomEdits();
+    void randomVisibility();
+
+    /**
+     * @brief 索引查询结果与按任务重新统计是否一致（不一致时输出第一处差异）
+     */
+    bool indexMatchesTasks() const;
+
+    /**
+     * @brief 可见引用计数和区域显示状态与按可见任务重新统计是否一致
+     */
+    bool visibilityMatchesTasks() const;
+
+    QRandomGenerator m_rng{44};
+    RegionManager *m_regions = nullptr;
+    TaskManager *m_tasks = nullptr;
+    QSet<int> m_seenRegionIds;   // 出现过的全部区域ID（包括已删除的）
+    QSet<int> m_seenTaskIds;     // 出现过的全部任务ID（包括已删除的）
+};
+
+void TestTaskIndex::init()
+{
+    m_rng.seed(44);
+    m_regions = new RegionManager(nullptr);
+    m_tasks = new TaskManager(m_regions);
+    m_seenRegionIds.clear();
+    m_seenTaskIds.clear();
+}
+
+void TestTaskIndex::cleanup()
+{
+    delete m_tasks;
+    delete m_regions;
+    m_tasks = nullptr;
+    m_regions = nullptr;
+}
+
+void TestTaskIndex::randomEdits()
+{
+    TaskManager::ChangeScope scope(m_tasks);
+
+    if (m_tasks->getAllTasks().size() < 4 || m_rng.bounded(3) == 0) {
+        m_seenTaskIds.insert(m_tasks->createTask(QString("任务"), QString())->id());
+    }
+    const QVector<Task*> tasks = m_tasks->getAllTasks();
+    auto randomTask = [&]() { return tasks[m_rng.bounded(int(tasks.size()))]->id(); };
+
+    // 新建区域并关联到任务
+    QVector<RegionSpec> specs;
+    for (int i = int(m_rng.bounded(8)); i > 0; --i) {
+        RegionSpec spec;
+        spec.type = m_rng.bounded(2) ? RegionType::UAV : RegionType::LoiterPoint;
+        spec.coordinate = QMapLibre::Coordinate(30.0 + m_rng.generateDouble() * 0.1, 120.0 + m_rng.generateDouble() * 0.1);
+        specs.append(spec);
+    }
+    for (int regionId : m_tasks->addRegionsToTask(randomTask(), specs)) {
+        m_seenRegionIds.insert(regionId);
+    }
+
+    QVector<int> regionIds;
+    for (const Region *region : m_regions->getAllRegions()) {
+        regionIds.append(region->id());
+    }
+    for (int i = 0; i < 6 && !regionIds.isEmpty(); ++i) {
+        const int regionId = regionIds[m_rng.bounded(int(regionIds.size()))];
+        switch (m_rng.bounded(5)) {
+        case 0:
+        case 1:
+            // 共享区域，可能重复添加
+            m_tasks->addRegionToTask(randomTask(), regionId);
+            break;
+        case 2:
+            m_tasks->removeRegionFromTask(randomTask(), regionId);
+            break;
+        case 3:
+            if (m_regions->removeRegion(regionId)) {
+                regionIds.removeOne(regionId);
+            }
+            break;
+        default:
+            if (m_rng.bounded(4) == 0) {
+                m_tasks->clearTaskRegions(randomTask());
+            }
+            break;
+        }
+    }
+
+    if (tasks.size() > 4 && m_rng.bounded(4) == 0) {
+        m_tasks->removeTask(randomTask());
+    }
+}
+
+void TestTaskIndex::randomVisibility()
+{
+    const QVector<Task*> tasks = m_tasks->getAllTasks();
+    switch (m_rng.bounded(10)) {
+    case 0:
+        m_tasks->showAllTasks();
+        break;
+    case 1:
+        m_tasks->hideAllTasks();
+        break;
+    default:
+        for (int i = 0; i < 3 && !tasks.isEmpty(); ++i) {
+            m_tasks->setTaskVisible(tasks[m_rng.bounded(int(tasks.size()))]->id(), m_rng.bounded(2) == 0);
+        }
+        break;
+    }
+}
+
+bool TestTaskIndex::indexMatchesTasks() const
+{
+    QHash<int, QVector<int>> expected;   // regionId -> 引用它的任务ID（按ID排序）
+    for (Task *task : m_tasks->getAllTasks()) {
+        if (m_tasks->getTask(task->id()) != task) {
+            qWarning() << "任务ID索引不一致:" << task->id();
+            return false;
+        }
+        for (int regionId : task->regionIds()) {
+            if (!m_regions->getRegion(regionId)) {
+                qWarning() << "任务仍引用已删除的区域:" << task->id() << regionId;
+                return false;
+            }
+            expected[regionId].append(task->id());
+        }
+    }
+    for (int taskId : m_seenTaskIds) {
+        Task *task = m_tasks->getTask(taskId);
+        if (task && !m_tasks->getAllTasks().contains(task)) {
+            qWarning() << "已删除的任务仍可查到:" << taskId;
+            return false;
+        }
+    }
+
+    for (int regionId : m_seenRegionIds) {
+        QVector<int> taskIds = expected.value(regionId);
+        std::sort(taskIds.begin(), taskIds.end());
+
+        QVector<int> actual;
+        for (const Task *task : m_tasks->getTasksReferencingRegion(regionId)) {
+            actual.append(task->id());
+        }
+        if (actual != taskIds || m_tasks->getRegionReferenceCount(regionId) != taskIds.size()) {
+            qWarning() << "反向索引不一致:" << regionId << actual << taskIds;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TestTaskIndex::visibilityMatchesTasks() const
+{
+    QHash<int, int> referenced;   // regionId -> 引用它的任务数
+    QHash<int, int> visibleRefs;  // regionId -> 引用它的可见任务数
+    for (const Task *task : m_tasks->getAllTasks()) {
+        for (int regionId : task->regionIds()) {
+            ++referenced[regionId];
+            if (task->isVisible()) {
+                ++visibleRefs[regionId];
+            }
+        }
+    }
+
+    for (int regionId : m_seenRegionIds) {
+        if (m_tasks->visibleReferenceCount(regionId) != visibleRefs.value(regionId)) {
+            qWarning() << "可见引用计数不一致:" << regionId << m_tasks->visibleReferenceCount(regionId)
+                       << visibleRefs.value(regionId);
+            return false;
+        }
+        // 未被任何任务引用的区域始终显示，否则至少一个可见任务引用时显示
+        const Region *region = m_regions->getRegion(regionId);
+        const bool shouldBeVisible = !referenced.contains(regionId) || visibleRefs.value(regionId) > 0;
+        if (region && region->isVisible() != shouldBeVisible) {
+            qWarning() << "区域显示状态不一致:" << regionId << region->isVisible();
+            return false;
+        }
+    }
+    return true;
+}
+
+void TestTaskIndex::indexMatchesRecount()
+{
+    const int rounds = 60;
+    for (int round = 0; round < rounds; ++round) {
+        randomEdits();
+        QVERIFY(indexMatchesTasks());
+    }
+
+    // 撤销/重做按原样重建关联（区域换新ID）
+    int undone = 0;
+    while (undone < rounds / 2 && m_tasks->undo()) {
+        ++undone;
+        for (const Region *region : m_regions->getAllRegions()) {
+            m_seenRegionIds.insert(region->id());
+        }
+        QVERIFY(indexMatchesTasks());
+    }
+    QVERIFY(undone > 0);
+    for (int i = 0; i < undone; ++i) {
+        QVERIFY(m_tasks->redo());
+        for (const Region *region : m_regions->getAllRegions()) {
+            m_seenRegionIds.insert(region->id());
+        }
+        QVERIFY(indexMatchesTasks());
+    }
+
+    // 删除全部任务后反向索引为空
+    while (!m_tasks->getAllTasks().isEmpty()) {
+        m_tasks->removeTask(m_tasks->getAllTasks().first()->id());
+    }
+    QVERIFY(indexMatchesTasks());
+}
+
+void TestTaskIndex::visibleRefsMatchRecount()
+{
+    const int rounds = 60;
+    for (int round = 0; round < rounds; ++round) {
+        randomEdits();
+        randomVisibility();
+        QVERIFY(indexMatchesTasks());
+        QVERIFY(visibilityMatchesTasks());
+    }
+
+    // 撤销/重做重建的区域和关联同样按可见任务显示
+    int undone = 0;
+    while (undone < rounds / 2 && m_tasks->undo()) {
+        ++undone;
+        for (const Region *region : m_regions->getAllRegions()) {
+            m_seenRegionIds.insert(region->id());
+        }
+        QVERIFY(visibilityMatchesTasks());
+    }
+    QVERIFY(undone > 0);
+    for (int i = 0; i < undone; ++i) {
+        QVERIFY(m_tasks->redo());
+        for (const Region *region : m_regions->getAllRegions()) {
+            m_seenRegionIds.insert(region->id());
+        }
+        randomVisibility();
+        QVERIFY(visibilityMatchesTasks());
+    }
+
+    // 删除任务后只被它引用的区域恢复显示
+    while (!m_tasks->getAllTasks().isEmpty()) {
+        m_tasks->removeTask(m_tasks->getAllTasks().first()->id());
+        QVERIFY(visibilityMatchesTasks());
+    }
+    for (const Region *region : m_regions->getAllRegions()) {
+        QVERIFY(region->isVisible());
+    }
+}
+
+QTEST_GUILESS_MAIN(TestTaskIndex)
+#include "tst_taskindex.moc"